@@ -0,0 +1,243 @@
+// Host micro-benchmarks for the per-message and per-frame hot paths:
+// CommandDispatcher::dispatch() (the MQTT callback), Telemetry::publishState()
+// and DisplayManager::update() (clear + drawContent + send), plus the trend
+// page redrawn from scratch versus scrolled by one column, one deferred log
+// line recorded and drained, and one DryerController control tick.
+//
+//   pio run -e bench && .pio/build/bench/program [--format json|csv] [--iterations N]
+//
+// One record per benchmark: time per op, heap allocations and bytes per op,
+// and peak stack depth of a single call. JSON lines are the default so runs
+// from different firmware versions can be diffed or loaded into a notebook.
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <FilamentSettings.hpp>
+#include <DryerZone.hpp>
+#include <CommandDispatcher.hpp>
+#include <Telemetry.hpp>
+#include <DisplayManager.hpp>
+#include <Pins.hpp>
+#include <Log.hpp>
+#include <Version.hpp>
+#include <chrono>
+#include <ucontext.h>
+
+// ---------------------------------------------------------------------------
+// Allocation counting: glibc's malloc family is wrapped, which also catches
+// operator new and String growth.
+// ---------------------------------------------------------------------------
+
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void  __libc_free(void*);
+
+static bool     countAllocs = false;
+static uint64_t allocCount  = 0;
+static uint64_t allocBytes  = 0;
+
+extern "C" void* malloc(size_t n) {
+    if (countAllocs) { allocCount++; allocBytes += n; }
+    return __libc_malloc(n);
+}
+extern "C" void* calloc(size_t n, size_t size) {
+    if (countAllocs) { allocCount++; allocBytes += n * size; }
+    return __libc_calloc(n, size);
+}
+extern "C" void* realloc(void* p, size_t n) {
+    if (countAllocs) { allocCount++; allocBytes += n; }
+    return __libc_realloc(p, n);
+}
+extern "C" void free(void* p) { __libc_free(p); }
+
+// ---------------------------------------------------------------------------
+// Peak stack: run one call on a painted private stack and look for the
+// deepest byte that was overwritten.
+// ---------------------------------------------------------------------------
+
+static constexpr size_t  STACK_SIZE  = 64 * 1024;
+static constexpr uint8_t STACK_PAINT = 0xA5;
+static uint8_t           benchStack[STACK_SIZE];
+static ucontext_t        mainCtx, benchCtx;
+static void            (*stackOp)();
+
+static void stackTrampoline() { stackOp(); }
+
+static size_t measureStack(void (*op)()) {
+    memset(benchStack, STACK_PAINT, sizeof(benchStack));
+    stackOp = op;
+    getcontext(&benchCtx);
+    benchCtx.uc_stack.ss_sp   = benchStack;
+    benchCtx.uc_stack.ss_size = sizeof(benchStack);
+    benchCtx.uc_link          = &mainCtx;
+    makecontext(&benchCtx, stackTrampoline, 0);
+    swapcontext(&mainCtx, &benchCtx);
+
+    size_t untouched = 0;
+    while (untouched < STACK_SIZE && benchStack[untouched] == STACK_PAINT) untouched++;
+    return STACK_SIZE - untouched;
+}
+
+// ---------------------------------------------------------------------------
+// System under test
+// ---------------------------------------------------------------------------
+
+DryerZone         zone(ZONE_PINS[0]);
+PubSubClient      mqtt_client;
+CommandDispatcher commands(&zone, 1, mqtt_topics, nullptr);
+Telemetry         telemetry(mqtt_client, mqtt_topics, 1);
+DisplayManager    display(BOARD.displaySda, BOARD.displayScl);
+
+// Includes applying the queued command at the tick and draining what was
+// logged, which the loop does before the next message
+static void dispatch(const char* topic, const char* payload) {
+    commands.dispatch(topic, reinterpret_cast<const byte*>(payload), strlen(payload));
+    while (commands.pending()) commands.applyNext();
+    log_buffer.drain();
+}
+
+static void benchFilament()  { dispatch("cmnd/dryer/filament", "{\"material\":\"PETG\"}"); }
+static void benchStop()      { dispatch("cmnd/dryer/control", "{\"action\":\"stop\"}"); }
+static void benchFan()       { dispatch("cmnd/dryer/fan", "{\"state\":\"on\"}"); }
+static void benchBadJson()   { dispatch("cmnd/dryer/heater", "{\"state\":"); }
+static void benchBatch() {
+    dispatch("cmnd/dryer/batch",
+             "{\"ops\":[{\"cmd\":\"filament\",\"material\":\"PETG\"},{\"cmd\":\"fan\",\"state\":\"on\"}]}");
+}
+static void benchTelemetry() { telemetry.publishState(zone, 0); }
+
+// One control tick at the target: the reading swings across it, so the
+// heater keeps switching. A cycle that ran out is started again.
+static void benchControlTick() {
+    static uint32_t n = 0;
+    DryerState state = zone.controller.getState();
+    if (state != DryerState::HEATING && state != DryerState::HOLDING)
+        zone.controller.applyFilamentPreset(65, hoursToMilliseconds(2));
+    SimClock::advanceMs(1000);
+    zone.sensor.setTemperature(CentiCelsius::fromWhole(n++ % 2 ? 64 : 66));
+    zone.controller.update();
+}
+
+// Formats and hands over like the Serial sink, minus the UART
+struct NullLogSink : LogSink {
+    void write(const uint8_t*, const char*, size_t) override {}
+} nullLog;
+static void benchLog() {
+    LOG_INFO("MQTT | %s | %s", "cmnd/dryer/filament", "{\"material\":\"PETG\"}");
+    log_buffer.drain();
+}
+static constexpr CentiCelsius RUN_C  = CentiCelsius::fromCenti(4870);
+static constexpr CentiPercent RUN_RH = CentiPercent::fromCenti(2300);
+
+static void benchDisplayRun() {
+    display.update("HEATING", RUN_C, 65, RUN_RH, 117, true, true, nullptr);
+}
+static void benchDisplayIdle() {
+    display.update("IDLE", CentiCelsius::fromWhole(22), 50, CentiPercent::fromWhole(48), 240, false,
+                   false, "PLA");
+}
+
+// A full history; every op commits exactly one new column
+static TrendHistory trend;
+static void addTrendColumn() {
+    static uint32_t n = 0;
+    n++;
+    SimClock::advanceMs(TrendHistory::SAMPLE_MS);
+    trend.add(CentiCelsius::fromWhole(40 + n % 30), CentiPercent::fromWhole(20 + n % 17), 65);
+}
+static void benchTrendFull() {
+    addTrendColumn();
+    display.update("HEATING", RUN_C, 65, RUN_RH, 117, true, true, nullptr); // invalidates the plot
+    display.showTrend("HEATING", RUN_C, RUN_RH, trend);
+}
+static void benchTrendScroll() {
+    addTrendColumn();
+    display.showTrend("HEATING", RUN_C, RUN_RH, trend);
+}
+static void benchTrendHeader() {
+    display.showTrend("HEATING", RUN_C, RUN_RH, trend);
+}
+
+struct Bench {
+    const char* name;
+    void      (*op)();
+};
+
+static const Bench BENCHES[] = {
+    {"mqttCallback/filament",   benchFilament},
+    {"mqttCallback/control",    benchStop},
+    {"mqttCallback/fan",        benchFan},
+    {"mqttCallback/bad_json",   benchBadJson},
+    {"mqttCallback/batch",      benchBatch},
+    {"publishDryerState",       benchTelemetry},
+    {"control/tick",            benchControlTick},
+    {"log/record_drain",        benchLog},
+    {"display/update_running",  benchDisplayRun},
+    {"display/update_idle",     benchDisplayIdle},
+    {"display/trend_full",      benchTrendFull},   // includes one update_running
+    {"display/trend_scroll",    benchTrendScroll},
+    {"display/trend_header",    benchTrendHeader},
+};
+
+struct Result {
+    double   nsPerOp;
+    double   allocsPerOp;
+    double   bytesPerOp;
+    size_t   peakStack;
+    uint32_t iterations;
+};
+
+static Result run(const Bench& b, uint32_t iterations) {
+    for (uint32_t i = 0; i < iterations / 10 + 1; i++) b.op(); // warm-up
+
+    Result r = {};
+    r.iterations = iterations;
+
+    allocCount = allocBytes = 0;
+    countAllocs = true;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++) b.op();
+    auto end = std::chrono::steady_clock::now();
+    countAllocs = false;
+
+    r.nsPerOp     = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    r.allocsPerOp = static_cast<double>(allocCount) / iterations;
+    r.bytesPerOp  = static_cast<double>(allocBytes) / iterations;
+    r.peakStack   = measureStack(b.op);
+    return r;
+}
+
+int main(int argc, char** argv) {
+    bool     csv        = false;
+    uint32_t iterations = 20000;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--format") && i + 1 < argc)          csv = !strcmp(argv[++i], "csv");
+        else if (!strcmp(argv[i], "--iterations") && i + 1 < argc) iterations = strtoul(argv[++i], nullptr, 10);
+    }
+    if (!iterations) iterations = 1;
+
+    log_buffer.addSink(&nullLog);
+    zone.sensor.setTemperature(RUN_C);
+    zone.sensor.setHumidity(RUN_RH);
+    zone.heater.setTargetTemperature(65);
+    zone.heater.setTargetTime(hoursToMilliseconds(2));
+    for (uint8_t i = 0; i < TrendHistory::COLUMNS; i++) addTrendColumn();
+
+    if (csv) printf("firmware,bench,ns_per_op,allocs_per_op,bytes_per_op,peak_stack_bytes,iterations\n");
+
+    for (const Bench& b : BENCHES) {
+        Result r = run(b, iterations);
+        if (csv) {
+            printf("%s,%s,%.1f,%.2f,%.1f,%zu,%u\n", FIRMWARE_VERSION, b.name,
+                   r.nsPerOp, r.allocsPerOp, r.bytesPerOp, r.peakStack, r.iterations);
+        } else {
+            printf("{\"firmware\":\"%s\",\"bench\":\"%s\",\"ns_per_op\":%.1f,\"allocs_per_op\":%.2f,"
+                   "\"bytes_per_op\":%.1f,\"peak_stack_bytes\":%zu,\"iterations\":%u}\n",
+                   FIRMWARE_VERSION, b.name, r.nsPerOp, r.allocsPerOp, r.bytesPerOp,
+                   r.peakStack, r.iterations);
+        }
+    }
+    return 0;
+}
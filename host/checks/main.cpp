@@ -0,0 +1,193 @@
+// Host checks for the small pure pieces of the firmware that are easiest to
+// get wrong at their edges and hardest to see fail on the device: the serial
+// log sink, the sensor calibration tables and reading command values.
+//
+//   pio run -e checks && .pio/build/checks/program
+//
+// Exit code 0 if every check passed, 1 otherwise.
+
+#include <Arduino.h>
+#include <Calibration.hpp>
+#include <Fixed.hpp>
+#include <Log.hpp>
+#include <string>
+#include <vector>
+
+static uint32_t failures = 0;
+
+#define CHECK(cond, ...)                                                 \
+    do {                                                                 \
+        if (!(cond)) {                                                   \
+            failures++;                                                  \
+            fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__);         \
+            fprintf(stderr, __VA_ARGS__);                                \
+            fputc('\n', stderr);                                         \
+        }                                                                \
+    } while (0)
+
+// ---------------------------------------------------------------------------
+// Serial log sink: the TX FIFO never reports more than 128 bytes free, yet
+// longer lines must go out and must not hold back the ones behind them
+// ---------------------------------------------------------------------------
+
+// Sees every line the serial sink was given, as a drain hands them out
+struct RecordingSink : LogSink {
+    std::vector<std::string> lines;
+    void write(const uint8_t*, const char* text, size_t) override { lines.push_back(text); }
+};
+
+static void checkSerialLog() {
+    SerialLogSink serial;
+    RecordingSink seen;
+    log_buffer.addSink(&serial);
+    log_buffer.addSink(&seen);
+
+    // Strings as long as the record allows; the format text comes on top, up
+    // to LogBuffer::MAX_TEXT
+    std::string topic(64, 't'), message(44, 'm');
+    LOG_INFO("MQTT | %s | %s", topic.c_str(), message.c_str());
+    LOG_INFO("MQTT | %s | %s | a format string adds to the line without taking room in the "
+             "record, so one call can produce two hundred characters or more", topic.c_str(),
+             message.c_str());
+    LOG_INFO("after the long ones");
+
+    HostSerial::txFree = 40; // busy: nothing longer than the free space goes
+    log_buffer.drain();
+    CHECK(seen.lines.empty(), "%zu line(s) written into a busy FIFO", seen.lines.size());
+
+    HostSerial::txFree = SerialLogSink::TX_FIFO;
+    log_buffer.drain();
+    CHECK(seen.lines.size() == 3, "%zu of 3 lines drained", seen.lines.size());
+    CHECK(log_buffer.queued() == 0, "%u bytes still queued", log_buffer.queued());
+    if (seen.lines.size() == 3) {
+        size_t wire = SerialLogSink::PREFIX + seen.lines[1].size();
+        CHECK(wire >= 200, "long line only %zu characters on the wire", wire);
+        CHECK(seen.lines[2] == "after the long ones", "last line \"%s\"", seen.lines[2].c_str());
+    }
+
+    log_buffer.removeSink(&serial);
+    log_buffer.removeSink(&seen);
+    size_t longest = seen.lines.size() > 1 ? SerialLogSink::PREFIX + seen.lines[1].size() : 0;
+    printf("serial log: %zu lines drained, longest %zu characters on the wire\n",
+           seen.lines.size(), longest);
+}
+
+// ---------------------------------------------------------------------------
+// CalibrationTable: hundredths in, hundredths out
+// ---------------------------------------------------------------------------
+
+static void checkApply(const CalibrationTable& t, int16_t raw, int16_t expected) {
+    int16_t got = t.apply(raw);
+    CHECK(got == expected, "apply(%d) = %d, expected %d", raw, got, expected);
+}
+
+static void checkCalibration() {
+    Calibration cal;
+    CalibrationTable& t = cal.temperature;
+
+    // Uncalibrated: 1 °C below the sensor, as before tables existed
+    CHECK(cal.isDefaultTemperature(), "default table has %u points", t.count());
+    checkApply(t, 2512, 2412);
+    checkApply(t, 8000, 7900);
+    checkApply(cal.humidity, 4530, 4530);
+    t.clear();
+    checkApply(t, 2512, 2512); // no points: unchanged
+
+    CalibrationTable::Point one[] = {{2500, 2400}};
+    CHECK(t.set(one, 1), "single point refused");
+    checkApply(t, 2500, 2400);
+    checkApply(t, 7000, 6900); // an offset everywhere
+
+    // Given out of order, kept sorted
+    CalibrationTable::Point two[] = {{6100, 5820}, {2600, 2450}};
+    CHECK(t.set(two, 2), "two points refused");
+    CHECK(t.count() == 2 && t.point(0).raw == 2600 && t.point(1).raw == 6100, "points not sorted");
+    checkApply(t, 2600, 2450);
+    checkApply(t, 6100, 5820);
+    checkApply(t, 4350, 4135); // halfway between
+    checkApply(t, 2000, 1872); // first segment continued below
+    checkApply(t, 8000, 7649); // and above
+
+    // Clamped to the table's range; -40 °C read as -40 stays there
+    CalibrationTable::Point cold[] = {{-3500, -3900}, {-1000, -1000}};
+    CHECK(t.set(cold, 2), "cold points refused");
+    checkApply(t, -4000, -4000);
+
+    // Refused, and the table stays as it was
+    CalibrationTable::Point tooFar[]   = {{2500, -4000}};                // offset -65 °C
+    CalibrationTable::Point tooClose[] = {{2500, 2500}, {2550, 2600}};   // readings 0.5 °C apart
+    CalibrationTable::Point flat[]     = {{2500, 2500}, {6500, 4000}};   // slope 0.375
+    CalibrationTable::Point steep[]    = {{2500, 2500}, {3500, 4600}};   // slope 2.1
+    CalibrationTable::Point outside[]  = {{13000, 12900}};               // beyond 125 °C
+    CHECK(!t.set(tooFar, 1), "offset beyond 10 C accepted");
+    CHECK(!t.set(tooClose, 2), "points closer than MIN_GAP accepted");
+    CHECK(!t.set(flat, 2), "slope below 1/2 accepted");
+    CHECK(!t.set(steep, 2), "slope above 2 accepted");
+    CHECK(!t.set(outside, 1), "point outside the range accepted");
+    CHECK(t.count() == 2 && t.point(0).raw == -3500, "refused set() changed the table");
+
+    // A -10 °C shift at both ends, slope 1/2 above: continued it would read
+    // 80 °C as 52.5, but never more than 10 °C off
+    CalibrationTable::Point drift[] = {{2500, 2500}, {4500, 3500}};
+    CHECK(t.set(drift, 2), "drifting table refused");
+    checkApply(t, 8000, 7000);
+
+    // add() replaces a point within MIN_GAP and refuses a seventh
+    t.clear();
+    for (int16_t i = 0; i < CalibrationTable::MAX_POINTS; i++)
+        CHECK(t.add({(int16_t)(2000 + i * 1000), (int16_t)(2000 + i * 1000)}), "add %d refused", i);
+    CHECK(t.add({2050, 2150}) && t.count() == CalibrationTable::MAX_POINTS, "nearby point not replaced");
+    CHECK(t.point(0).reference == 2150, "replaced point has reference %d", t.point(0).reference);
+    CHECK(!t.add({9000, 9000}), "seventh point accepted");
+
+    CHECK(cal.humidity.set(one, 1) && cal.humidity.apply(2500) == 2400, "humidity table");
+    CHECK(!cal.isDefaultTemperature(), "measured table taken for the default");
+    printf("calibration: default offset, sorting, interpolation, extrapolation, clamping and refusals\n");
+}
+
+// ---------------------------------------------------------------------------
+// parseHundredths: command values as text, without float
+// ---------------------------------------------------------------------------
+
+static void checkParse(const char* text, bool ok, int32_t expected = 0) {
+    int32_t got = 12345;
+    bool    parsed = parseHundredths(text, got);
+    CHECK(parsed == ok, "\"%s\" %s", text, ok ? "refused" : "accepted");
+    if (ok && parsed) CHECK(got == expected, "\"%s\" = %d, expected %d", text, got, expected);
+    if (!ok) CHECK(got == 12345, "refused \"%s\" changed the value", text);
+}
+
+static void checkParseHundredths() {
+    checkParse("24", true, 2400);
+    checkParse("24.5", true, 2450);
+    checkParse("58.25", true, 5825);
+    checkParse("0.05", true, 5);
+    checkParse("-3.5", true, -350);
+    checkParse("-0", true, 0);
+    checkParse("99999.99", true, 9999999);
+
+    checkParse("", false);
+    checkParse("-", false);
+    checkParse(".5", false);
+    checkParse("24.", false);
+    checkParse("24.125", false); // a third decimal
+    checkParse("100000", false); // six digits
+    checkParse("+24", false);
+    checkParse("24 ", false);
+    checkParse("2e1", false);
+    checkParse(nullptr, false);
+    printf("parseHundredths: whole, decimal and negative values and refusals\n");
+}
+
+int main() {
+    checkSerialLog();
+    checkCalibration();
+    checkParseHundredths();
+
+    if (failures) {
+        printf("FAIL: %u check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,280 @@
+// Stress test for the cross-task exchange of the ESP32 build (lib/exchange):
+// a writer and a reader thread hammer a Snapshot, a producer and a consumer
+// thread push MQTT messages of every size through a small MessageRing, once
+// popped and once forwarded into the (fake) PubSubClient. Every value carries
+// its sequence number and a checksum, so a torn read, a lost or reordered
+// message or a corrupted payload is caught.
+//
+//   pio run -e exchange && .pio/build/exchange/program [--rounds N]
+//
+// Exit code 0 if everything arrived intact and in order, 1 otherwise. Worth
+// running under -fsanitize=thread as well.
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <MessageRing.hpp>
+#include <Snapshot.hpp>
+#include <atomic>
+#include <thread>
+
+static uint32_t failures = 0;
+
+#define CHECK(cond, ...)                                  \
+    do {                                                  \
+        if (!(cond)) {                                    \
+            if (failures++ < 10) {                        \
+                fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+                fprintf(stderr, __VA_ARGS__);             \
+                fputc('\n', stderr);                      \
+            }                                             \
+        }                                                 \
+    } while (0)
+
+// ---------------------------------------------------------------------------
+// Snapshot: every field derived from seq, so any mix of two values shows
+// ---------------------------------------------------------------------------
+
+struct Frame {
+    uint32_t seq;
+    uint32_t words[15];
+    uint32_t check;
+};
+
+static Frame frameOf(uint32_t seq) {
+    Frame f;
+    f.seq   = seq;
+    f.check = seq;
+    for (uint8_t i = 0; i < 15; i++) {
+        f.words[i] = seq * 2654435761u + i;
+        f.check   ^= f.words[i];
+    }
+    return f;
+}
+
+static bool intact(const Frame& f) {
+    uint32_t check = f.seq;
+    for (uint8_t i = 0; i < 15; i++) {
+        if (f.words[i] != f.seq * 2654435761u + i) return false;
+        check ^= f.words[i];
+    }
+    return check == f.check;
+}
+
+static void testSnapshot(uint32_t frames) {
+    Snapshot<Frame>   snapshot;
+    std::atomic<bool> done(false);
+    uint32_t          reads = 0, torn = 0, backwards = 0;
+
+    Frame f;
+    CHECK(!snapshot.read(f), "read before the first publish");
+
+    std::thread reader([&]() {
+        uint32_t last = 0;
+        Frame    got;
+        for (;;) {
+            bool finished = done.load(std::memory_order_acquire);
+            if (!snapshot.read(got)) {
+                if (finished) break; // the last frame was read already
+                std::this_thread::yield();
+                continue;
+            }
+            reads++;
+            if (!intact(got)) torn++;
+            if (got.seq <= last) backwards++;
+            last = got.seq;
+        }
+        CHECK(last == frames, "last frame read was %u of %u", last, frames);
+    });
+
+    for (uint32_t seq = 1; seq <= frames; seq++) {
+        snapshot.publish(frameOf(seq));
+        if (seq % 8 == 0) std::this_thread::yield(); // lets a single core interleave too
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    CHECK(torn == 0, "%u torn frames", torn);
+    CHECK(backwards == 0, "%u frames not newer than the one before", backwards);
+    printf("snapshot:  %u published, %u read, %u torn\n", frames, reads, torn);
+}
+
+// ---------------------------------------------------------------------------
+// MessageRing: message seq has topic "dryer/<seq>", length seq % MAX_LENGTH,
+// payload bytes (seq + i) * 31, retained every third
+// ---------------------------------------------------------------------------
+
+static constexpr uint16_t RING_SIZE  = 1024;
+static constexpr uint16_t MAX_LENGTH = 700; // several messages wrap or do not fit at all
+
+static uint16_t lengthOf(uint32_t seq) { return seq % MAX_LENGTH; }
+static uint8_t  byteOf(uint32_t seq, uint32_t i) { return (uint8_t)((seq + i) * 31); }
+static bool     retainedOf(uint32_t seq) { return seq % 3 == 0; }
+
+// Alternates between the three ways modules publish; retries while full
+static void produce(MessageRing& ring, uint32_t messages, uint32_t& retries) {
+    uint8_t payload[MAX_LENGTH];
+    char    topic[32];
+    for (uint32_t seq = 1; seq <= messages; seq++) {
+        uint16_t length = lengthOf(seq);
+        for (uint16_t i = 0; i < length; i++) payload[i] = byteOf(seq, i);
+        snprintf(topic, sizeof(topic), "dryer/%u", seq);
+
+        for (;;) {
+            bool ok;
+            if (seq % 2) {
+                ok = ring.publish(topic, payload, length, retainedOf(seq));
+            } else {
+                // Streamed in uneven pieces, as Telemetry::publishHistory does
+                ok = ring.beginPublish(topic, length, retainedOf(seq));
+                for (uint16_t at = 0; ok && at < length; at += 97) {
+                    uint16_t n = length - at < 97 ? length - at : 97;
+                    ok = ring.write(payload + at, n) == n;
+                }
+                ok = ring.endPublish() && ok;
+            }
+            if (ok) break;
+            retries++;
+            std::this_thread::yield();
+        }
+    }
+}
+
+static void verify(uint32_t expected, const char* topic, const uint8_t* payload, unsigned length,
+                   bool retained) {
+    char want[32];
+    snprintf(want, sizeof(want), "dryer/%u", expected);
+    CHECK(!strcmp(topic, want), "got %s, expected %s", topic, want);
+    CHECK(length == lengthOf(expected), "%s: length %u, expected %u", topic, length,
+          lengthOf(expected));
+    CHECK(retained == retainedOf(expected), "%s: retained flag", topic);
+    for (unsigned i = 0; i < length && i < lengthOf(expected); i++) {
+        if (payload[i] != byteOf(expected, i)) {
+            CHECK(false, "%s: payload byte %u", topic, i);
+            break;
+        }
+    }
+}
+
+static void testPop(uint32_t messages) {
+    static uint8_t storage[RING_SIZE];
+    MessageRing    ring(storage, sizeof(storage));
+    ring.setConnected(true);
+
+    uint32_t retries = 0;
+    std::thread producer([&]() { produce(ring, messages, retries); });
+
+    MessageRing::Message message;
+    uint8_t              payload[MAX_LENGTH];
+    uint32_t             next = 1;
+    while (next <= messages) {
+        if (!ring.pop(message, payload, sizeof(payload))) {
+            std::this_thread::yield();
+            continue;
+        }
+        verify(next++, message.topic, payload, message.length, message.retained);
+    }
+    producer.join();
+
+    CHECK(ring.used() == 0, "%u bytes left in the ring", ring.used());
+    CHECK(ring.peak() <= RING_SIZE, "peak %u beyond the ring", ring.peak());
+    printf("pop:       %u messages, %u retries while full, peak %u of %u bytes\n",
+           messages, retries, ring.peak(), RING_SIZE);
+}
+
+// Checks what the fake client passes on, in order
+class CheckingBus : public HostMqttBus {
+public:
+    uint32_t next = 1;
+
+    void publish(PubSubClient&, const char* topic, const uint8_t* payload, unsigned int length,
+                 bool retained) override {
+        verify(next++, topic, payload, length, retained);
+    }
+    void subscribe(PubSubClient&, const char*) override {}
+};
+
+static void testForward(uint32_t messages) {
+    static uint8_t storage[RING_SIZE];
+    MessageRing    ring(storage, sizeof(storage));
+    ring.setConnected(true);
+
+    PubSubClient client; // 256-byte buffer: longer messages must be streamed
+    CheckingBus  bus;
+    client.bus = &bus;
+
+    uint32_t retries = 0;
+    std::thread producer([&]() { produce(ring, messages, retries); });
+
+    uint32_t sent = 0;
+    while (bus.next <= messages) {
+        uint16_t n = ring.forward(client);
+        if (!n) std::this_thread::yield();
+        sent += n;
+    }
+    producer.join();
+
+    CHECK(sent == messages, "forwarded %u of %u", sent, messages);
+    CHECK(client.published == messages, "client saw %u of %u", client.published, messages);
+    printf("forward:   %u messages, %u retries while full\n", messages, retries);
+}
+
+// ---------------------------------------------------------------------------
+// What the producer is told, single-threaded
+// ---------------------------------------------------------------------------
+
+static void testRefusals() {
+    static uint8_t storage[256];
+    MessageRing    ring(storage, sizeof(storage));
+
+    CHECK(!ring.publish("dryer/x", "down"), "accepted while disconnected");
+    CHECK(!ring.beginPublish("dryer/x", 4, false), "stream accepted while disconnected");
+    ring.setConnected(true);
+
+    char topic[MessageRing::MAX_TOPIC + 2];
+    memset(topic, 'a', sizeof(topic) - 1);
+    topic[sizeof(topic) - 1] = '\0';
+    CHECK(!ring.publish(topic, "long"), "topic longer than MAX_TOPIC accepted");
+
+    uint8_t big[300] = {};
+    CHECK(!ring.publish("dryer/x", big, sizeof(big)), "message larger than the ring accepted");
+
+    CHECK(ring.beginPublish("dryer/x", 10, false), "stream refused");
+    CHECK(!ring.publish("dryer/y", "nested"), "publish inside an open stream accepted");
+    ring.write(big, 5);
+    CHECK(!ring.endPublish(), "short stream accepted");
+    CHECK(ring.used() == 0, "short stream left %u bytes visible", ring.used());
+
+    CHECK(ring.publish("dryer/x", "ok"), "publish after a failed stream refused");
+    // Only what did not fit counts; a closed link or an open stream is not a drop
+    CHECK(ring.dropped() == 3, "dropped %u, expected 3", ring.dropped());
+
+    CHECK(!ring.takeDisconnect(), "disconnect before one was asked for");
+    ring.disconnect();
+    CHECK(ring.takeDisconnect(), "disconnect request lost");
+    CHECK(!ring.takeDisconnect(), "disconnect request taken twice");
+    printf("refusals:  %u counted\n", ring.dropped());
+}
+
+int main(int argc, char** argv) {
+    uint32_t rounds = 200000;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--rounds") && i + 1 < argc) {
+            rounds = strtoul(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--rounds N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    testRefusals();
+    testSnapshot(rounds * 10);
+    testPop(rounds);
+    testForward(rounds);
+
+    if (failures) {
+        printf("FAIL: %u check(s) failed\n", failures);
+        return 1;
+    }
+    printf("OK: every value arrived intact and in order\n");
+    return 0;
+}
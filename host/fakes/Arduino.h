@@ -0,0 +1,158 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal Arduino core for host builds (simulator, benchmarks). Only what
+// the portable parts of the firmware actually use is provided.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <string>
+#include "SimClock.hpp"
+
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x00
+#define OUTPUT       0x01
+#define INPUT_PULLUP 0x02
+
+#define DEC 10
+#define HEX 16
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s)    (s)
+#define pgm_read_byte(p) (*reinterpret_cast<const uint8_t*>(p))
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+using std::isnan;
+
+inline uint32_t millis() { return SimClock::millis(); }
+inline uint32_t micros() { return SimClock::micros(); }
+inline void     delay(uint32_t ms) { SimClock::advanceMs(ms); }
+inline void     yield() {}
+
+// GPIO is a plain array so fakes and the simulator can inspect/drive pins
+struct HostGpio {
+    static inline uint8_t level[17] = {};
+    static inline uint8_t mode[17]  = {};
+};
+
+inline void pinMode(uint8_t pin, uint8_t mode)      { if (pin < 17) HostGpio::mode[pin] = mode; }
+inline void digitalWrite(uint8_t pin, uint8_t val)  { if (pin < 17) HostGpio::level[pin] = val ? HIGH : LOW; }
+inline int  digitalRead(uint8_t pin)                { return pin < 17 ? HostGpio::level[pin] : LOW; }
+
+inline long random(long howbig)           { return howbig ? ::random() % howbig : 0; }
+inline long random(long lo, long hi)      { return lo + random(hi - lo); }
+
+class String {
+public:
+    String() = default;
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int v, unsigned char base = DEC)           { fromInteger(static_cast<long>(v), base); }
+    String(unsigned int v, unsigned char base = DEC)  { fromInteger(static_cast<long>(v), base); }
+    String(long v, unsigned char base = DEC)          { fromInteger(v, base); }
+    String(unsigned long v, unsigned char base = DEC) { fromInteger(static_cast<long>(v), base); }
+    String(float v, unsigned char decimals = 2)       { fromFloat(v, decimals); }
+    String(double v, unsigned char decimals = 2)      { fromFloat(v, decimals); }
+
+    const char*  c_str()  const { return _s.c_str(); }
+    unsigned int length() const { return static_cast<unsigned int>(_s.size()); }
+    long         toInt()  const { return atol(_s.c_str()); }
+
+    bool equals(const String& o) const           { return _s == o._s; }
+    bool equals(const char* o) const             { return _s == (o ? o : ""); }
+    bool equalsIgnoreCase(const String& o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+    bool startsWith(const String& p) const       { return _s.compare(0, p._s.size(), p._s) == 0; }
+    bool endsWith(const String& p) const {
+        return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+    }
+    int    indexOf(char c, unsigned int from = 0) const {
+        size_t i = _s.find(c, from);
+        return i == std::string::npos ? -1 : static_cast<int>(i);
+    }
+    int    indexOf(const String& s, unsigned int from = 0) const {
+        size_t i = _s.find(s._s, from);
+        return i == std::string::npos ? -1 : static_cast<int>(i);
+    }
+    String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+        return from < _s.size() && to > from ? String(_s.substr(from, to - from)) : String();
+    }
+    char   charAt(unsigned int i) const  { return i < _s.size() ? _s[i] : 0; }
+    char   operator[](unsigned int i) const { return charAt(i); }
+
+    bool    operator==(const String& o) const { return _s == o._s; }
+    bool    operator==(const char* o) const   { return equals(o); }
+    bool    operator!=(const String& o) const { return _s != o._s; }
+    bool    operator!=(const char* o) const   { return !equals(o); }
+    String& operator+=(const String& o)       { _s += o._s; return *this; }
+    String& operator+=(const char* o)         { _s += (o ? o : ""); return *this; }
+    String& operator+=(char c)                { _s += c; return *this; }
+    friend String operator+(String a, const String& b) { a += b; return a; }
+    friend String operator+(String a, const char* b)   { a += b; return a; }
+    friend String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+
+private:
+    std::string _s;
+
+    void fromInteger(long v, unsigned char base) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), base == HEX ? "%lx" : "%ld", v);
+        _s = buf;
+    }
+    void fromFloat(double v, unsigned char decimals) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, v);
+        _s = buf;
+    }
+};
+
+// Serial output is discarded unless HostSerial::echo is set
+class HostSerial {
+public:
+    static inline bool echo   = false;
+    static inline int  txFree = 128; // the UART FIFO; writes drain it instantly
+
+    void begin(unsigned long, int = 0, int = 0) {}
+    int  availableForWrite()                          { return txFree; }
+    template <typename T> size_t print(const T& v)   { return write(toString(v)); }
+    template <typename T> size_t println(const T& v) { return write(toString(v)) + write("\n"); }
+    size_t println()                                  { return write("\n"); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3))) {
+        char buf[256];
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+        write(buf);
+        return n > 0 ? static_cast<size_t>(n) : 0;
+    }
+
+private:
+    size_t write(const std::string& s) {
+        if (echo) fputs(s.c_str(), stdout);
+        return s.size();
+    }
+    static std::string toString(const char* s)   { return s ? s : ""; }
+    static std::string toString(const String& s) { return s.c_str(); }
+    static std::string toString(char c)          { return std::string(1, c); }
+    static std::string toString(float v)         { return String(v).c_str(); }
+    static std::string toString(double v)        { return String(v).c_str(); }
+    template <typename T> static std::string toString(T v) { return std::to_string(v); }
+};
+
+inline HostSerial Serial;
+
+#endif // HOST_ARDUINO_H
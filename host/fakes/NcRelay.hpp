@@ -0,0 +1,23 @@
+#ifndef NC_RELAY_HPP
+#define NC_RELAY_HPP
+
+#include "Relais.hpp"
+
+// Host stand-in for lib/relais/NcRelay.hpp: counts device (not coil) switches.
+class NcRelay {
+public:
+    NcRelay(uint8_t pin, const char* name) : relay(pin, name), switchCount(0) {}
+
+    void turnOn()  { if (!getState()) switchCount++; relay.turnOff(); }
+    void turnOff() { relay.turnOn(); }
+
+    bool getState() const { return !relay.getState(); }
+    const char* getName() const { return relay.getName(); }
+    uint32_t getSwitchCount() const { return switchCount; }
+
+private:
+    Relais relay;
+    uint32_t switchCount;
+};
+
+#endif // NC_RELAY_HPP
@@ -0,0 +1,122 @@
+#ifndef HOST_PUBSUBCLIENT_H
+#define HOST_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+
+class PubSubClient;
+
+// Optional message fabric behind the fake client, so a host program can run
+// several nodes against an in-process broker or a real one.
+class HostMqttBus {
+public:
+    virtual ~HostMqttBus() {}
+    virtual void publish(PubSubClient& from, const char* topic, const uint8_t* payload,
+                         unsigned int length, bool retained) = 0;
+    virtual void subscribe(PubSubClient& from, const char* filter) = 0;
+    virtual bool connected(PubSubClient& from) { (void)from; return true; }
+};
+
+// Host stand-in for knolleary/PubSubClient. Always "connected" unless a bus
+// says otherwise; publish() copies into a fixed buffer like the real client
+// does, remembers the last message so host programs can inspect it and
+// forwards it to the bus if one is attached.
+class PubSubClient {
+public:
+    // std::function like the ESP8266 build of the real library
+    typedef std::function<void(char*, uint8_t*, unsigned int)> Callback;
+
+    PubSubClient() = default;
+    template <typename C> explicit PubSubClient(C&) {}
+
+    template <typename C> PubSubClient& setClient(C&) { return *this; }
+    PubSubClient& setServer(const char*, uint16_t) { return *this; }
+    PubSubClient& setCallback(Callback cb)         { callback = cb; return *this; }
+    PubSubClient& setSocketTimeout(uint16_t)       { return *this; }
+    bool          setBufferSize(uint16_t size)     { bufferSize = size < sizeof(buffer) ? size : sizeof(buffer); return true; }
+    uint16_t      getBufferSize() const            { return bufferSize; }
+
+    bool connect(const char*)                                   { return true; }
+    bool connect(const char*, const char*, const char*)         { return true; }
+    bool connect(const char*, const char*, const char*, const char*, uint8_t, bool, const char*) { return true; }
+    void disconnect()         {}
+    bool connected()          { return bus ? bus->connected(*this) : true; }
+    int  state()              { return 0; }
+    bool loop()               { return true; }
+    bool subscribe(const char* filter, uint8_t = 0) {
+        subscriptions++;
+        if (bus) bus->subscribe(*this, filter);
+        return true;
+    }
+    bool unsubscribe(const char*)            { return true; }
+
+    bool publish(const char* topic, const char* payload, bool retained = false) {
+        return publish(topic, reinterpret_cast<const uint8_t*>(payload), strlen(payload), retained);
+    }
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained = false) {
+        if (length >= bufferSize) return false;
+        return record(topic, payload, length, retained);
+    }
+
+    // Streaming publish: the payload never has to fit bufferSize, only the
+    // announced length must match what is written
+    bool beginPublish(const char* topic, unsigned int length, bool retained) {
+        strncpy(streamTopic, topic, sizeof(streamTopic) - 1);
+        streamLength   = length;
+        streamRetained = retained;
+        streamed       = 0;
+        return true;
+    }
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t* data, size_t size) {
+        if (streamed + size < sizeof(buffer)) memcpy(stream + streamed, data, size);
+        streamed += size;
+        return size;
+    }
+    int endPublish() {
+        if (streamed != streamLength || streamed >= sizeof(buffer)) return 0;
+        return record(streamTopic, stream, streamed, streamRetained);
+    }
+
+    // Host side: feed an incoming message through the registered callback
+    void deliver(const char* topic, const char* payload) {
+        deliver(topic, reinterpret_cast<const uint8_t*>(payload), strlen(payload));
+    }
+    void deliver(const char* topic, const uint8_t* payload, unsigned int length) {
+        char t[128];
+        strncpy(t, topic, sizeof(t) - 1);
+        t[sizeof(t) - 1] = '\0';
+        if (callback) callback(t, const_cast<uint8_t*>(payload), length);
+    }
+
+    const char* lastPayload() const { return buffer; }
+    char        lastTopic[128] = {};
+    unsigned    lastLength     = 0;
+    bool        lastRetained   = false;
+    uint32_t    published      = 0;
+    uint32_t    subscriptions  = 0;
+    HostMqttBus* bus           = nullptr;
+
+private:
+    bool record(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+        snprintf(lastTopic, sizeof(lastTopic), "%s", topic);
+        memcpy(buffer, payload, length);
+        buffer[length] = '\0';
+        lastLength     = length;
+        lastRetained   = retained;
+        published++;
+        if (bus) bus->publish(*this, topic, payload, length, retained);
+        return true;
+    }
+
+    Callback callback   = nullptr;
+    uint16_t bufferSize = 256; // PubSubClient's MQTT_MAX_PACKET_SIZE default
+    char     buffer[4096] = {};
+    uint8_t  stream[4096] = {};
+    char     streamTopic[128] = {};
+    unsigned streamLength   = 0;
+    unsigned streamed       = 0;
+    bool     streamRetained = false;
+};
+
+#endif // HOST_PUBSUBCLIENT_H
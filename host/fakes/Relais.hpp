@@ -0,0 +1,41 @@
+#ifndef RELAIS_H
+#define RELAIS_H
+
+#include <Arduino.h>
+
+// Host stand-in for lib/relais: same interface, plus switch counting so the
+// simulator can report relay wear.
+class Relais
+{
+private:
+    uint8_t pin;
+    bool state;
+    const char* name; // static string, e.g. "Heater"
+    uint32_t switchCount;
+
+public:
+    Relais(uint8_t pin, const char* name) : pin(pin), state(false), name(name), switchCount(0)
+    {
+        pinMode(pin, OUTPUT);
+        digitalWrite(pin, LOW);
+    }
+
+    void turnOn()
+    {
+        if (!state) switchCount++;
+        digitalWrite(pin, HIGH);
+        state = true;
+    }
+
+    void turnOff()
+    {
+        digitalWrite(pin, LOW);
+        state = false;
+    }
+
+    const char* getName() const { return name; }
+    bool getState() const { return state; }
+    uint32_t getSwitchCount() const { return switchCount; } // off -> on edges
+};
+
+#endif // RELAIS_H
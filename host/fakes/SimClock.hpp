@@ -0,0 +1,21 @@
+#ifndef SIM_CLOCK_HPP
+#define SIM_CLOCK_HPP
+
+#include <stdint.h>
+
+// Virtual time source behind millis()/micros()/delay() in host builds.
+// Nothing advances it implicitly except delay(); the simulator steps it.
+class SimClock {
+public:
+    static uint64_t nowUs()                { return _us; }
+    static uint32_t millis()               { return static_cast<uint32_t>(_us / 1000); }
+    static uint32_t micros()               { return static_cast<uint32_t>(_us); }
+    static void     advanceMs(uint32_t ms) { _us += static_cast<uint64_t>(ms) * 1000; }
+    static void     advanceUs(uint32_t us) { _us += us; }
+    static void     reset()                { _us = 0; }
+
+private:
+    static inline uint64_t _us = 0;
+};
+
+#endif // SIM_CLOCK_HPP
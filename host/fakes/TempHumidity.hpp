@@ -0,0 +1,48 @@
+#ifndef TEMP_HUMIDITY_H
+#define TEMP_HUMIDITY_H
+
+#include <Arduino.h>
+#include <Fixed.hpp>
+
+#define DHT11 11
+#define DHT22 22
+
+// Host stand-in for lib/sensor: the simulator injects what the DHT would
+// see and updateReadings() latches it with DHT11 resolution (1 °C, 1 %RH).
+class TempHumidity
+{
+public:
+    TempHumidity(uint8_t pin, uint8_t type) : sensedTemperature(0.0f), sensedHumidity(0.0f)
+    {
+        (void)pin;
+        (void)type;
+    }
+
+    void setupDHT() {}
+
+    bool updateReadings()
+    {
+        temperature = CentiCelsius::fromWhole((int16_t)lroundf(sensedTemperature));
+        humidity    = CentiPercent::fromWhole((int16_t)lroundf(sensedHumidity));
+        return true;
+    }
+
+    CentiCelsius getTemperature() const { return temperature; }
+    CentiPercent getHumidity() const { return humidity; }
+    void setTemperature(CentiCelsius temperature) { this->temperature = temperature; }
+    void setHumidity(CentiPercent humidity) { this->humidity = humidity; }
+
+    void inject(float temperature, float humidity)
+    {
+        sensedTemperature = temperature;
+        sensedHumidity    = humidity;
+    }
+
+private:
+    CentiCelsius temperature;
+    CentiPercent humidity;
+    float sensedTemperature;
+    float sensedHumidity;
+};
+
+#endif // TEMP_HUMIDITY_H
@@ -0,0 +1,87 @@
+#ifndef HOST_U8G2LIB_H
+#define HOST_U8G2LIB_H
+
+#include <Arduino.h>
+
+// Host stand-in for olikraus/U8g2: renders into a real 128x64 page buffer
+// (SSD1306 layout, 8 pages x 128 columns) with fixed-size block "glyphs", so
+// the caller's drawing cost is exercised while the transport is a no-op.
+
+#define U8X8_PIN_NONE 255
+#define U8G2_R0       0
+
+// Fonts are reduced to {glyph width, glyph height}
+static const uint8_t u8g2_font_7x14B_tf[] = {7, 14};
+static const uint8_t u8g2_font_6x10_tf[]  = {6, 10};
+static const uint8_t u8g2_font_5x7_tf[]   = {5, 7};
+static const uint8_t u8g2_font_4x6_tf[]   = {4, 6};
+
+class U8G2 {
+public:
+    static constexpr uint8_t WIDTH  = 128;
+    static constexpr uint8_t HEIGHT = 64;
+
+    bool begin() { return true; }
+    void setContrast(uint8_t value) { contrast = value; }
+    void setPowerSave(uint8_t on)   { powerSave = on; }
+    void setFont(const uint8_t* f)  { font = f; }
+    void setDrawColor(uint8_t c)    { color = c; }
+
+    void clearBuffer() { memset(buffer, 0, sizeof(buffer)); }
+    void sendBuffer()  { frames++; }
+    void updateDisplayArea(uint8_t, uint8_t, uint8_t, uint8_t) { frames++; }
+
+    uint8_t* getBufferPtr()               { return buffer; }
+    uint8_t  getBufferTileWidth() const   { return WIDTH / 8; }
+    uint8_t  getBufferTileHeight() const  { return HEIGHT / 8; }
+
+    uint16_t getStrWidth(const char* s) const { return strlen(s) * font[0]; }
+
+    uint16_t drawStr(int16_t x, int16_t y, const char* s) {
+        int16_t top = y - font[1] + 1;
+        for (; *s; s++, x += font[0]) {
+            for (uint8_t dx = 0; dx + 1 < font[0]; dx++) {
+                uint8_t bits = static_cast<uint8_t>(*s) ^ (dx * 37);
+                for (uint8_t dy = 0; dy < font[1]; dy++) {
+                    if (bits & (1 << (dy & 7))) drawPixel(x + dx, top + dy);
+                }
+            }
+        }
+        return x;
+    }
+
+    void drawPixel(int16_t x, int16_t y) {
+        if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT) return;
+        uint8_t& b = buffer[(y / 8) * WIDTH + x];
+        uint8_t  m = 1 << (y & 7);
+        if (color == 0) b &= ~m;
+        else if (color == 2) b ^= m;
+        else b |= m;
+    }
+    void drawHLine(int16_t x, int16_t y, int16_t w) { for (int16_t i = 0; i < w; i++) drawPixel(x + i, y); }
+    void drawVLine(int16_t x, int16_t y, int16_t h) { for (int16_t i = 0; i < h; i++) drawPixel(x, y + i); }
+    void drawBox(int16_t x, int16_t y, int16_t w, int16_t h) { for (int16_t i = 0; i < h; i++) drawHLine(x, y + i, w); }
+    void drawFrame(int16_t x, int16_t y, int16_t w, int16_t h) {
+        drawHLine(x, y, w); drawHLine(x, y + h - 1, w);
+        drawVLine(x, y, h); drawVLine(x + w - 1, y, h);
+    }
+
+    uint32_t frames    = 0;
+    uint8_t  contrast  = 255;
+    uint8_t  powerSave = 0;
+
+private:
+    uint8_t        buffer[WIDTH * HEIGHT / 8] = {};
+    const uint8_t* font  = u8g2_font_6x10_tf;
+    uint8_t        color = 1;
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C(uint8_t rotation, uint8_t reset = U8X8_PIN_NONE,
+                                        uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE) {
+        (void)rotation; (void)reset; (void)clock; (void)data;
+    }
+};
+
+#endif // HOST_U8G2LIB_H
@@ -0,0 +1,19 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+// Host stand-in for the Arduino I2C driver; every address NACKs.
+class TwoWire {
+public:
+    void    begin() {}
+    void    begin(int sda, int scl) { (void)sda; (void)scl; }
+    void    setClock(uint32_t) {}
+    void    beginTransmission(uint8_t) {}
+    size_t  write(uint8_t) { return 1; }
+    uint8_t endTransmission(bool = true) { return 2; }
+};
+
+inline TwoWire Wire;
+
+#endif // HOST_WIRE_H
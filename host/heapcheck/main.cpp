@@ -0,0 +1,377 @@
+// Steady-state allocation check: runs what loop() does every tick — sensor
+// reads, queued MQTT commands, control, power budget, telemetry, display,
+// session trace and deferred log — for simulated hours on a virtual clock,
+// and fails if anything allocates once setup is done.
+//
+//   pio run -e heapcheck && .pio/build/heapcheck/program [--hours N] [--verbose]
+//
+// Exit code 0 if nothing allocated after setup, 1 otherwise; the first
+// allocations are printed with a backtrace. Wi-Fi, TLS, flash, OTA, the
+// watchdog and idle power only exist on the device; there
+// tele/<device>/health counts allocations per subsystem instead.
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <FilamentSettings.hpp>
+#include <DryerZone.hpp>
+#include <CommandDispatcher.hpp>
+#include <Telemetry.hpp>
+#include <DisplayManager.hpp>
+#include <TrendHistory.hpp>
+#include <PowerBudget.hpp>
+#include <Trace.hpp>
+#include <Pins.hpp>
+#include <Log.hpp>
+#include <execinfo.h>
+#include <unistd.h>
+#include "../sim/PlantModel.hpp"
+
+// ---------------------------------------------------------------------------
+// Allocation counting: glibc's malloc family is wrapped, which also catches
+// operator new and String growth.
+// ---------------------------------------------------------------------------
+
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void  __libc_free(void*);
+
+static constexpr uint8_t REPORTED = 5; // allocations printed with a backtrace
+
+static bool     armed      = false;
+static bool     inHook     = false;
+static uint64_t allocCount = 0;
+static uint64_t allocBytes = 0;
+
+static void counted(size_t n) {
+    if (!armed || inHook) return;
+    inHook = true;
+    allocCount++;
+    allocBytes += n;
+    if (allocCount <= REPORTED) {
+        // backtrace() was warmed up in setup, so this does not allocate itself
+        void* frames[16];
+        int   depth = backtrace(frames, 16);
+        fprintf(stderr, "allocation %llu of %zu bytes at %.3f s:\n",
+                (unsigned long long)allocCount, n, millis() / 1000.0);
+        backtrace_symbols_fd(frames + 2, depth - 2, STDERR_FILENO);
+    }
+    inHook = false;
+}
+
+extern "C" void* malloc(size_t n)              { counted(n); return __libc_malloc(n); }
+extern "C" void* calloc(size_t n, size_t size) { counted(n * size); return __libc_calloc(n, size); }
+extern "C" void* realloc(void* p, size_t n)    { counted(n); return __libc_realloc(p, n); }
+extern "C" void  free(void* p)                 { __libc_free(p); }
+
+// ---------------------------------------------------------------------------
+// Loopback for the power budget: messages on the circuit come back to the
+// client on the next pass, from fixed buffers
+// ---------------------------------------------------------------------------
+
+class LoopbackBus : public HostMqttBus {
+public:
+    void publish(PubSubClient&, const char* topic, const uint8_t* payload,
+                 unsigned int length, bool) override {
+        if (!prefix[0] || strncmp(topic, prefix, strlen(prefix)) != 0) return;
+        if (count == SLOTS || length >= sizeof(slots[0].payload)) {
+            lost++;
+            return;
+        }
+        Slot& s = slots[(head + count++) % SLOTS];
+        snprintf(s.topic, sizeof(s.topic), "%s", topic);
+        memcpy(s.payload, payload, length);
+        s.length = length;
+    }
+    void subscribe(PubSubClient&, const char* filter) override {
+        // "power/<circuit>/+" → "power/<circuit>/"
+        snprintf(prefix, sizeof(prefix), "%.*s", (int)strcspn(filter, "+#"), filter);
+    }
+
+    void pump(PubSubClient& client) {
+        for (uint8_t n = count; n > 0; n--) {
+            Slot& s = slots[head];
+            head = (head + 1) % SLOTS;
+            count--;
+            client.deliver(s.topic, s.payload, s.length);
+        }
+    }
+
+    uint32_t lost = 0;
+
+private:
+    static constexpr uint8_t SLOTS = 16;
+    struct Slot {
+        char     topic[96];
+        uint8_t  payload[256];
+        unsigned length;
+    };
+    Slot    slots[SLOTS];
+    uint8_t head = 0, count = 0;
+    char    prefix[64] = "";
+};
+
+// ---------------------------------------------------------------------------
+// The firmware's globals and per-tick work, as in src/main.cpp
+// ---------------------------------------------------------------------------
+
+DryerZone zones[DRYER_ZONE_COUNT] = {
+    {ZONE_PINS[0]},
+#if DRYER_ZONE_COUNT > 1
+    {ZONE_PINS[1]},
+#endif
+};
+
+PubSubClient   mqtt_client;
+LoopbackBus    bus;
+PowerBudget    powerBudgets[DRYER_ZONE_COUNT] = {
+    {mqtt_client},
+#if DRYER_ZONE_COUNT > 1
+    {mqtt_client},
+#endif
+};
+DisplayManager display(BOARD.displaySda, BOARD.displayScl);
+TrendHistory   trends[DRYER_ZONE_COUNT];
+TraceRecorder  trace(zones, DRYER_ZONE_COUNT);
+Telemetry      telemetry(mqtt_client, mqtt_topics, DRYER_ZONE_COUNT);
+PlantModel     plants[DRYER_ZONE_COUNT];
+
+constexpr uint32_t TICK_MS          = 1000;
+constexpr uint32_t SLOT_MS          = TICK_MS / DRYER_ZONE_COUNT;
+constexpr uint32_t STEP_MS          = 100;
+constexpr uint32_t COMMAND_STATS_MS = 60000;
+constexpr uint8_t  TRACE_BATCH      = 192;
+
+struct NullLogSink : LogSink {
+    void write(const uint8_t*, const char*, size_t) override {}
+} nullLog;
+
+static CommandResult handleConfig(const char* action, JsonDocument& doc) {
+    if (!strcasecmp(action, "trace")) {
+        if (doc["on"] | false) trace.start(mqtt_topics.device(), mqtt_topics.group());
+        else                   trace.stop();
+        return CommandResult::OK;
+    }
+    if (!strcasecmp(action, "log")) {
+        LogLevel l;
+        if (!LogBuffer::levelFromName(doc["level"] | "", l)) return CommandResult::INVALID;
+        log_buffer.setLevel(l);
+        return CommandResult::OK;
+    }
+    return CommandResult::INVALID;
+}
+
+static void handleHistory(uint8_t zone, uint8_t count) {
+    telemetry.publishHistory(zone, zones[zone].controller, count);
+}
+
+CommandDispatcher commands(zones, DRYER_ZONE_COUNT, mqtt_topics, handleConfig, handleHistory);
+
+static void mqttCallback(char* topic, byte* payload, unsigned int length) {
+    bool power = false;
+    for (uint8_t i = 0; i < DRYER_ZONE_COUNT; i++) power |= powerBudgets[i].handle(topic, payload, length);
+    if (power) return;
+
+    if (mqtt_topics.commandOf(topic)) trace.command(topic, payload, length);
+    if (commands.dispatch(topic, payload, length)) {
+        mqtt_client.publish(mqtt_topics.stat("ack"), commands.ack());
+    }
+    trace.settle();
+}
+
+static void tickZone(uint8_t index) {
+    DryerZone& zone = zones[index];
+    zone.sensor.updateReadings();
+    trace.sensed(index);
+    trends[index].add(zone.sensor.getTemperature(), zone.sensor.getHumidity(),
+                      zone.heater.getTargetTemperature());
+
+    while (commands.pending()) {
+        if (commands.applyNext()) mqtt_client.publish(mqtt_topics.stat("ack"), commands.ack());
+    }
+    powerBudgets[index].update();
+    zone.controller.update();
+    trace.tick(index, false, zone.controller.isHeaterBlocked());
+
+    telemetry.publishState(zone, index);
+    CycleReport report;
+    if (zone.controller.takeCycleReport(report)) {
+        bool preset = report.preset < sizeof(filamentSettings) / sizeof(filamentSettings[0]);
+        telemetry.publishCycleReport(index, report,
+                                     preset ? filamentSettings[report.preset].material : "custom");
+    }
+}
+
+static void tickSystem() {
+    // Both pages, every other second
+    static bool trendPage = false;
+    trendPage = !trendPage;
+    DryerZone& zone = zones[0];
+    char label[16];
+    snprintf(label, sizeof(label), "1 %s", zone.controller.getStateName());
+    if (trendPage) {
+        display.showTrend(label, zone.sensor.getTemperature(), zone.sensor.getHumidity(), trends[0]);
+    } else {
+        display.update(label, zone.sensor.getTemperature(), zone.heater.getTargetTemperature(),
+                       zone.sensor.getHumidity(), zone.heater.computeRemainingTime() / 60000,
+                       zone.heaterRelay.getState(), zone.fanRelay.getState(),
+                       filamentSettings[0].material);
+    }
+
+    static uint32_t lastStats = 0;
+    if (millis() - lastStats >= COMMAND_STATS_MS) {
+        lastStats = millis();
+        telemetry.publishCommandLatency(commands.getLatency(), commands.getQueueStats());
+    }
+
+    uint8_t batch[TRACE_BATCH];
+    while (trace.pending()) {
+        uint16_t n = trace.peek(batch, sizeof(batch));
+        if (!mqtt_client.publish(mqtt_topics.tele("trace"), batch, n)) break;
+        trace.consume(n);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// What the outside world does, repeated every SCRIPT_PERIOD_MIN
+// ---------------------------------------------------------------------------
+
+struct Step {
+    uint16_t    minute;
+    const char* leaf;     // after cmnd/<device>/, nullptr for a button action
+    const char* payload;  // "%lu" takes a running command id
+};
+
+static const Step SCRIPT[] = {
+    {0,   "config",          "{\"action\":\"trace\",\"on\":true}"},
+    {0,   "filament",        "{\"material\":\"PETG\",\"id\":%lu}"},
+    {0,   "filament",        "{\"material\":\"PETG\",\"id\":%lu}"},   // redelivered while queued
+    {1,   "history",         "{\"count\":16}"},
+    {2,   "config",          "{\"action\":\"log\",\"level\":\"debug\"}"},
+    {3,   "fan",             "{\"state\":\"on\",\"id\":\"fan-%lu\"}"},
+    {3,   "control",         "{\"action\":\"stop\",\"id\":%lu}"},    // pre-empts the fan
+    {4,   "batch",           "{\"ops\":[{\"cmd\":\"filament\",\"material\":\"ABS\"},"
+                             "{\"cmd\":\"fan\",\"state\":\"on\"}],\"id\":%lu}"},
+    {5,   "heater",          "{\"state\":"},                          // bad JSON
+    {5,   "light",           "{\"state\":\"on\",\"id\":%lu}"},        // unknown command
+    {6,   "zone/9/filament", "{\"material\":\"PLA\",\"id\":%lu}"},    // no such zone
+    {7,   "config",          "{\"action\":\"log\",\"level\":\"info\"}"},
+    {150, nullptr,           "stop"},
+    {170, nullptr,           "start"},
+    {200, "zone/1/heater",   "{\"state\":\"on\"}"},
+    {201, "control",         "{\"action\":\"abort\",\"id\":\"abort-%lu\"}"},
+    {202, "history",         "{\"count\":4}"},
+    {210, "config",          "{\"action\":\"trace\",\"on\":false}"},
+};
+static constexpr uint16_t SCRIPT_PERIOD_MIN = 240;
+
+static void runStep(const Step& step, unsigned long id) {
+    if (!step.leaf) {
+        // handleButtons(): ENTER short starts the selected preset, long stops
+        DryerController& dryer = zones[0].controller;
+        if (!strcmp(step.payload, "start") && dryer.getState() == DryerState::IDLE) {
+            const FilamentSetting& s = filamentSettings[0];
+            trace.button(0, TraceButton::START, 0);
+            dryer.applyFilamentPreset(s.temperature, s.time, 0);
+            trace.settle();
+            telemetry.publishButtonEvent("enter", "press");
+        } else if (!strcmp(step.payload, "stop")) {
+            trace.button(0, TraceButton::STOP, DryerController::NO_PRESET);
+            dryer.reset();
+            trace.settle();
+            telemetry.publishButtonEvent("enter", "long_press");
+        }
+        return;
+    }
+    char topic[96], payload[160];
+    snprintf(topic, sizeof(topic), "cmnd/%s/%s", mqtt_topics.device(), step.leaf);
+    snprintf(payload, sizeof(payload), step.payload, id);
+    mqtt_client.deliver(topic, payload);
+}
+
+int main(int argc, char** argv) {
+    float hours   = 24;
+    bool  verbose = false;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--hours") && i + 1 < argc) hours = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--verbose"))           verbose = true;
+        else {
+            fprintf(stderr, "usage: %s [--hours N] [--verbose]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // setup()
+    HostSerial::echo = verbose;
+    log_buffer.addSink(&nullLog);
+    mqtt_topics.begin("heapcheck", "farm");
+    mqtt_client.bus = &bus;
+    mqtt_client.setCallback(mqttCallback);
+    for (uint8_t i = 0; i < mqtt_topics.subscriptionCount(); i++)
+        mqtt_client.subscribe(mqtt_topics.subscription(i), 1);
+    for (uint8_t i = 0; i < DRYER_ZONE_COUNT; i++) {
+        char node[PowerBudget::MAX_NAME + 1];
+        snprintf(node, sizeof(node), "heapcheck-z%u", i + 1);
+        powerBudgets[i].begin("farm", node, 1); // zones take turns with the heater
+        zones[i].controller.setHeaterGate(&powerBudgets[i]);
+        zones[i].sensor.setupDHT();
+    }
+    mqtt_client.subscribe(powerBudgets[0].subscription());
+    display.begin();
+    void* warm[4];
+    backtrace(warm, 4); // loads libgcc now rather than from inside the hook
+
+    armed = true;
+
+    uint64_t endMs     = (uint64_t)(hours * 3600000.0f);
+    uint32_t lastSlot  = 0;
+    uint8_t  nextZone  = 0;
+    size_t   nextStep  = 0;
+    uint32_t period    = 0;
+    unsigned long id   = 0;
+    uint32_t ticks     = 0;
+    for (uint64_t now = 0; now < endMs; now += STEP_MS) {
+        SimClock::advanceMs(STEP_MS);
+        for (uint8_t i = 0; i < DRYER_ZONE_COUNT; i++) {
+            plants[i].step(STEP_MS / 1000.0f, zones[i].heaterRelay.getState(), zones[i].fanRelay.getState());
+            zones[i].sensor.inject(plants[i].chamberTemperature(), plants[i].relativeHumidity());
+        }
+
+        // mqtt_client.loop()
+        uint32_t minute = (millis() / 60000) % SCRIPT_PERIOD_MIN;
+        uint32_t thisPeriod = millis() / 60000 / SCRIPT_PERIOD_MIN;
+        if (thisPeriod != period) {
+            period   = thisPeriod;
+            nextStep = 0;
+        }
+        while (nextStep < sizeof(SCRIPT) / sizeof(SCRIPT[0]) && SCRIPT[nextStep].minute <= minute) {
+            // Redeliveries repeat the previous id
+            if (nextStep == 0 || strcmp(SCRIPT[nextStep].payload, SCRIPT[nextStep - 1].payload)) id++;
+            runStep(SCRIPT[nextStep++], id);
+        }
+        bus.pump(mqtt_client);
+
+        if (millis() - lastSlot >= SLOT_MS) {
+            lastSlot = millis();
+            tickZone(nextZone);
+            if (nextZone == 0) tickSystem();
+            nextZone = (nextZone + 1) % DRYER_ZONE_COUNT;
+            ticks++;
+        }
+        log_buffer.drain();
+    }
+    armed = false;
+
+    auto q = commands.getQueueStats();
+    printf("%.1f h simulated, %lu zone ticks, %lu commands (%lu queued, %lu pre-empted), "
+           "%lu messages published\n",
+           hours, (unsigned long)ticks, (unsigned long)commands.getLatency().count(),
+           (unsigned long)q.queued, (unsigned long)q.preempted, (unsigned long)mqtt_client.published);
+    if (allocCount) {
+        printf("FAIL: %llu allocation(s), %llu bytes after setup\n",
+               (unsigned long long)allocCount, (unsigned long long)allocBytes);
+        return 1;
+    }
+    printf("OK: no allocation after setup\n");
+    return 0;
+}
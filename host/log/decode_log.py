@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+"""Turn binary log records (lib/log) back into text.
+
+The MQTT log sink publishes raw records on tele/<device>/log; each record
+holds the flash address of its format string, so decoding needs the ELF of
+the exact firmware that produced them:
+
+    mosquitto_sub -h broker -t tele/dryer-01/log -N | host/log/decode_log.py --env nodemcuv2
+    host/log/decode_log.py --elf firmware.elf capture.bin
+
+Record layout (little-endian, see lib/log/Log.hpp): size u8, level u8,
+millis u32, format address u32, then per argument a tag and its value:
+'i' int32, 'u' uint32, 'f' float32, 's' u8 length + bytes.
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+HEADER = 10
+LEVELS = "?EWID"
+SPEC = re.compile(rb"%([-+ #0-9.]*)(?:hh|h|ll|l|z|j|t|L)*([a-zA-Z%])")
+
+
+class Elf:
+    """Just enough ELF32 to read C strings by virtual address."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            sys.exit(f"{path}: not a 32-bit ELF file")
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x2E)
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, _, addr, offset, size = struct.unpack_from("<IIIIII", self.data, shoff + i * shentsize)
+            if sh_type != 8 and addr and size:  # SHT_NOBITS has no file contents
+                self.sections.append((addr, offset, size))
+
+    def string(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + address - addr
+                return self.data[start:self.data.index(b"\0", start)]
+        return None
+
+
+def arguments(record):
+    pos = HEADER
+    while pos < len(record):
+        tag = chr(record[pos])
+        if tag == "s":
+            length = record[pos + 1]
+            yield tag, record[pos + 2:pos + 2 + length].decode("utf-8", "replace")
+            pos += 2 + length
+        else:
+            fmt = {"i": "<i", "u": "<I", "f": "<f"}.get(tag)
+            if not fmt:
+                return
+            yield tag, struct.unpack_from(fmt, record, pos + 1)[0]
+            pos += 5
+
+
+def render(fmt, args):
+    """printf subset, as LogBuffer::format() applies it on the device."""
+    args = list(args)
+    out, pos = [], 0
+    for m in SPEC.finditer(fmt):
+        out.append(fmt[pos:m.start()].decode("utf-8", "replace"))
+        pos = m.end()
+        flags, conversion = m.group(1).decode(), m.group(2).decode()
+        if conversion == "%":
+            out.append("%")
+            continue
+        if not args:
+            out.append("?")
+            continue
+        tag, value = args.pop(0)
+        if tag == "s":
+            out.append(("%" + flags + "s") % value)
+        elif tag == "f":
+            out.append(("%" + flags + (conversion if conversion in "eEfgG" else "f")) % value)
+        elif conversion == "c":
+            out.append(("%" + flags + "c") % chr(value & 0xFF))
+        elif conversion in "xXo":
+            out.append(("%" + flags + conversion) % (value & 0xFFFFFFFF))
+        else:
+            out.append(("%" + flags + "d") % value)
+    out.append(fmt[pos:].decode("utf-8", "replace"))
+    return "".join(out)
+
+
+def records(stream):
+    while True:
+        size = stream.read(1)
+        if not size:
+            return
+        rest = stream.read(size[0] - 1)
+        if size[0] < HEADER or len(rest) < size[0] - 1:
+            sys.exit("truncated or misaligned record stream")
+        yield size + rest
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--env", default="nodemcuv2", help="PlatformIO environment")
+    parser.add_argument("--elf", help="firmware.elf (default: .pio/build/<env>/firmware.elf)")
+    parser.add_argument("input", nargs="?", help="record file (default: stdin)")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf or os.path.join(ROOT, ".pio", "build", args.env, "firmware.elf"))
+    stream = open(args.input, "rb") if args.input else sys.stdin.buffer
+
+    for record in records(stream):
+        level, ms, address = struct.unpack_from("<BII", record, 1)
+        fmt = elf.string(address)
+        text = render(fmt, arguments(record)) if fmt is not None else f"<no format at 0x{address:08x}>"
+        print(f"{ms // 1000:6d}.{ms % 1000:03d} {LEVELS[level] if level < len(LEVELS) else '?'} {text}",
+              flush=True)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+"""Package a PlatformIO build for FirmwareUpdate (lib/ota).
+
+Writes <out>/firmware-<version>.bin.gz (.bin for ESP32 builds, whose
+bootloader cannot inflate) and <out>/manifest.json, ready to be served by any
+plain HTTP server:
+
+    pio run -e nodemcuv2
+    host/ota/make_ota.py --env nodemcuv2 --base-url http://nas.local/dryer --out www/dryer
+    python3 -m http.server -d www 8080
+
+The version defaults to FIRMWARE_VERSION in lib/version/Version.hpp; build
+release images with -DFIRMWARE_VERSION=\\"x.y.z\\" and pass the same --version.
+"""
+import argparse
+import gzip
+import hashlib
+import json
+import os
+import re
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+
+def default_version():
+    with open(os.path.join(ROOT, "lib", "version", "Version.hpp")) as f:
+        match = re.search(r'#define FIRMWARE_VERSION "([^"]+)"', f.read())
+    return match.group(1) if match else None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--env", default="nodemcuv2", help="PlatformIO environment")
+    parser.add_argument("--image", help="firmware.bin (default: .pio/build/<env>/firmware.bin)")
+    parser.add_argument("--version", default=default_version())
+    parser.add_argument("--base-url", required=True, help="URL the output directory is served at")
+    parser.add_argument("--out", default="ota")
+    args = parser.parse_args()
+
+    image = args.image or os.path.join(ROOT, ".pio", "build", args.env, "firmware.bin")
+    with open(image, "rb") as f:
+        raw = f.read()
+
+    if args.env.startswith("esp32"):
+        packed = raw
+        name = "firmware-%s.bin" % args.version
+    else:
+        # mtime=0 keeps the archive, and so its MD5, reproducible
+        packed = gzip.compress(raw, compresslevel=9, mtime=0)
+        name = "firmware-%s.bin.gz" % args.version
+
+    os.makedirs(args.out, exist_ok=True)
+    with open(os.path.join(args.out, name), "wb") as f:
+        f.write(packed)
+
+    manifest = {
+        "version": args.version,
+        "url": "%s/%s" % (args.base_url.rstrip("/"), name),
+        "md5": hashlib.md5(packed).hexdigest(),
+        "size": len(packed),
+    }
+    with open(os.path.join(args.out, "manifest.json"), "w") as f:
+        json.dump(manifest, f, indent=2)
+        f.write("\n")
+
+    print("%s: %d -> %d bytes (%.0f%%)" % (name, len(raw), len(packed), 100.0 * len(packed) / len(raw)))
+    print(json.dumps(manifest))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
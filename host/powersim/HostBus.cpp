@@ -0,0 +1,288 @@
+#include "HostBus.hpp"
+#include <SimClock.hpp>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+bool topicMatches(const char* filter, const char* topic) {
+    while (*filter) {
+        if (*filter == '#') return true;
+        if (*filter == '+') {
+            while (*topic && *topic != '/') topic++;
+            filter++;
+            continue;
+        }
+        if (*filter != *topic) return false;
+        filter++;
+        topic++;
+    }
+    return *topic == '\0';
+}
+
+// ---------------------------------------------------------------------------
+// LocalBus
+// ---------------------------------------------------------------------------
+
+LocalBus::LocalBus(uint32_t latencyMs, uint32_t jitterMs, uint32_t seed)
+    : latencyUs(latencyMs * 1000), jitterUs(jitterMs * 1000), rng(seed ? seed : 1)
+{}
+
+uint32_t LocalBus::nextRandom() {
+    // xorshift32, reproducible across runs
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+void LocalBus::publish(PubSubClient& from, const char* topic, const uint8_t* payload,
+                       unsigned int length, bool) {
+    if (down.count(&from)) return;
+    for (auto& sub : subs) {
+        if (down.count(sub.first) || !topicMatches(sub.second.c_str(), topic)) continue;
+        int64_t delay = latencyUs;
+        if (jitterUs) delay += (int64_t)(nextRandom() % (2 * jitterUs + 1)) - jitterUs;
+        if (delay < 0) delay = 0;
+        inFlight.emplace(SimClock::nowUs() + delay,
+                         Message{sub.first, topic,
+                                 std::string(reinterpret_cast<const char*>(payload), length)});
+    }
+}
+
+void LocalBus::subscribe(PubSubClient& from, const char* filter) {
+    for (auto& sub : subs)
+        if (sub.first == &from && sub.second == filter) return;
+    subs.emplace_back(&from, filter);
+}
+
+void LocalBus::setDown(PubSubClient& client, bool isDown) {
+    if (isDown) down.insert(&client);
+    else        down.erase(&client);
+}
+
+void LocalBus::pump() {
+    while (!inFlight.empty() && inFlight.begin()->first <= SimClock::nowUs()) {
+        Message m = inFlight.begin()->second;
+        inFlight.erase(inFlight.begin());
+        if (down.count(m.to)) continue;
+        m.to->deliver(m.topic.c_str(), reinterpret_cast<const uint8_t*>(m.payload.data()),
+                      m.payload.size());
+        delivered++;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// SocketBus
+// ---------------------------------------------------------------------------
+
+static uint64_t realUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static constexpr uint16_t KEEPALIVE_S = 60;
+
+SocketBus::SocketBus(const char* host, uint16_t port) : host(host), port(port) {}
+
+SocketBus::~SocketBus() {
+    for (auto& c : conns)
+        if (c.second.fd >= 0) close(c.second.fd);
+}
+
+void SocketBus::putString(std::vector<uint8_t>& out, const char* s, size_t n) {
+    out.push_back(n >> 8);
+    out.push_back(n & 0xFF);
+    out.insert(out.end(), s, s + n);
+}
+
+void SocketBus::putHeader(std::vector<uint8_t>& out, uint8_t type, size_t remaining) {
+    out.push_back(type);
+    do {
+        uint8_t b = remaining % 128;
+        remaining /= 128;
+        if (remaining) b |= 0x80;
+        out.push_back(b);
+    } while (remaining);
+}
+
+bool SocketBus::attach(PubSubClient& client, const char* clientId) {
+    addrinfo hints = {}, *res = nullptr;
+    hints.ai_family   = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    char portStr[8];
+    snprintf(portStr, sizeof(portStr), "%u", port);
+    if (getaddrinfo(host.c_str(), portStr, &hints, &res) != 0) return false;
+
+    int fd = -1;
+    for (addrinfo* a = res; a; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        if (::connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd < 0) return false;
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    // CONNECT: protocol "MQTT" level 4, clean session
+    std::vector<uint8_t> body;
+    putString(body, "MQTT", 4);
+    body.push_back(4);
+    body.push_back(0x02);
+    body.push_back(KEEPALIVE_S >> 8);
+    body.push_back(KEEPALIVE_S & 0xFF);
+    putString(body, clientId, strlen(clientId));
+    std::vector<uint8_t> packet;
+    putHeader(packet, 0x10, body.size());
+    packet.insert(packet.end(), body.begin(), body.end());
+
+    Conn& c = conns[&client];
+    c.fd = fd;
+    if (!send(c, packet)) return false;
+
+    // CONNACK: 20 02 00 <rc>
+    uint8_t ack[4];
+    size_t  got = 0;
+    pollfd  p = {fd, POLLIN, 0};
+    while (got < sizeof(ack) && poll(&p, 1, 5000) > 0) {
+        ssize_t n = recv(fd, ack + got, sizeof(ack) - got, 0);
+        if (n <= 0) break;
+        got += n;
+    }
+    if (got < sizeof(ack) || ack[0] != 0x20 || ack[3] != 0) {
+        detach(client);
+        return false;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    client.bus = this;
+    lastPingUs = realUs();
+    return true;
+}
+
+void SocketBus::detach(PubSubClient& client) {
+    auto it = conns.find(&client);
+    if (it == conns.end()) return;
+    if (it->second.fd >= 0) {
+        const uint8_t disconnect[] = {0xE0, 0x00};
+        ::send(it->second.fd, disconnect, sizeof(disconnect), MSG_NOSIGNAL);
+        close(it->second.fd);
+    }
+    it->second.fd = -1;
+}
+
+bool SocketBus::connected(PubSubClient& from) {
+    auto it = conns.find(&from);
+    return it != conns.end() && it->second.fd >= 0;
+}
+
+bool SocketBus::send(Conn& c, const std::vector<uint8_t>& packet) {
+    size_t off = 0;
+    while (off < packet.size()) {
+        ssize_t n = ::send(c.fd, packet.data() + off, packet.size() - off, MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            pollfd p = {c.fd, POLLOUT, 0};
+            poll(&p, 1, 100);
+            continue;
+        }
+        if (n <= 0) {
+            close(c.fd);
+            c.fd = -1;
+            return false;
+        }
+        off += n;
+    }
+    return true;
+}
+
+void SocketBus::publish(PubSubClient& from, const char* topic, const uint8_t* payload,
+                        unsigned int length, bool retained) {
+    auto it = conns.find(&from);
+    if (it == conns.end() || it->second.fd < 0) return;
+
+    size_t topicLen = strlen(topic);
+    std::vector<uint8_t> packet;
+    putHeader(packet, 0x30 | (retained ? 1 : 0), 2 + topicLen + length);
+    putString(packet, topic, topicLen);
+    packet.insert(packet.end(), payload, payload + length);
+    send(it->second, packet);
+}
+
+void SocketBus::subscribe(PubSubClient& from, const char* filter) {
+    auto it = conns.find(&from);
+    if (it == conns.end() || it->second.fd < 0) return;
+    Conn& c = it->second;
+
+    size_t filterLen = strlen(filter);
+    std::vector<uint8_t> packet;
+    putHeader(packet, 0x82, 2 + 2 + filterLen + 1);
+    packet.push_back(c.packetId >> 8);
+    packet.push_back(c.packetId & 0xFF);
+    c.packetId++;
+    putString(packet, filter, filterLen);
+    packet.push_back(0); // QoS 0
+    send(c, packet);
+}
+
+void SocketBus::pump() {
+    bool ping = realUs() - lastPingUs > KEEPALIVE_S * 1000000ULL / 2;
+    if (ping) lastPingUs = realUs();
+
+    for (auto& entry : conns) {
+        Conn& c = entry.second;
+        if (c.fd < 0) continue;
+        if (ping) send(c, {0xC0, 0x00});
+
+        uint8_t buf[1024];
+        for (;;) {
+            ssize_t n = recv(c.fd, buf, sizeof(buf), 0);
+            if (n > 0) { c.rx.insert(c.rx.end(), buf, buf + n); continue; }
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                fprintf(stderr, "broker closed the connection\n");
+                close(c.fd);
+                c.fd = -1;
+            }
+            break;
+        }
+        parse(*entry.first, c);
+    }
+}
+
+void SocketBus::parse(PubSubClient& client, Conn& c) {
+    for (;;) {
+        // fixed header: type byte + 1..4 byte remaining length
+        size_t   pos = 1, remaining = 0, shift = 0;
+        bool     complete = false;
+        while (pos < c.rx.size() && pos <= 4) {
+            uint8_t b = c.rx[pos++];
+            remaining |= (size_t)(b & 0x7F) << shift;
+            shift += 7;
+            if (!(b & 0x80)) { complete = true; break; }
+        }
+        if (!complete || c.rx.size() < pos + remaining) return;
+
+        uint8_t type = c.rx[0] & 0xF0;
+        if (type == 0x30 && remaining >= 2) {
+            const uint8_t* p = c.rx.data() + pos;
+            size_t topicLen  = (p[0] << 8) | p[1];
+            size_t header    = 2 + topicLen + ((c.rx[0] & 0x06) ? 2 : 0);
+            if (header <= remaining) {
+                std::string topic(reinterpret_cast<const char*>(p + 2), topicLen);
+                client.deliver(topic.c_str(), p + header, remaining - header);
+                delivered++;
+            }
+        }
+        // SUBACK, PINGRESP and anything else are consumed silently
+        c.rx.erase(c.rx.begin(), c.rx.begin() + pos + remaining);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef HOST_BUS_HPP
+#define HOST_BUS_HPP
+
+#include <PubSubClient.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// MQTT topic filter match with '+' and '#' wildcards
+bool topicMatches(const char* filter, const char* topic);
+
+// In-process broker on the virtual clock. Every message reaches each
+// matching subscriber (the publisher included, as with a real broker)
+// after latency +- jitter; clients can be cut off to simulate a dead box.
+class LocalBus : public HostMqttBus {
+public:
+    LocalBus(uint32_t latencyMs, uint32_t jitterMs, uint32_t seed);
+
+    void publish(PubSubClient& from, const char* topic, const uint8_t* payload,
+                 unsigned int length, bool retained) override;
+    void subscribe(PubSubClient& from, const char* filter) override;
+    bool connected(PubSubClient& from) override { return !down.count(&from); }
+
+    void setDown(PubSubClient& client, bool isDown);
+
+    // Deliver everything that is due at the current virtual time
+    void pump();
+
+    uint64_t delivered = 0;
+
+private:
+    struct Message {
+        PubSubClient* to;
+        std::string   topic;
+        std::string   payload;
+    };
+
+    uint32_t latencyUs, jitterUs, rng;
+    std::vector<std::pair<PubSubClient*, std::string>> subs;
+    std::set<PubSubClient*>                            down;
+    std::multimap<uint64_t, Message>                   inFlight;
+
+    uint32_t nextRandom();
+};
+
+// Real MQTT 3.1.1 broker over TCP (QoS 0 only, enough for the power
+// budget). One connection per attached client.
+class SocketBus : public HostMqttBus {
+public:
+    SocketBus(const char* host, uint16_t port);
+    ~SocketBus();
+
+    // Opens the connection and waits for CONNACK; false on failure
+    bool attach(PubSubClient& client, const char* clientId);
+    void detach(PubSubClient& client);
+
+    void publish(PubSubClient& from, const char* topic, const uint8_t* payload,
+                 unsigned int length, bool retained) override;
+    void subscribe(PubSubClient& from, const char* filter) override;
+    bool connected(PubSubClient& from) override;
+
+    // Read whatever arrived and hand PUBLISH packets to the clients
+    void pump();
+
+    uint64_t delivered = 0;
+
+private:
+    struct Conn {
+        int                  fd = -1;
+        std::vector<uint8_t> rx;
+        uint16_t             packetId = 1;
+    };
+
+    std::string host;
+    uint16_t    port;
+    std::map<PubSubClient*, Conn> conns;
+    uint64_t    lastPingUs = 0;
+
+    bool send(Conn& c, const std::vector<uint8_t>& packet);
+    void parse(PubSubClient& client, Conn& c);
+    static void putString(std::vector<uint8_t>& out, const char* s, size_t n);
+    static void putHeader(std::vector<uint8_t>& out, uint8_t type, size_t remaining);
+};
+
+#endif // HOST_BUS_HPP
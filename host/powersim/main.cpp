@@ -0,0 +1,320 @@
+// Power budget simulator: several dryers on one circuit, each running the
+// real DryerController and PowerBudget against its own PlantModel, talking
+// over an in-process broker on the virtual clock or a real broker in
+// (accelerated) real time.
+//
+//   pio run -e powersim && .pio/build/powersim/program [options]
+//
+//   --nodes N          dryers on the circuit (default 4)
+//   --limit N          heaters allowed on at once (default 2)
+//   --material NAME    preset every dryer runs (default PETG)
+//   --stagger S        start dryer i at i*S seconds (default 0: power blip)
+//   --slot MIN         lease slot length (default 10)
+//   --latency MS       in-process broker latency (default 50)
+//   --jitter MS        +- latency jitter (default 20)
+//   --kill I@MIN       dryer I loses power at minute MIN (repeatable)
+//   --hours H          stop after H simulated hours (default: all done)
+//   --broker HOST:PORT use a real MQTT broker instead, e.g. a local mosquitto
+//   --speed X          virtual seconds per real second with --broker (default 50)
+//   --json             one JSON object per dryer plus a summary
+//   --verbose          echo the log output of every node
+//
+// Exits with 1 if more than --limit heaters were ever on at the same time, or
+// if a dryer never reached its target (with --hours: finished without it).
+
+#include <Arduino.h>
+#include <Relais.hpp>
+#include <NcRelay.hpp>
+#include <TempHumidity.hpp>
+#include <FilamentSettings.hpp>
+#include <HeaterSettings.hpp>
+#include <DryerController.hpp>
+#include <PowerBudget.hpp>
+#include <Pins.hpp>
+#include <Log.hpp>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../sim/PlantModel.hpp"
+#include "HostBus.hpp"
+
+static constexpr uint32_t STEP_MS = 100;
+static constexpr uint32_t TICK_MS = 1000;
+
+struct Node {
+    char            name[16];
+    TempHumidity    sensor{ZONE_PINS[0].dht, BOARD.sensorType};
+    HeaterSettings  heater{sensor};
+    Relais          heaterRelay{ZONE_PINS[0].heater, "Heater"};
+    NcRelay         fanRelay{ZONE_PINS[0].fan, "Fan"};
+    DryerController dryer{heater, heaterRelay, fanRelay, sensor};
+    PlantModel      plant;
+    PubSubClient    client;
+    PowerBudget     budget;
+
+    uint32_t startMs   = 0;
+    uint32_t killMs    = UINT32_MAX;
+    uint32_t lastTick  = 0;
+    bool     started   = false;
+    bool     alive     = true;
+    bool     done      = false;
+
+    uint64_t heaterMs     = 0;
+    uint64_t blockedMs    = 0;
+    uint64_t heaterMsFair = 0;  // heater time until the first dryer finished
+    float    timeToTargetS = -1;
+    float    doneS         = -1;
+
+    Node(const PlantParams& params, const PowerPolicy& policy)
+        : plant(params), budget(client, policy) {}
+};
+
+struct Kill {
+    unsigned node;
+    float    minute;
+};
+
+int main(int argc, char** argv) {
+    unsigned    nodeCount = 4;
+    unsigned    limit     = 2;
+    const char* material  = "PETG";
+    float       staggerS  = 0;
+    float       hours     = 0;
+    uint32_t    latencyMs = 50, jitterMs = 20;
+    const char* broker    = nullptr;
+    float       speed     = 50;
+    bool        json      = false;
+    bool        verbose   = false;
+    PowerPolicy policy;
+    std::vector<Kill> kills;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a   = argv[i];
+        bool        arg = i + 1 < argc;
+        if (!strcmp(a, "--json"))                   json = true;
+        else if (!strcmp(a, "--verbose"))           verbose = true;
+        else if (!strcmp(a, "--nodes") && arg)      nodeCount = atoi(argv[++i]);
+        else if (!strcmp(a, "--limit") && arg)      limit = atoi(argv[++i]);
+        else if (!strcmp(a, "--material") && arg)   material = argv[++i];
+        else if (!strcmp(a, "--stagger") && arg)    staggerS = atof(argv[++i]);
+        else if (!strcmp(a, "--slot") && arg)       policy.slotMs = atof(argv[++i]) * 60000;
+        else if (!strcmp(a, "--latency") && arg)    latencyMs = atoi(argv[++i]);
+        else if (!strcmp(a, "--jitter") && arg)     jitterMs = atoi(argv[++i]);
+        else if (!strcmp(a, "--hours") && arg)      hours = atof(argv[++i]);
+        else if (!strcmp(a, "--broker") && arg)     broker = argv[++i];
+        else if (!strcmp(a, "--speed") && arg)      speed = atof(argv[++i]);
+        else if (!strcmp(a, "--kill") && arg) {
+            Kill k;
+            if (sscanf(argv[++i], "%u@%f", &k.node, &k.minute) != 2) {
+                fprintf(stderr, "--kill expects NODE@MINUTE\n");
+                return 2;
+            }
+            kills.push_back(k);
+        } else {
+            fprintf(stderr, "unknown option: %s\n", a);
+            return 2;
+        }
+    }
+
+    SerialLogSink serialLog;
+    if (verbose) {
+        HostSerial::echo = true;
+        log_buffer.addSink(&serialLog);
+    }
+
+    const FilamentSetting* preset = nullptr;
+    uint8_t presetIndex = 0;
+    for (uint8_t i = 0; i < sizeof(filamentSettings) / sizeof(filamentSettings[0]); i++) {
+        if (!strcasecmp(filamentSettings[i].material, material)) {
+            preset      = &filamentSettings[i];
+            presetIndex = i;
+        }
+    }
+    if (!preset || nodeCount == 0 || nodeCount > PowerBudget::MAX_PEERS + 1 || limit == 0) {
+        fprintf(stderr, "need a known material, 1..%u nodes and a limit > 0\n",
+                PowerBudget::MAX_PEERS + 1);
+        return 2;
+    }
+
+    SimClock::reset();
+    PlantParams params;
+
+    std::unique_ptr<LocalBus>  localBus;
+    std::unique_ptr<SocketBus> socketBus;
+    if (broker) {
+        std::string host(broker);
+        uint16_t    port = 1883;
+        size_t      colon = host.rfind(':');
+        if (colon != std::string::npos) {
+            port = atoi(host.c_str() + colon + 1);
+            host.resize(colon);
+        }
+        socketBus.reset(new SocketBus(host.c_str(), port));
+    } else {
+        localBus.reset(new LocalBus(latencyMs, jitterMs, 12345));
+    }
+
+    // A random circuit name keeps runs against a shared broker apart
+    char circuit[32];
+    snprintf(circuit, sizeof(circuit), "sim-%08x",
+             (unsigned)std::chrono::steady_clock::now().time_since_epoch().count());
+
+    std::vector<std::unique_ptr<Node>> nodes;
+    for (unsigned i = 0; i < nodeCount; i++) {
+        nodes.emplace_back(new Node(params, policy));
+        Node& n = *nodes.back();
+        snprintf(n.name, sizeof(n.name), "dryer-%02u", i + 1);
+        n.startMs  = static_cast<uint32_t>(i * staggerS * 1000);
+        n.lastTick = (i * 137) % TICK_MS; // boxes never tick in lockstep
+
+        if (socketBus) {
+            if (!socketBus->attach(n.client, n.name)) {
+                fprintf(stderr, "cannot connect %s to broker %s\n", n.name, broker);
+                return 2;
+            }
+        } else {
+            n.client.bus = localBus.get();
+        }
+        Node* self = &n;
+        n.client.setCallback([self](char* topic, uint8_t* payload, unsigned int length) {
+            self->budget.handle(topic, payload, length);
+        });
+        n.dryer.setHeaterGate(&n.budget);
+    }
+    for (const Kill& k : kills) {
+        if (k.node >= 1 && k.node <= nodeCount) nodes[k.node - 1]->killMs = k.minute * 60000;
+    }
+
+    // The timers stand still while a box waits for heat, so a crowded circuit
+    // takes about nodes/limit cycle lengths
+    const uint64_t rounds  = (nodeCount + limit - 1) / limit;
+    const uint64_t limitMs = hours > 0 ? (uint64_t)(hours * 3600 * 1000)
+                                       : rounds * preset->time + 4ULL * 3600 * 1000 +
+                                             nodeCount * staggerS * 1000;
+    unsigned maxOn = 0;
+    uint64_t overLimitMs = 0;
+    bool     firstDone = false;
+    auto     wallStart = std::chrono::steady_clock::now();
+
+    while (millis() < limitMs) {
+        if (socketBus) {
+            // Hold virtual time to real time x speed so broker latency is real
+            auto due = wallStart + std::chrono::microseconds((uint64_t)(SimClock::nowUs() / speed));
+            std::this_thread::sleep_until(due);
+        }
+
+        unsigned on = 0;
+        for (auto& np : nodes) {
+            Node& n = *np;
+            bool heating = n.alive && n.heaterRelay.getState();
+            n.plant.step(STEP_MS / 1000.0f, heating, n.alive && n.fanRelay.getState());
+            if (heating) {
+                on++;
+                n.heaterMs += STEP_MS;
+                if (!firstDone) n.heaterMsFair += STEP_MS;
+            }
+            if (n.alive && n.dryer.isHeaterBlocked()) n.blockedMs += STEP_MS;
+        }
+        if (on > maxOn) maxOn = on;
+        if (on > limit) overLimitMs += STEP_MS;
+
+        SimClock::advanceMs(STEP_MS);
+        log_buffer.drain();
+        if (localBus)  localBus->pump();
+        if (socketBus) socketBus->pump();
+
+        bool allDone = true;
+        for (auto& np : nodes) {
+            Node& n = *np;
+            if (!n.alive) continue;
+
+            if (millis() >= n.killMs) {
+                // Power loss: relays drop out and the box vanishes from the broker
+                n.alive = false;
+                n.heaterRelay.turnOff();
+                if (localBus)  localBus->setDown(n.client, true);
+                if (socketBus) socketBus->detach(n.client);
+                continue;
+            }
+
+            if (!n.started && millis() >= n.startMs) {
+                // Boot: join the circuit, read the sensor, start the preset
+                n.started = true;
+                n.budget.begin(circuit, n.name, limit);
+                n.client.subscribe(n.budget.subscription());
+                n.sensor.inject(n.plant.chamberTemperature(), n.plant.relativeHumidity());
+                n.sensor.updateReadings();
+                n.dryer.applyFilamentPreset(preset->temperature, preset->time, presetIndex);
+            }
+            if (!n.started) { allDone = false; continue; }
+
+            if (millis() - n.lastTick >= TICK_MS) {
+                n.lastTick = millis();
+                n.sensor.inject(n.plant.chamberTemperature(), n.plant.relativeHumidity());
+                n.sensor.updateReadings();
+                if (n.timeToTargetS < 0 && n.sensor.getTemperature() >= CentiCelsius::fromWhole(preset->temperature))
+                    n.timeToTargetS = (millis() - n.startMs) / 1000.0f;
+
+                n.budget.update();
+                n.dryer.update();
+
+                if (!n.done && n.dryer.getState() == DryerState::IDLE) {
+                    n.done    = true;
+                    n.doneS   = (millis() - n.startMs) / 1000.0f;
+                    firstDone = true;
+                }
+            }
+            if (!n.done) allDone = false;
+        }
+        if (allDone) break;
+    }
+
+    // Fairness over the contended phase: Jain's index of heater time
+    double sum = 0, sumSq = 0;
+    unsigned counted = 0;
+    for (auto& np : nodes) {
+        if (np->killMs != UINT32_MAX) continue;
+        sum   += np->heaterMsFair;
+        sumSq += (double)np->heaterMsFair * np->heaterMsFair;
+        counted++;
+    }
+    double jain = sumSq > 0 ? sum * sum / (counted * sumSq) : 1.0;
+
+    // Without --hours every surviving box must have got up to temperature
+    unsigned underdried = 0;
+    for (auto& np : nodes)
+        if (np->alive && (np->done || hours <= 0) && np->timeToTargetS < 0) underdried++;
+    uint64_t delivered = localBus ? localBus->delivered : socketBus->delivered;
+    double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    if (json) {
+        for (auto& np : nodes) {
+            Node& n = *np;
+            printf("{\"node\":\"%s\",\"heaterMin\":%.1f,\"blockedMin\":%.1f,\"timeToTargetMin\":%.1f,"
+                   "\"doneMin\":%.1f,\"killed\":%s}\n",
+                   n.name, n.heaterMs / 60000.0, n.blockedMs / 60000.0,
+                   n.timeToTargetS < 0 ? -1 : n.timeToTargetS / 60, n.doneS < 0 ? -1 : n.doneS / 60,
+                   n.alive ? "false" : "true");
+        }
+        printf("{\"nodes\":%u,\"limit\":%u,\"material\":\"%s\",\"maxConcurrent\":%u,"
+               "\"overLimitS\":%.1f,\"fairness\":%.3f,\"messages\":%llu,\"simMin\":%.1f,\"wallS\":%.2f}\n",
+               nodeCount, limit, preset->material, maxOn, overLimitMs / 1000.0, jain,
+               (unsigned long long)delivered, millis() / 60000.0, wallS);
+    } else {
+        printf("%-10s %8s %8s %8s %8s %s\n", "node", "heat_min", "wait_min", "t2tgt_m", "done_m", "killed");
+        for (auto& np : nodes) {
+            Node& n = *np;
+            printf("%-10s %8.1f %8.1f %8.1f %8.1f %s\n", n.name, n.heaterMs / 60000.0,
+                   n.blockedMs / 60000.0, n.timeToTargetS < 0 ? -1 : n.timeToTargetS / 60,
+                   n.doneS < 0 ? -1 : n.doneS / 60, n.alive ? "no" : "yes");
+        }
+        printf("\n%u dryers, limit %u, %s: max %u heaters on at once, %.1f s over the limit,\n"
+               "fairness %.3f, %llu messages, %.1f simulated min in %.2f s\n",
+               nodeCount, limit, preset->material, maxOn, overLimitMs / 1000.0, jain,
+               (unsigned long long)delivered, millis() / 60000.0, wallS);
+    }
+
+    if (underdried) printf("FAIL: %u dryer(s) never reached %u C\n", underdried, preset->temperature);
+    return maxOn > limit || underdried ? 1 : 0;
+}
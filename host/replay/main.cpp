@@ -0,0 +1,346 @@
+// Replays a session trace (lib/trace) through the real DryerController,
+// HeaterSettings and CommandDispatcher on a virtual clock and diffs the
+// states and relay outputs against those recorded.
+//
+//   pio run -e replay && .pio/build/replay/program session.trace [options]
+//
+//   --dump         print every record as it is replayed
+//   --max-diffs N  divergences printed in full (default 20)
+//   --verbose      echo the log output
+//
+// Exit status 1 if the replay diverged from the recording, 2 if the trace
+// could not be read.
+
+#include <Arduino.h>
+#include <FilamentSettings.hpp>
+#include <DryerZone.hpp>
+#include <CommandDispatcher.hpp>
+#include <Topics.hpp>
+#include <Trace.hpp>
+#include <Log.hpp>
+#include <chrono>
+#include <vector>
+
+// The recorded power budget answer of the last tick
+class ReplayGate : public HeaterGate {
+public:
+    bool blocked = false;
+    bool mayEnergise(bool demand, bool) override { return !(demand && blocked); }
+};
+
+struct Outcome {
+    uint8_t state;
+    uint8_t outputs;
+
+    bool operator!=(const Outcome& o) const { return state != o.state || outputs != o.outputs; }
+};
+
+class Reader {
+public:
+    Reader(const std::vector<uint8_t>& data) : data(data), pos(0) {}
+
+    bool     done() const { return pos >= data.size(); }
+    size_t   offset() const { return pos; }
+    bool     ok() const { return !overrun; }
+    uint8_t  u8()  { return need(1) ? data[pos++] : 0; }
+    uint16_t u16() { uint16_t v = u8(); return v | u8() << 8; }
+    uint32_t u32() { uint32_t v = u16(); return v | (uint32_t)u16() << 16; }
+    uint32_t var() {
+        uint32_t v = 0;
+        for (uint8_t shift = 0; shift < 35; shift += 7) {
+            uint8_t b = u8();
+            v |= (uint32_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) break;
+        }
+        return v;
+    }
+    std::string bytes(size_t n) {
+        if (!need(n)) return std::string();
+        std::string s(reinterpret_cast<const char*>(&data[pos]), n);
+        pos += n;
+        return s;
+    }
+
+private:
+    const std::vector<uint8_t>& data;
+    size_t pos;
+    bool   overrun = false;
+
+    bool need(size_t n) {
+        if (pos + n > data.size()) { overrun = true; pos = data.size(); return false; }
+        return true;
+    }
+};
+
+static DryerZone zones[BoardProfile::MAX_ZONES] = {{ZONE_PINS[0]}, {ZONE_PINS[0]}, {ZONE_PINS[0]}};
+static ReplayGate gates[BoardProfile::MAX_ZONES];
+static uint8_t    zoneCount = 0;
+
+// Recorded config actions (reset, update, log, trace) touch nothing the
+// controller sees
+static CommandResult ignoreConfig(const char*, JsonDocument&) { return CommandResult::OK; }
+
+static Outcome outcomeOf(uint8_t zone) {
+    return {static_cast<uint8_t>(zones[zone].controller.getState()),
+            TraceRecorder::outputsOf(zones[zone])};
+}
+
+static const char* describe(const Outcome& o) {
+    static char buf[2][48];
+    static uint8_t which = 0;
+    which ^= 1;
+    snprintf(buf[which], sizeof(buf[which]), "%s heater=%s fan=%s",
+             DryerController::stateName((DryerState)o.state),
+             o.outputs & TRACE_HEATER ? "on" : "off", o.outputs & TRACE_FAN ? "on" : "off");
+    return buf[which];
+}
+
+// Same starting point as the recording: readings first, so guards see them
+static void restore(uint8_t zone, DryerState state, uint8_t preset, uint8_t targetC,
+                    uint32_t targetMs, uint32_t elapsedMs, uint8_t outputs) {
+    DryerController& c = zones[zone].controller;
+    c.setHeaterGate(&gates[zone]);
+    switch (state) {
+        case DryerState::HEATING:
+        case DryerState::HOLDING:
+        case DryerState::COOLING:
+            c.resumeCycle(state, preset, targetC, targetMs, elapsedMs);
+            break;
+        case DryerState::SAFETY:
+            c.setSafetyHold(true);
+            break;
+        case DryerState::MANUAL:
+            c.setManualFan(outputs & TRACE_FAN);
+            c.setManualHeater(outputs & TRACE_HEATER);
+            break;
+        default:
+            break;
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* path     = nullptr;
+    bool        dump     = false;
+    bool        verbose  = false;
+    uint32_t    maxDiffs = 20;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--dump"))                           dump = true;
+        else if (!strcmp(argv[i], "--verbose"))                   verbose = true;
+        else if (!strcmp(argv[i], "--max-diffs") && i + 1 < argc) maxDiffs = atoi(argv[++i]);
+        else                                                      path = argv[i];
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s session.trace [--dump] [--max-diffs N] [--verbose]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return 2;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t  n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(f);
+
+    SerialLogSink serialLog;
+    if (verbose) {
+        HostSerial::echo = true;
+        log_buffer.addSink(&serialLog);
+    }
+
+    Reader             in(data);
+    CommandDispatcher* dispatcher = nullptr; // zone count comes with the header
+    Outcome            expected[BoardProfile::MAX_ZONES] = {};
+    bool               diverged[BoardProfile::MAX_ZONES] = {};
+    bool               started = false, inputPending = false;
+    uint32_t           records = 0, ticks = 0, commands = 0, buttons = 0, gaps = 0, startMs = 0;
+    uint32_t           divergences = 0, divergentChecks = 0;
+    char               lastInput[160] = "start of trace";
+
+    // After an input and the RESULT records it produced
+    auto check = [&]() {
+        for (uint8_t z = 0; z < zoneCount; z++) {
+            Outcome actual = outcomeOf(z);
+            bool    differs = actual != expected[z];
+            if (differs) divergentChecks++;
+            if (differs && !diverged[z] && divergences++ < maxDiffs) {
+                printf("%10.3f s zone %u diverged after %s\n"
+                       "             recorded: %s\n             replayed: %s\n",
+                       millis() / 1000.0, z + 1, lastInput, describe(expected[z]), describe(actual));
+            } else if (!differs && diverged[z] && divergences <= maxDiffs) {
+                printf("%10.3f s zone %u back in step\n", millis() / 1000.0, z + 1);
+            }
+            diverged[z] = differs;
+        }
+    };
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    while (!in.done()) {
+        size_t    at   = in.offset();
+        TraceType type = static_cast<TraceType>(in.u8());
+        uint32_t  dt   = in.var();
+
+        if (!started && type != TraceType::HEADER) {
+            fprintf(stderr, "%s: no header at offset %zu; start the capture before the trace\n",
+                    path, at);
+            return 2;
+        }
+        if (type != TraceType::RESULT && inputPending) {
+            check();
+            inputPending = false;
+        }
+        SimClock::advanceMs(dt);
+        records++;
+
+        switch (type) {
+            case TraceType::HEADER: {
+                if (started) {
+                    fprintf(stderr, "%s: second session at offset %zu, replaying the first only\n",
+                            path, at);
+                    goto finished;
+                }
+                std::string magic = in.bytes(3);
+                if (magic[0] != 'D' || magic[1] != 'T' || (uint8_t)magic[2] != TraceRecorder::FORMAT) {
+                    fprintf(stderr, "%s: not a format %u trace\n", path, TraceRecorder::FORMAT);
+                    return 2;
+                }
+                zoneCount = in.u8();
+                if (zoneCount < 1 || zoneCount > BoardProfile::MAX_ZONES) {
+                    fprintf(stderr, "%s: %u zones\n", path, zoneCount);
+                    return 2;
+                }
+                startMs = in.u32();
+                SimClock::reset();
+                SimClock::advanceMs(startMs);
+                std::string device = in.bytes(in.u8());
+                std::string group  = in.bytes(in.u8());
+                mqtt_topics.begin(device.c_str(), group.c_str());
+                dispatcher = new CommandDispatcher(zones, zoneCount, mqtt_topics, ignoreConfig);
+                if (dump) printf("%10.3f HEADER %s group '%s', %u zone(s)\n", millis() / 1000.0,
+                                 device.c_str(), group.c_str(), zoneCount);
+
+                for (uint8_t z = 0; z < zoneCount; z++) {
+                    DryerState state   = (DryerState)in.u8();
+                    uint8_t    preset  = in.u8();
+                    uint8_t    targetC = in.u8();
+                    uint32_t   target  = in.u32();
+                    uint32_t   elapsed = in.u32();
+                    int16_t    deciC   = in.u16();
+                    int16_t    deciRH  = in.u16();
+                    uint8_t    outputs = in.u8();
+                    zones[z].sensor.setTemperature(CentiCelsius::fromDeci(deciC));
+                    zones[z].sensor.setHumidity(CentiPercent::fromDeci(deciRH));
+                    restore(z, state, preset, targetC, target, elapsed, outputs);
+                    expected[z] = {static_cast<uint8_t>(state), outputs};
+                    if (dump) printf("           zone %u %s target %u °C, %lu of %lu min\n", z + 1,
+                                     describe(expected[z]), targetC, (unsigned long)elapsed / 60000,
+                                     (unsigned long)target / 60000);
+                }
+                started = inputPending = true;
+                break;
+            }
+            case TraceType::SENSOR: {
+                uint8_t z      = in.u8();
+                int16_t deciC  = in.u16();
+                int16_t deciRH = in.u16();
+                if (z >= zoneCount) goto corrupt;
+                zones[z].sensor.setTemperature(CentiCelsius::fromDeci(deciC));
+                zones[z].sensor.setHumidity(CentiPercent::fromDeci(deciRH));
+                if (dump) printf("%10.3f SENSOR zone %u %.1f °C %.1f %%\n", millis() / 1000.0,
+                                 z + 1, deciC / 10.0f, deciRH / 10.0f);
+                break;
+            }
+            case TraceType::TICK: {
+                uint8_t z     = in.u8();
+                uint8_t flags = in.u8();
+                if (z >= zoneCount) goto corrupt;
+                while (dispatcher->pending()) dispatcher->applyNext(); // as tickZone() does
+                gates[z].blocked = flags & TRACE_BLOCKED;
+                zones[z].controller.setSafetyHold(flags & TRACE_HOLD);
+                zones[z].controller.update();
+                snprintf(lastInput, sizeof(lastInput), "tick of zone %u", z + 1);
+                ticks++;
+                inputPending = true;
+                break;
+            }
+            case TraceType::BUTTON: {
+                uint8_t     z      = in.u8();
+                TraceButton action = (TraceButton)in.u8();
+                uint8_t     preset = in.u8();
+                if (z >= zoneCount) goto corrupt;
+                DryerController& c = zones[z].controller;
+                if (action == TraceButton::START && preset < sizeof(filamentSettings) / sizeof(filamentSettings[0])) {
+                    const FilamentSetting& s = filamentSettings[preset];
+                    c.applyFilamentPreset(s.temperature, s.time, preset);
+                    snprintf(lastInput, sizeof(lastInput), "button start %s on zone %u",
+                             s.material, z + 1);
+                } else {
+                    c.reset();
+                    snprintf(lastInput, sizeof(lastInput), "button stop on zone %u", z + 1);
+                }
+                if (dump) printf("%10.3f BUTTON %s\n", millis() / 1000.0, lastInput);
+                buttons++;
+                inputPending = true;
+                break;
+            }
+            case TraceType::COMMAND: {
+                std::string topic   = in.bytes(in.u8());
+                std::string payload = in.bytes(in.u16());
+                dispatcher->dispatch(topic.c_str(), (const byte*)payload.data(), payload.size());
+                snprintf(lastInput, sizeof(lastInput), "%s %s", topic.c_str(), payload.c_str());
+                if (dump) printf("%10.3f COMMAND %s\n", millis() / 1000.0, lastInput);
+                commands++;
+                inputPending = true;
+                break;
+            }
+            case TraceType::RESULT: {
+                uint8_t z = in.u8();
+                if (z >= zoneCount) goto corrupt;
+                expected[z].state   = in.u8();
+                expected[z].outputs = in.u8();
+                if (dump) printf("%10.3f RESULT zone %u %s\n", millis() / 1000.0, z + 1,
+                                 describe(expected[z]));
+                break;
+            }
+            case TraceType::GAP: {
+                uint32_t lost = in.var();
+                gaps++;
+                printf("%10.3f s %lu record(s) lost on the device, the replay may drift from here\n",
+                       millis() / 1000.0, (unsigned long)lost);
+                break;
+            }
+            default:
+                goto corrupt;
+        }
+        if (!in.ok()) goto corrupt;
+        log_buffer.drain();
+    }
+    if (inputPending) check();
+
+finished: {
+    double   wallUs    = std::chrono::duration<double, std::micro>(
+                             std::chrono::steady_clock::now() - wallStart).count();
+    uint32_t sessionMs = millis() - startMs;
+    printf("%lu records (%lu ticks, %lu commands, %lu button actions, %lu gaps) over %.1f min "
+           "replayed in %.1f ms, %.0fx real time\n",
+           (unsigned long)records, (unsigned long)ticks, (unsigned long)commands,
+           (unsigned long)buttons, (unsigned long)gaps, sessionMs / 60000.0, wallUs / 1000.0,
+           wallUs > 0 ? sessionMs * 1000.0 / wallUs : 0.0);
+    if (divergences) {
+        printf("DIVERGED: %lu divergence(s), out of step after %lu input(s)\n",
+               (unsigned long)divergences, (unsigned long)divergentChecks);
+        return 1;
+    }
+    printf("OK: states and relays match the recording\n");
+    return 0;
+}
+
+corrupt:
+    fprintf(stderr, "%s: corrupt or truncated record at offset %zu\n", path, in.offset());
+    return 2;
+}
@@ -0,0 +1,42 @@
+#include "PlantModel.hpp"
+#include <math.h>
+
+PlantModel::PlantModel(const PlantParams& params)
+    : p(params), elementC(params.ambientC), chamberC(params.ambientC),
+      vaporG(saturationGPerM3(params.ambientC) * params.ambientRH / 100.0f * params.chamberM3),
+      spoolG(params.spoolWaterG), heaterW(0.0f)
+{}
+
+void PlantModel::step(float dt, bool heaterOn, bool fanOn) {
+    // PTC: resistance rises steeply near the switch temperature
+    heaterW = heaterOn ? p.heaterNominalW / (1.0f + expf((elementC - p.ptcSwitchC) / 6.0f)) : 0.0f;
+
+    float coupling  = fanOn ? p.couplingFanWPerK : p.couplingStillWPerK;
+    float toChamber = coupling * (elementC - chamberC);
+    float fanHeat   = fanOn ? p.fanW : 0.0f; // motor losses end up in the chamber
+    float toAmbient = (p.lossWPerK + (fanOn ? p.fanLossWPerK : 0.0f)) * (chamberC - p.ambientC);
+
+    elementC += (heaterW - toChamber) / p.elementJPerK * dt;
+    chamberC += (toChamber + fanHeat - toAmbient) / p.chamberJPerK * dt;
+
+    // Desorption roughly doubles every 10 °C and stalls as the air saturates
+    float rh     = relativeHumidity();
+    float rate   = p.desorbPerHourAt50 / 3600.0f * powf(2.0f, (chamberC - 50.0f) / 10.0f);
+    float desorb = spoolG * rate * (1.0f - rh / 100.0f) * dt;
+    spoolG -= desorb;
+    vaporG += desorb;
+
+    float ambientVapor = saturationGPerM3(p.ambientC) * p.ambientRH / 100.0f * p.chamberM3;
+    float exchange     = (fanOn ? p.airChangesFan : p.airChangesStill) / 3600.0f * dt;
+    vaporG -= (vaporG - ambientVapor) * (exchange > 1.0f ? 1.0f : exchange);
+}
+
+float PlantModel::relativeHumidity() const {
+    float rh = vaporG / p.chamberM3 / saturationGPerM3(chamberC) * 100.0f;
+    return rh > 100.0f ? 100.0f : (rh < 0.0f ? 0.0f : rh);
+}
+
+float PlantModel::saturationGPerM3(float tempC) {
+    // Magnus formula, absolute humidity at 100 %RH
+    return 6.112f * expf(17.67f * tempC / (tempC + 243.5f)) * 216.74f / (273.15f + tempC);
+}
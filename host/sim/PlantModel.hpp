@@ -0,0 +1,53 @@
+#ifndef PLANT_MODEL_HPP
+#define PLANT_MODEL_HPP
+
+// Lumped thermal/moisture model of the dryer box for the host simulator.
+//
+// Two thermal nodes: the PTC element and the chamber (air, walls, spool).
+// The PTC's power collapses around its switch temperature, the fan raises
+// element-to-air coupling and ventilation, and the spool desorbs water into
+// the chamber air which is exchanged with ambient.
+struct PlantParams {
+    float ambientC          = 22.0f;
+    float ambientRH         = 50.0f;
+    float heaterNominalW    = 150.0f;  // cold PTC power
+    float ptcSwitchC        = 140.0f;  // PTC reference temperature
+    float fanW              = 2.0f;
+    float elementJPerK      = 60.0f;
+    float chamberJPerK      = 2500.0f; // air + walls + 1 kg spool
+    float couplingStillWPerK = 0.8f;   // element -> chamber, fan off
+    float couplingFanWPerK  = 5.0f;    // element -> chamber, fan on
+    float lossWPerK         = 1.3f;    // chamber -> ambient through the walls
+    float fanLossWPerK      = 0.4f;    // extra loss from forced ventilation
+    float chamberM3         = 0.02f;
+    float airChangesStill   = 0.5f;    // per hour
+    float airChangesFan     = 3.0f;    // per hour
+    float spoolWaterG       = 5.0f;    // 1 kg spool at 0.5 % moisture
+    float desorbPerHourAt50 = 0.35f;   // fraction of remaining water per hour at 50 °C
+};
+
+class PlantModel {
+public:
+    explicit PlantModel(const PlantParams& params = PlantParams());
+
+    // Advance the model by dt seconds with the given actuator states.
+    void step(float dt, bool heaterOn, bool fanOn);
+
+    float chamberTemperature() const { return chamberC; }
+    float elementTemperature() const { return elementC; }
+    float relativeHumidity()   const;
+    float heaterPowerW()       const { return heaterW; }
+    float spoolWaterG()        const { return spoolG; }
+
+private:
+    PlantParams p;
+    float elementC;
+    float chamberC;
+    float vaporG;   // water vapour held by the chamber air
+    float spoolG;   // water still in the filament
+    float heaterW;  // electrical power drawn during the last step
+
+    static float saturationGPerM3(float tempC);
+};
+
+#endif // PLANT_MODEL_HPP
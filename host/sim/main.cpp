@@ -0,0 +1,240 @@
+// Host-side dryer simulator: drives the real DryerController/HeaterSettings
+// through fake relays and sensor against PlantModel on a virtual clock.
+//
+//   pio run -e native && .pio/build/native/program [MATERIAL|all] [options]
+//
+//   --ambient C    ambient temperature (default 22)
+//   --json         one JSON object per run instead of the table
+//   --verbose      echo the log output, state transitions included
+//   --trace FILE   record the run as a session trace for host/replay (one material)
+//   --diagram      print the transition table as a Mermaid state diagram
+
+#include <Arduino.h>
+#include <Relais.hpp>
+#include <NcRelay.hpp>
+#include <TempHumidity.hpp>
+#include <FilamentSettings.hpp>
+#include <HeaterSettings.hpp>
+#include <DryerController.hpp>
+#include <DryerZone.hpp>
+#include <Trace.hpp>
+#include <Pins.hpp>
+#include <Log.hpp>
+#include <chrono>
+#include "PlantModel.hpp"
+
+struct CycleMetrics {
+    const char* material;
+    uint8_t     targetC;
+    float       timeToTargetS;   // until the sensor first reports >= target, -1 if never
+    float       overshootC;      // peak true chamber temp above target while drying
+    float       holdingDutyPct;  // heater on-time share after target was reached
+    uint32_t    heaterCycles;
+    uint32_t    fanCycles;
+    float       heaterWh;
+    float       fanWh;
+    float       cycleS;          // preset applied until back in IDLE
+    float       waterRemovedG;
+    float       finalRH;
+    bool        safetyTripped;
+    double      wallUs;          // host time spent simulating
+    bool        reported;        // the controller's own CycleReport, to check against the plant
+    CycleReport report;
+};
+
+static constexpr uint32_t STEP_MS = 100;
+static constexpr uint32_t TICK_MS = 1000;
+
+// One edge per source/target pair, labelled with every rule that takes it
+static void printDiagram() {
+    const uint8_t states = static_cast<uint8_t>(DryerState::COUNT);
+    printf("stateDiagram-v2\n    [*] --> IDLE\n");
+    for (uint8_t from = 0; from < states; from++) {
+        printf("\n");
+        for (uint8_t to = 0; to < states; to++) {
+            char label[160] = "";
+            for (uint8_t r = 0; r < DryerController::ruleCount(); r++) {
+                DryerController::RuleInfo rule = DryerController::rule(r);
+                if (!(rule.fromMask & (1 << from)) || static_cast<uint8_t>(rule.to) != to) continue;
+                if (label[0]) strncat(label, ", ", sizeof(label) - strlen(label) - 1);
+                strncat(label, rule.name, sizeof(label) - strlen(label) - 1);
+            }
+            if (label[0])
+                printf("    %s --> %s : %s\n", DryerController::stateName((DryerState)from),
+                       DryerController::stateName((DryerState)to), label);
+        }
+    }
+}
+
+static void writeTrace(TraceRecorder& trace, FILE* out) {
+    uint8_t buf[256];
+    while (trace.pending()) {
+        uint16_t n = trace.peek(buf, sizeof(buf));
+        fwrite(buf, 1, n, out);
+        trace.consume(n);
+    }
+}
+
+static CycleMetrics runCycle(const FilamentSetting& preset, uint8_t presetIndex,
+                             const PlantParams& params, FILE* traceOut) {
+    SimClock::reset();
+
+    DryerZone        zone(ZONE_PINS[0]);
+    TempHumidity&    sensor      = zone.sensor;
+    Relais&          heaterRelay = zone.heaterRelay;
+    NcRelay&         fanRelay    = zone.fanRelay;
+    DryerController& dryer       = zone.controller;
+    PlantModel       plant(params);
+    TraceRecorder    trace(&zone, 1);
+
+    CycleMetrics m = {};
+    m.material      = preset.material;
+    m.targetC       = preset.temperature;
+    m.timeToTargetS = -1.0f;
+
+    auto wallStart = std::chrono::steady_clock::now();
+
+    sensor.inject(plant.chamberTemperature(), plant.relativeHumidity());
+    sensor.updateReadings();
+    if (traceOut) trace.start("sim", "");
+    trace.button(0, TraceButton::START, presetIndex);
+    dryer.applyFilamentPreset(preset.temperature, preset.time, presetIndex);
+    trace.settle();
+
+    const uint32_t limitMs = preset.time + 4UL * 3600 * 1000;
+    uint32_t holdMs = 0, holdHeaterMs = 0;
+    uint32_t lastTick = millis();
+
+    while (millis() < limitMs) {
+        plant.step(STEP_MS / 1000.0f, heaterRelay.getState(), fanRelay.getState());
+        SimClock::advanceMs(STEP_MS);
+
+        m.heaterWh += plant.heaterPowerW() * STEP_MS / 3.6e6f;
+        if (fanRelay.getState()) m.fanWh += params.fanW * STEP_MS / 3.6e6f;
+
+        DryerState s  = dryer.getState();
+        bool drying   = (s == DryerState::HEATING || s == DryerState::HOLDING);
+        if (drying) {
+            float over = plant.chamberTemperature() - preset.temperature;
+            if (over > m.overshootC) m.overshootC = over;
+            if (m.timeToTargetS >= 0) {
+                holdMs += STEP_MS;
+                if (heaterRelay.getState()) holdHeaterMs += STEP_MS;
+            }
+        }
+
+        if (millis() - lastTick >= TICK_MS) {
+            lastTick = millis();
+            sensor.inject(plant.chamberTemperature(), plant.relativeHumidity());
+            sensor.updateReadings();
+            trace.sensed(0);
+            if (m.timeToTargetS < 0 && sensor.getTemperature() >= CentiCelsius::fromWhole(preset.temperature))
+                m.timeToTargetS = millis() / 1000.0f;
+
+            dryer.update();
+            trace.tick(0, false, false);
+            if (traceOut) writeTrace(trace, traceOut);
+            log_buffer.drain();
+            if (dryer.getState() == DryerState::SAFETY) m.safetyTripped = true;
+            if (dryer.getState() == DryerState::IDLE) break;
+        }
+    }
+
+    m.cycleS         = millis() / 1000.0f;
+    m.holdingDutyPct = holdMs ? 100.0f * holdHeaterMs / holdMs : 0.0f;
+    m.heaterCycles   = heaterRelay.getSwitchCount();
+    m.fanCycles      = fanRelay.getSwitchCount();
+    m.waterRemovedG  = params.spoolWaterG - plant.spoolWaterG();
+    m.finalRH        = plant.relativeHumidity();
+    m.reported       = dryer.takeCycleReport(m.report);
+    m.wallUs = std::chrono::duration<double, std::micro>(
+                   std::chrono::steady_clock::now() - wallStart).count();
+    return m;
+}
+
+static void printJson(const CycleMetrics& m, float ambientC) {
+    printf("{\"material\":\"%s\",\"targetC\":%u,\"ambientC\":%.1f,\"timeToTargetS\":%.0f,"
+           "\"overshootC\":%.2f,\"holdingDutyPct\":%.1f,\"heaterCycles\":%u,\"fanCycles\":%u,"
+           "\"heaterWh\":%.1f,\"fanWh\":%.2f,\"cycleS\":%.0f,\"waterRemovedG\":%.2f,"
+           "\"finalRH\":%.1f,\"safetyTripped\":%s,\"wallUs\":%.0f",
+           m.material, m.targetC, ambientC, m.timeToTargetS, m.overshootC, m.holdingDutyPct,
+           m.heaterCycles, m.fanCycles, m.heaterWh, m.fanWh, m.cycleS, m.waterRemovedG,
+           m.finalRH, m.safetyTripped ? "true" : "false", m.wallUs);
+    if (m.reported) {
+        const CycleReport& r = m.report;
+        printf(",\"report\":{\"end\":\"%s\",\"timeToTargetS\":%.0f,\"overshootC\":%.1f,"
+               "\"holdingDutyPct\":%u,\"heaterCycles\":%u,\"fanCycles\":%u,\"energyWh\":%.1f,"
+               "\"durationS\":%.0f,\"humidity\":[%.1f,%.1f,%.1f],\"safetyTrips\":%u}",
+               DryerController::rule(r.endRule).name, r.reached ? r.timeToTargetMs / 1000.0f : -1.0f,
+               r.overshootDeciC / 10.0f, r.holdingDutyPct(), r.heaterCycles, r.fanCycles,
+               r.energyDeciWh(BOARD.heaterW) / 10.0f, r.durationMs / 1000.0f, r.humidityStartDeci / 10.0f,
+               r.humidityEndDeci / 10.0f, r.humidityMinDeci / 10.0f, r.safetyTrips);
+    }
+    printf("}\n");
+}
+
+static void printRow(const CycleMetrics& m) {
+    printf("%-12s %4u %8.0f %7.2f %6.1f %6u %5u %8.1f %7.0f %6.2f %s %8.0f\n",
+           m.material, m.targetC, m.timeToTargetS, m.overshootC, m.holdingDutyPct,
+           m.heaterCycles, m.fanCycles, m.heaterWh, m.cycleS / 60.0f, m.waterRemovedG,
+           m.safetyTripped ? "yes" : " no", m.wallUs);
+}
+
+int main(int argc, char** argv) {
+    const char* material = "PLA";
+    bool        json     = false;
+    bool        verbose  = false;
+    const char* trace    = nullptr;
+    PlantParams params;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--json"))                      json = true;
+        else if (!strcmp(argv[i], "--verbose"))              verbose = true;
+        else if (!strcmp(argv[i], "--diagram"))              { printDiagram(); return 0; }
+        else if (!strcmp(argv[i], "--ambient") && i + 1 < argc) params.ambientC = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--trace") && i + 1 < argc)   trace = argv[++i];
+        else                                                  material = argv[i];
+    }
+
+    SerialLogSink serialLog;
+    if (verbose) {
+        HostSerial::echo = true;
+        log_buffer.addSink(&serialLog);
+    }
+
+    FILE* traceOut = nullptr;
+    if (trace) {
+        if (!strcasecmp(material, "all")) {
+            fprintf(stderr, "--trace records one material\n");
+            return 1;
+        }
+        traceOut = fopen(trace, "wb");
+        if (!traceOut) {
+            perror(trace);
+            return 1;
+        }
+    }
+
+    if (!json) {
+        printf("%-12s %4s %8s %7s %6s %6s %5s %8s %7s %6s %s %8s\n",
+               "material", "tgt", "t2tgt_s", "over_C", "duty%", "heatSw", "fanSw",
+               "heat_Wh", "cyc_min", "H2O_g", "safe", "wall_us");
+    }
+
+    bool found = false;
+    for (uint8_t i = 0; i < sizeof(filamentSettings) / sizeof(filamentSettings[0]); i++) {
+        const FilamentSetting& s = filamentSettings[i];
+        if (strcasecmp(material, "all") && strcasecmp(s.material, material)) continue;
+        found = true;
+        CycleMetrics m = runCycle(s, i, params, traceOut);
+        if (json) printJson(m, params.ambientC);
+        else      printRow(m);
+    }
+
+    if (traceOut) fclose(traceOut);
+    if (!found) {
+        fprintf(stderr, "unknown material: %s\n", material);
+        return 1;
+    }
+    return 0;
+}
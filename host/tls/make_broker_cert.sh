@@ -0,0 +1,49 @@
+#!/bin/sh
+# Make a local CA and a broker certificate for testing the TLS broker link
+# (lib/mqtt) against mosquitto:
+#
+#     host/tls/make_broker_cert.sh nas.local 192.168.1.10 [out-dir]
+#     mosquitto -c tls/mosquitto.conf -v
+#
+# Paste <out>/ca.crt into the setup portal's certificate field, or enter the
+# SHA-1 fingerprint printed at the end (that pins the broker certificate
+# itself and must be re-entered after every renewal). EC P-256 keys keep the
+# handshake cheap on the ESP8266.
+#
+# The box checks the name it dials (the portal's broker address, usually the
+# IP) against the certificate's DNS names and CN only; BearSSL ignores IP
+# entries. The IP therefore also goes in as a DNS name and as the CN.
+set -e
+
+name=${1:?usage: $0 <broker-hostname> <broker-ip> [out-dir]}
+ip=${2:?usage: $0 <broker-hostname> <broker-ip> [out-dir]}
+out=${3:-tls}
+days=3650
+
+mkdir -p "$out"
+cd "$out"
+
+openssl ecparam -name prime256v1 -genkey -noout -out ca.key
+openssl req -x509 -new -key ca.key -sha256 -days $days -subj "/CN=dryer broker CA" -out ca.crt
+
+openssl ecparam -name prime256v1 -genkey -noout -out broker.key
+openssl req -new -key broker.key -subj "/CN=$ip" -out broker.csr
+printf 'subjectAltName=DNS:%s,DNS:%s,IP:%s\nbasicConstraints=CA:FALSE\nkeyUsage=digitalSignature\nextendedKeyUsage=serverAuth\n' \
+    "$name" "$ip" "$ip" > broker.ext
+openssl x509 -req -in broker.csr -CA ca.crt -CAkey ca.key -CAcreateserial \
+    -sha256 -days $days -extfile broker.ext -out broker.crt
+rm broker.csr broker.ext
+
+cat > mosquitto.conf <<EOF
+# Plain listener for boxes not yet switched over; drop it once all use TLS
+listener 1883
+allow_anonymous true
+
+listener 8883
+cafile   $(pwd)/ca.crt
+certfile $(pwd)/broker.crt
+keyfile  $(pwd)/broker.key
+EOF
+
+echo "wrote $(pwd)/{ca.crt,broker.crt,broker.key,mosquitto.conf}"
+openssl x509 -in broker.crt -noout -fingerprint -sha1 | sed 's/.*=/broker SHA-1 fingerprint: /'
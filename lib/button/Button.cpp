@@ -1,36 +1,78 @@
 #include "Button.hpp"
 
+constexpr uint8_t  Button::RING_SIZE;
+constexpr uint32_t Button::DEBOUNCE_MS;
+constexpr uint32_t Button::LONG_PRESS_MS;
+
 Button::Button(uint8_t pin)
-    : _pin(pin), _lastRaw(false), _debounced(false), _longFired(false),
-      _pressStart(0), _shortEvent(false), _longEvent(false)
+    : _pin(pin), _head(0), _dropped(0), _tail(0), _rawDown(false), _rawSince(0),
+      _pressed(false), _longFired(false), _pressStart(0), _shortEvent(false), _longEvent(false)
 {}
 
 void Button::begin() {
     pinMode(_pin, INPUT_PULLUP);
+    _rawDown  = (digitalRead(_pin) == LOW);
+    _rawSince = millis();
+    attachInterruptArg(digitalPinToInterrupt(_pin), onEdge, this, CHANGE);
+}
+
+void IRAM_ATTR Button::onEdge(void* arg) {
+    Button* b = static_cast<Button*>(arg);
+    uint8_t head = b->_head;
+    uint8_t next = (head + 1) & (RING_SIZE - 1);
+    if (next == b->_tail) {
+        b->_dropped = b->_dropped + 1; // update() resyncs from the pin level
+        return;
+    }
+    b->_ring[head].ms   = millis();
+    b->_ring[head].down = (digitalRead(b->_pin) == LOW);
+    // Publish the slot only after it is filled
+    __asm__ __volatile__("" ::: "memory");
+    b->_head = next;
 }
 
 void Button::update() {
-    bool raw = (digitalRead(_pin) == LOW);
-    uint32_t now = millis();
-
-    if (raw != _lastRaw) {
-        _lastRaw = raw;
-        if (raw) {
-            _pressStart  = now;
-            _debounced   = false;
-            _longFired   = false;
-        } else if (_debounced && !_longFired) {
-            _shortEvent = true;
-        }
+    while (_tail != _head) {
+        const Edge& e = _ring[_tail];
+        edge(e.down, e.ms);
+        __asm__ __volatile__("" ::: "memory");
+        _tail = (_tail + 1) & (RING_SIZE - 1);
     }
 
-    if (raw && !_debounced && (now - _pressStart) >= DEBOUNCE_MS) {
-        _debounced = true;
+    // Lost or coalesced edges: trust the pin if it disagrees
+    uint32_t now  = millis();
+    bool     down = (digitalRead(_pin) == LOW);
+    if (down != _rawDown) edge(down, now);
+
+    settle(now);
+
+    if (_pressed && !_longFired && (now - _pressStart) >= LONG_PRESS_MS) {
+        _longFired = true;
+        _longEvent = true;
     }
+}
+
+void Button::edge(bool down, uint32_t ms) {
+    if (down == _rawDown) return; // bounce read back the same level
+    settle(ms);
+    _rawDown  = down;
+    _rawSince = ms;
+}
+
+// Commit the raw level once it has been stable for DEBOUNCE_MS, timestamped
+// with the edge that started it
+void Button::settle(uint32_t now) {
+    if (_rawDown == _pressed || (now - _rawSince) < DEBOUNCE_MS) return;
 
-    if (raw && _debounced && !_longFired && (now - _pressStart) >= LONG_PRESS_MS) {
-        _longFired  = true;
-        _longEvent  = true;
+    _pressed = _rawDown;
+    if (_pressed) {
+        _pressStart = _rawSince;
+        _longFired  = false;
+    } else if (!_longFired) {
+        // Released before update() saw the threshold: classify by duration
+        if (_rawSince - _pressStart >= LONG_PRESS_MS) _longEvent = true;
+        else                                          _shortEvent = true;
+        _longFired = true;
     }
 }
 
@@ -3,6 +3,14 @@
 
 #include <Arduino.h>
 
+// Active-low push button read by a CHANGE interrupt.
+//
+// The ISR only timestamps the edge and pushes it into a small
+// single-producer/single-consumer ring; update() replays the edges in order,
+// so debounce and short/long classification use the time each edge really
+// happened, not the time loop() got round to it. A press made while loop()
+// sat in a DHT read or a broker reconnect is still classified correctly.
+// The pin must be interrupt capable (any GPIO except 16).
 class Button {
 public:
     Button(uint8_t pin);
@@ -10,16 +18,39 @@ public:
     void update();           // call once per loop before reading events
     bool wasPressed();       // short press: released before LONG_PRESS_MS
     bool wasLongPressed();   // held for >= LONG_PRESS_MS (fires once at threshold)
+    bool isHeld() const { return _pressed; } // down, past debounce
+
+    uint16_t droppedEdges() const { return _dropped; } // ring overflows since boot
 
 private:
+    struct Edge {
+        uint32_t ms;
+        bool     down;
+    };
+
+    static constexpr uint8_t RING_SIZE = 16; // power of two
+
     uint8_t  _pin;
-    bool     _lastRaw;
-    bool     _debounced;
+
+    // written by the ISR only
+    Edge              _ring[RING_SIZE];
+    volatile uint8_t  _head;
+    volatile uint16_t _dropped;
+    // written by update() only
+    volatile uint8_t  _tail;
+
+    bool     _rawDown;      // level of the last edge seen
+    uint32_t _rawSince;     // ... and when it happened
+    bool     _pressed;      // debounced state
     bool     _longFired;
     uint32_t _pressStart;
     bool     _shortEvent;
     bool     _longEvent;
 
+    static void IRAM_ATTR onEdge(void* self);
+    void edge(bool down, uint32_t ms);
+    void settle(uint32_t now);
+
     static constexpr uint32_t DEBOUNCE_MS   = 50;
     static constexpr uint32_t LONG_PRESS_MS = 3000;
 };
@@ -0,0 +1,75 @@
+#include "Calibration.hpp"
+
+constexpr uint8_t CalibrationTable::MAX_POINTS;
+constexpr int16_t CalibrationTable::MIN_GAP;
+constexpr uint8_t CalibrationTable::SLOPE_SHIFT;
+constexpr int32_t CalibrationTable::SLOPE_ONE;
+constexpr int32_t CalibrationTable::SLOPE_MIN;
+constexpr int32_t CalibrationTable::SLOPE_MAX;
+constexpr CalibrationTable::Point Calibration::DEFAULT_TEMPERATURE;
+
+CalibrationTable::CalibrationTable(int16_t low, int16_t high, int16_t maxOffset)
+    : n(0), low(low), high(high), maxOffset(maxOffset) {}
+
+bool CalibrationTable::set(const Point* in, uint8_t count) {
+    if (count > MAX_POINTS) return false;
+
+    Point sorted[MAX_POINTS];
+    for (uint8_t i = 0; i < count; i++) {
+        Point p = in[i];
+        if (p.raw < low || p.raw > high || p.reference < low || p.reference > high) return false;
+        int32_t offset = (int32_t)p.reference - p.raw;
+        if (offset > maxOffset || offset < -maxOffset) return false;
+        uint8_t j = i;
+        for (; j > 0 && sorted[j - 1].raw > p.raw; j--) sorted[j] = sorted[j - 1];
+        sorted[j] = p;
+    }
+
+    int32_t slope[MAX_POINTS];
+    for (uint8_t i = 0; i + 1 < count; i++) {
+        int32_t dx = sorted[i + 1].raw - sorted[i].raw;
+        if (dx < MIN_GAP) return false;
+        int32_t dy = sorted[i + 1].reference - sorted[i].reference;
+        slope[i]   = (dy * SLOPE_ONE + dx / 2) / dx;
+        if (slope[i] < SLOPE_MIN || slope[i] > SLOPE_MAX) return false;
+    }
+    // Beyond the last point the last segment continues; one point is an offset
+    if (count) slope[count - 1] = count > 1 ? slope[count - 2] : SLOPE_ONE;
+
+    for (uint8_t i = 0; i < count; i++) {
+        points[i] = sorted[i];
+        slopes[i] = slope[i];
+    }
+    n = count;
+    return true;
+}
+
+bool CalibrationTable::add(Point point) {
+    Point   merged[MAX_POINTS];
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < n; i++) {
+        int32_t gap = (int32_t)points[i].raw - point.raw;
+        if (gap > -MIN_GAP && gap < MIN_GAP) continue; // replaced
+        merged[count++] = points[i];
+    }
+    if (count == MAX_POINTS) return false;
+    merged[count++] = point;
+    return set(merged, count);
+}
+
+int16_t CalibrationTable::apply(int16_t raw) const {
+    if (!n) return raw;
+
+    uint8_t i = n - 1;
+    while (i > 0 && raw < points[i].raw) i--;
+
+    // |raw - points[i].raw| < 2^16 and slope <= 2^15: the product fits
+    int32_t corrected = points[i].reference +
+        (((int32_t)(raw - points[i].raw) * slopes[i] + SLOPE_ONE / 2) >> SLOPE_SHIFT);
+    // A slope continued past the outer points may drift further than any point
+    if (corrected < raw - maxOffset) corrected = raw - maxOffset;
+    if (corrected > raw + maxOffset) corrected = raw + maxOffset;
+    if (corrected < low)  return low;
+    if (corrected > high) return high;
+    return (int16_t)corrected;
+}
@@ -0,0 +1,78 @@
+#ifndef CALIBRATION_HPP
+#define CALIBRATION_HPP
+
+#include <stdint.h>
+
+// Multi-point correction of one sensor quantity, in hundredths (centi-°C or
+// centi-%RH). Holds up to MAX_POINTS pairs of sensor reading and reference
+// measurement; between two points the correction is linear, beyond the first
+// and last it follows the nearest segment. Without points readings pass
+// unchanged, a single point is a constant offset.
+//
+// set() precomputes every segment's slope in Q14 fixed point, so apply()
+// costs a scan over at most MAX_POINTS readings, one multiply and a shift.
+//
+// No point and no corrected reading is further than maxOffset from what the
+// sensor read: control and the safety supervisor see corrected values, so a
+// wrong table may move the over-temperature cutoff by that much at most.
+class CalibrationTable {
+public:
+    struct Point {
+        int16_t raw;       // what the sensor read
+        int16_t reference; // what a reference instrument read at the same time
+    };
+
+    // Readings and references outside low..high are refused; apply() clamps
+    // its result to the same range
+    CalibrationTable(int16_t low, int16_t high, int16_t maxOffset);
+
+    // Points in any order. Refused, leaving the table as it was, if two
+    // readings are less than MIN_GAP apart, a reference is more than
+    // maxOffset from its reading or a segment's slope is outside 1/2..2.
+    bool set(const Point* points, uint8_t count);
+
+    // Adds one point, replacing one whose reading is less than MIN_GAP away
+    bool add(Point point);
+
+    void clear() { n = 0; }
+
+    int16_t apply(int16_t raw) const;
+
+    uint8_t      count() const { return n; }
+    const Point& point(uint8_t i) const { return points[i]; }
+
+    static constexpr uint8_t MAX_POINTS = 6;
+    static constexpr int16_t MIN_GAP    = 100; // 1 °C or 1 %RH
+
+private:
+    Point   points[MAX_POINTS]; // sorted by reading
+    int32_t slopes[MAX_POINTS]; // Q14, of the segment starting at points[i]
+    uint8_t n;
+    int16_t low;
+    int16_t high;
+    int16_t maxOffset;
+
+    static constexpr uint8_t SLOPE_SHIFT = 14;
+    static constexpr int32_t SLOPE_ONE   = 1L << SLOPE_SHIFT;
+    static constexpr int32_t SLOPE_MIN   = SLOPE_ONE / 2;
+    static constexpr int32_t SLOPE_MAX   = SLOPE_ONE * 2; // keeps apply() inside int32
+};
+
+// Both tables of one zone's sensor. An uncalibrated zone reads 1 °C below
+// its sensor, the fixed offset the firmware has always applied.
+struct Calibration {
+    CalibrationTable temperature{-4000, 12500, 1000}; // DHT22 range, -40..125 °C; ±10 °C
+    CalibrationTable humidity{0, 10000, 2000};        // ±20 %RH
+
+    Calibration() { temperature.add(DEFAULT_TEMPERATURE); }
+
+    // Still just the default offset, which a measured point should replace
+    bool isDefaultTemperature() const {
+        return temperature.count() == 1 && temperature.point(0).raw == DEFAULT_TEMPERATURE.raw &&
+               temperature.point(0).reference == DEFAULT_TEMPERATURE.reference;
+    }
+
+    static constexpr CalibrationTable::Point DEFAULT_TEMPERATURE = {2500, 2400}; // -1 °C
+};
+
+#endif // CALIBRATION_HPP
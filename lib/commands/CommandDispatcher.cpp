@@ -0,0 +1,288 @@
+#include "CommandDispatcher.hpp"
+#include <FilamentSettings.hpp>
+#include <Log.hpp>
+
+constexpr size_t  CommandDispatcher::MAX_ID;
+constexpr uint8_t CommandDispatcher::MAX_OPS;
+constexpr uint8_t CommandDispatcher::SEEN_IDS;
+constexpr uint8_t QueuedCommand::MAX_OPS;
+constexpr size_t  QueuedCommand::MAX_ID;
+constexpr uint8_t CommandQueue::SIZE;
+constexpr uint8_t CommandQueue::RESERVED;
+constexpr int8_t  CommandDispatcher::ALL_ZONES;
+constexpr int8_t  CommandDispatcher::BAD_ZONE;
+
+CommandDispatcher::CommandDispatcher(DryerZone* zones, uint8_t zoneCount, Topics& topics,
+                                     ConfigHandler onConfig, HistoryHandler onHistory)
+    : zones(zones), zoneCount(zoneCount), topics(topics), onConfig(onConfig),
+      onHistory(onHistory), seenHead(0)
+{
+    memset(seen, 0, sizeof(seen));
+    ackBuffer[0] = '\0';
+}
+
+bool CommandDispatcher::dispatch(const char* topic, const byte* payload, unsigned int length) {
+    uint32_t rxMs = millis();
+    uint32_t rxUs = micros();
+
+    char message[length + 1];
+    memcpy(message, payload, length);
+    message[length] = '\0';
+
+    const char* command = topics.commandOf(topic);
+    if (!command) return false;
+
+    LOG_INFO("MQTT | %s | %s", topic, message);
+
+    // Room for a batch of MAX_OPS operations of up to three members each
+    StaticJsonDocument<448> doc;
+    if (deserializeJson(doc, message)) {
+        LOG_WARN("MQTT | JSON parse error");
+        return false;
+    }
+
+    // Optional command id; numbers are acknowledged as their decimal string
+    char id[MAX_ID + 1] = "";
+    JsonVariant idField = doc["id"];
+    if (idField.is<const char*>()) {
+        strncpy(id, idField.as<const char*>(), MAX_ID);
+        id[MAX_ID] = '\0';
+    } else if (idField.is<long>()) {
+        snprintf(id, sizeof(id), "%ld", idField.as<long>());
+    }
+
+    const char* leaf = command;
+    int8_t      zone = zoneOf(leaf);
+
+    if (id[0]) {
+        SeenId* previous = findSeen(id);
+        if (previous) {
+            LOG_INFO("MQTT | duplicate id %s, not applied again", id);
+            buildAck(id, command, previous->result, true, zone, rxMs, 0);
+            return true;
+        }
+        if (queue.contains(id)) {
+            // Acknowledged once the tick applies the first copy
+            LOG_INFO("MQTT | duplicate id %s, already queued", id);
+            return false;
+        }
+    }
+
+    CommandResult result = CommandResult::OK;
+    if (!strcmp(command, "config")) {
+        // A reset restarts the box from inside the handler, before any ack
+        const char* action = doc["action"];
+        result = (action && onConfig) ? onConfig(action, doc) : CommandResult::INVALID;
+    } else if (zone == BAD_ZONE) {
+        LOG_WARN("MQTT | no such zone");
+        result = CommandResult::NO_SUCH_ZONE;
+    } else if (!strcmp(leaf, "history") && onHistory) {
+        // Read-only; without a zone segment every zone reports
+        uint8_t count = doc["count"] | (uint8_t)TransitionHistory::SIZE;
+        for (uint8_t i = 0; i < zoneCount; i++)
+            if (zone == ALL_ZONES || zone == i) onHistory(i, count);
+    } else {
+        QueuedCommand queued;
+        result = decode(leaf, zone, doc, queued);
+        if (result == CommandResult::OK) {
+            strncpy(queued.command, command, sizeof(queued.command) - 1);
+            queued.command[sizeof(queued.command) - 1] = '\0';
+            strcpy(queued.id, id);
+            queued.zone = zone;
+            queued.rxMs = rxMs;
+            queued.rxUs = rxUs;
+            if (queue.push(queued)) return false; // acknowledged by applyNext()
+            LOG_WARN("MQTT | command queue full, %s dropped", command);
+            result = CommandResult::QUEUE_FULL;
+        }
+    }
+
+    uint32_t handleUs = micros() - rxUs;
+    latency.add(handleUs);
+
+    if (!id[0]) return false;
+    remember(id, result);
+    buildAck(id, command, result, false, zone, rxMs, handleUs);
+    return true;
+}
+
+bool CommandDispatcher::applyNext() {
+    QueuedCommand queued;
+    if (!queue.pop(queued)) return false;
+
+    CommandResult result   = CommandResult::PREEMPTED;
+    uint32_t      handleUs = 0;
+    if (queued.preempted) {
+        LOG_INFO("MQTT | %s pre-empted by a stop", queued.command);
+    } else {
+        for (uint8_t i = 0; i < queued.opCount; i++) apply(queued.ops[i]);
+        result   = CommandResult::OK;
+        handleUs = micros() - queued.rxUs;
+        latency.add(handleUs);
+    }
+
+    if (!queued.id[0]) return false;
+    remember(queued.id, result);
+    buildAck(queued.id, queued.command, result, false, queued.zone, queued.rxMs, handleUs);
+    return true;
+}
+
+int8_t CommandDispatcher::zoneOf(const char*& command) const {
+    if (strncmp(command, "zone/", 5) != 0) return ALL_ZONES;
+
+    char* end;
+    long  zone = strtol(command + 5, &end, 10);
+    if (end == command + 5 || *end != '/' || zone < 1 || zone > zoneCount) return BAD_ZONE;
+    command = end + 1;
+    return zone - 1;
+}
+
+CommandDispatcher::SeenId* CommandDispatcher::findSeen(const char* id) {
+    for (uint8_t i = 0; i < SEEN_IDS; i++)
+        if (seen[i].id[0] && strcmp(seen[i].id, id) == 0) return &seen[i];
+    return nullptr;
+}
+
+void CommandDispatcher::remember(const char* id, CommandResult result) {
+    SeenId& slot = seen[seenHead];
+    strcpy(slot.id, id); // dispatch() already capped it at MAX_ID
+    slot.result = result;
+    seenHead = (seenHead + 1) % SEEN_IDS;
+}
+
+void CommandDispatcher::buildAck(const char* id, const char* command, CommandResult result,
+                                 bool duplicate, int8_t zone, uint32_t rxMs, uint32_t handleUs) {
+    StaticJsonDocument<256> doc;
+    doc["id"]        = id;
+    doc["command"]   = command;
+    doc["result"]    = resultName(result);
+    doc["duplicate"] = duplicate;
+
+    // Resulting state of the addressed zone, or of every zone for a broadcast
+    if (zone >= 0 || zoneCount == 1) {
+        doc["state"] = zones[zone >= 0 ? zone : 0].controller.getStateName();
+    } else {
+        JsonArray states = doc.createNestedArray("state");
+        for (uint8_t i = 0; i < zoneCount; i++) states.add(zones[i].controller.getStateName());
+    }
+
+    doc["rx"] = rxMs;               // uptime ms when the message arrived
+    if (!duplicate) {
+        doc["applied"]  = millis(); // uptime ms once the command took effect
+        doc["handleUs"] = handleUs;
+    }
+
+    serializeJson(doc, ackBuffer, sizeof(ackBuffer));
+}
+
+const char* CommandDispatcher::resultName(CommandResult result) {
+    switch (result) {
+        case CommandResult::OK:              return "ok";
+        case CommandResult::INVALID:         return "invalid";
+        case CommandResult::UNKNOWN_COMMAND: return "unknown_command";
+        case CommandResult::NO_SUCH_ZONE:    return "no_such_zone";
+        case CommandResult::QUEUE_FULL:      return "queue_full";
+        case CommandResult::PREEMPTED:       return "preempted";
+    }
+    return "invalid";
+}
+
+// Checks everything up front: a batch is queued whole or not at all
+CommandResult CommandDispatcher::decode(const char* command, int8_t zone, JsonDocument& doc,
+                                        QueuedCommand& out) {
+    out.opCount   = 0;
+    out.preempted = false;
+    out.id[0]     = '\0';
+
+    if (!strcmp(command, "batch")) {
+        JsonArray ops = doc["ops"];
+        if (ops.isNull() || ops.size() == 0 || ops.size() > MAX_OPS) return CommandResult::INVALID;
+        for (JsonObject args : ops) {
+            const char* name = args["cmd"];
+            if (!name || !strcmp(name, "batch")) return CommandResult::INVALID;
+
+            // Device-level batches may address a zone per operation
+            int8_t opZone = zone;
+            if (args.containsKey("zone")) {
+                int n = args["zone"] | 0;
+                if (zone != ALL_ZONES) return CommandResult::INVALID;
+                if (n < 1 || n > zoneCount) return CommandResult::NO_SUCH_ZONE;
+                opZone = n - 1;
+            }
+            CommandResult r = decodeOp(name, opZone, args, out.ops[out.opCount]);
+            if (r != CommandResult::OK) return r;
+            out.opCount++;
+        }
+    } else {
+        CommandResult r = decodeOp(command, zone, doc.as<JsonObject>(), out.ops[0]);
+        if (r != CommandResult::OK) return r;
+        out.opCount = 1;
+    }
+
+    out.zones  = 0;
+    out.urgent = true;
+    for (uint8_t i = 0; i < out.opCount; i++) {
+        const Operation& op = out.ops[i];
+        out.zones  |= op.zone == ALL_ZONES ? 0xFF : 1 << op.zone;
+        out.urgent &= op.op == CommandOp::STOP || op.op == CommandOp::ABORT;
+    }
+    return CommandResult::OK;
+}
+
+CommandResult CommandDispatcher::decodeOp(const char* command, int8_t zone, JsonObject args,
+                                          Operation& out) {
+    out.zone = zone;
+    out.arg  = 0;
+    if (!strcmp(command, "filament")) {
+        const char* material = args["material"];
+        if (!material) return CommandResult::INVALID;
+        for (uint8_t i = 0; i < sizeof(filamentSettings) / sizeof(filamentSettings[0]); i++) {
+            if (!strcasecmp(filamentSettings[i].material, material)) {
+                out.op  = CommandOp::PRESET;
+                out.arg = i;
+                return CommandResult::OK;
+            }
+        }
+        return CommandResult::INVALID;
+    }
+    if (!strcmp(command, "control")) {
+        const char* action = args["action"];
+        if (action && !strcasecmp(action, "stop")) {
+            out.op = CommandOp::STOP;
+            return CommandResult::OK;
+        }
+        if (action && !strcasecmp(action, "abort")) {
+            out.op = CommandOp::ABORT;
+            return CommandResult::OK;
+        }
+        return CommandResult::INVALID;
+    }
+    if (!strcmp(command, "heater") || !strcmp(command, "fan")) {
+        const char* state = args["state"];
+        if (!state) return CommandResult::INVALID;
+        out.op  = command[0] == 'h' ? CommandOp::HEATER : CommandOp::FAN;
+        out.arg = !strcasecmp(state, "on");
+        return CommandResult::OK;
+    }
+    return CommandResult::UNKNOWN_COMMAND;
+}
+
+void CommandDispatcher::apply(const Operation& op) {
+    for (uint8_t i = 0; i < zoneCount; i++)
+        if (op.zone == ALL_ZONES || op.zone == i) apply(zones[i].controller, op);
+}
+
+void CommandDispatcher::apply(DryerController& dryer, const Operation& op) {
+    switch (op.op) {
+        case CommandOp::PRESET: {
+            const FilamentSetting& s = filamentSettings[op.arg];
+            dryer.applyFilamentPreset(s.temperature, s.time, op.arg);
+            LOG_INFO("MQTT | preset applied: %s", s.material);
+            break;
+        }
+        case CommandOp::STOP:   dryer.reset();   break; // heater off, fan cools until <30 °C
+        case CommandOp::ABORT:  dryer.abort();   break; // everything off immediately
+        case CommandOp::HEATER: dryer.setManualHeater(op.arg); break;
+        case CommandOp::FAN:    dryer.setManualFan(op.arg);    break;
+    }
+}
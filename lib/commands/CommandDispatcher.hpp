@@ -0,0 +1,102 @@
+#ifndef COMMAND_DISPATCHER_HPP
+#define COMMAND_DISPATCHER_HPP
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <DryerController.hpp>
+#include <DryerZone.hpp>
+#include <Topics.hpp>
+#include "CommandQueue.hpp"
+#include "LatencyWindow.hpp"
+
+enum class CommandResult : uint8_t {
+    OK,
+    INVALID,          // missing or unknown argument
+    UNKNOWN_COMMAND,
+    NO_SUCH_ZONE,
+    QUEUE_FULL,
+    PREEMPTED         // cancelled by a stop/abort before its tick
+};
+
+// Decodes cmnd/<device|group|all>/* MQTT messages and applies them to the
+// zones' controllers. Kept free of network and filesystem code so it also
+// builds on the host.
+//
+// ".../zone/<n>/<command>" addresses zone n (1-based); a command without a
+// zone segment applies to every zone.
+//
+// Commands that drive a controller are decoded on arrival and queued;
+// applyNext() applies them from the control tick. ".../batch"
+// {"ops": [{"cmd": "filament", "material": "PETG"}, {"cmd": "fan", "state": "on"}]}
+// carries up to MAX_OPS of them, all checked before any is queued and applied
+// back to back. config and history are handled on arrival.
+//
+// A payload may carry an "id" (string or number). Such commands are
+// acknowledged once applied (or refused): dispatch()/applyNext() return true
+// and ack() holds the JSON for stat/<device>/ack. The last SEEN_IDS ids are
+// remembered, so a QoS 1 redelivery is acknowledged again but not applied
+// twice.
+class CommandDispatcher {
+public:
+    // Device-level .../config {"action": ...} ("reset", "update"); the
+    // handler owns what needs network or flash
+    typedef CommandResult (*ConfigHandler)(const char* action, JsonDocument& doc);
+
+    // .../history {"count": N}: publish the last N transitions of a zone
+    typedef void (*HistoryHandler)(uint8_t zone, uint8_t count);
+
+    CommandDispatcher(DryerZone* zones, uint8_t zoneCount, Topics& topics,
+                      ConfigHandler onConfig, HistoryHandler onHistory = nullptr);
+
+    // Returns true if an acknowledgement is waiting in ack()
+    bool dispatch(const char* topic, const byte* payload, unsigned int length);
+
+    // Applies the next queued command; returns true if an acknowledgement
+    // is waiting in ack()
+    bool    applyNext();
+    uint8_t pending() const { return queue.depth(); }
+
+    const char* ack() const { return ackBuffer; }
+
+    // Handling time (receive to applied) of every command that was applied
+    const LatencyWindow& getLatency() const { return latency; }
+    CommandQueue::Stats  getQueueStats() const { return queue.stats(); }
+
+    static const char* resultName(CommandResult result);
+
+    static constexpr size_t  MAX_ID   = QueuedCommand::MAX_ID;
+    static constexpr uint8_t MAX_OPS  = QueuedCommand::MAX_OPS;
+    static constexpr uint8_t SEEN_IDS = 8;
+
+private:
+    struct SeenId {
+        char          id[MAX_ID + 1];
+        CommandResult result;
+    };
+
+    DryerZone*         zones;
+    uint8_t            zoneCount;
+    Topics&            topics;
+    ConfigHandler      onConfig;
+    HistoryHandler     onHistory;
+    LatencyWindow      latency;
+    CommandQueue       queue;
+    SeenId             seen[SEEN_IDS];
+    uint8_t            seenHead;
+    char               ackBuffer[256];
+
+    int8_t        zoneOf(const char*& command) const;
+    CommandResult decode(const char* command, int8_t zone, JsonDocument& doc, QueuedCommand& out);
+    CommandResult decodeOp(const char* command, int8_t zone, JsonObject args, Operation& out);
+    void          apply(const Operation& op);
+    void          apply(DryerController& dryer, const Operation& op);
+    SeenId*       findSeen(const char* id);
+    void          remember(const char* id, CommandResult result);
+    void          buildAck(const char* id, const char* command, CommandResult result,
+                           bool duplicate, int8_t zone, uint32_t rxMs, uint32_t handleUs);
+
+    static constexpr int8_t ALL_ZONES = -1;
+    static constexpr int8_t BAD_ZONE  = -2;
+};
+
+#endif // COMMAND_DISPATCHER_HPP
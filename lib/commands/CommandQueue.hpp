@@ -0,0 +1,118 @@
+#ifndef COMMAND_QUEUE_HPP
+#define COMMAND_QUEUE_HPP
+
+#include <Arduino.h>
+
+enum class CommandOp : uint8_t { PRESET, STOP, ABORT, HEATER, FAN };
+
+// One decoded operation on one zone, or on every zone (zone -1).
+// arg: filamentSettings index for PRESET, 1/0 for HEATER and FAN.
+struct Operation {
+    CommandOp op;
+    int8_t    zone;
+    uint8_t   arg;
+};
+
+// A command waiting for the control tick: a single operation, or a batch
+// whose operations are applied back to back
+struct QueuedCommand {
+    static constexpr uint8_t MAX_OPS = 6;
+    static constexpr size_t  MAX_ID  = 24;
+
+    Operation ops[MAX_OPS];
+    uint8_t   opCount;
+    uint8_t   zones;       // bitmask of the zones it touches
+    bool      urgent;      // nothing but stop/abort
+    bool      preempted;
+    int8_t    zone;        // from the topic, for the acknowledgement
+    char      command[20]; // for the acknowledgement, e.g. "zone/2/filament"
+    char      id[MAX_ID + 1];
+    uint32_t  rxMs;
+    uint32_t  rxUs;
+};
+
+// Fixed-size, kept in arrival order. Urgent commands are taken first and
+// pre-empt queued work on the zones they cover: it is not applied, and
+// dropped at once unless an id waits for its acknowledgement. RESERVED slots
+// are only for urgent commands, so a flood of presets cannot lock out a stop.
+class CommandQueue {
+public:
+    static constexpr uint8_t SIZE     = 8;
+    static constexpr uint8_t RESERVED = 2;
+
+    struct Stats {
+        uint8_t  depth;
+        uint8_t  peak;      // most ever waiting at once
+        uint32_t queued;    // lifetime
+        uint32_t dropped;   // refused, queue full
+        uint32_t preempted; // cancelled by a stop/abort
+    };
+
+    CommandQueue() : count(0), peak(0), queued(0), dropped(0), preempted(0) {}
+
+    // False (and counted) if there is no room
+    bool push(const QueuedCommand& command) {
+        if (command.urgent) preempt(command.zones);
+        if (count >= (command.urgent ? SIZE : SIZE - RESERVED)) {
+            dropped++;
+            return false;
+        }
+        entries[count++] = command;
+        if (count > peak) peak = count;
+        queued++;
+        return true;
+    }
+
+    // The oldest urgent command, else the oldest
+    bool pop(QueuedCommand& out) {
+        if (!count) return false;
+        uint8_t next = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (entries[i].urgent) {
+                next = i;
+                break;
+            }
+        }
+        out = entries[next];
+        remove(next);
+        return true;
+    }
+
+    bool contains(const char* id) const {
+        for (uint8_t i = 0; i < count; i++)
+            if (strcmp(entries[i].id, id) == 0) return true;
+        return false;
+    }
+
+    uint8_t depth() const { return count; }
+    Stats   stats() const { return {count, peak, queued, dropped, preempted}; }
+
+private:
+    QueuedCommand entries[SIZE];
+    uint8_t       count;
+    uint8_t       peak;
+    uint32_t      queued;
+    uint32_t      dropped;
+    uint32_t      preempted;
+
+    void preempt(uint8_t zones) {
+        for (uint8_t i = 0; i < count;) {
+            QueuedCommand& c = entries[i];
+            if (c.urgent || c.preempted || !(c.zones & zones)) {
+                i++;
+                continue;
+            }
+            c.preempted = true;
+            preempted++;
+            if (c.id[0]) i++;
+            else         remove(i);
+        }
+    }
+
+    void remove(uint8_t index) {
+        memmove(&entries[index], &entries[index + 1], (count - index - 1) * sizeof(QueuedCommand));
+        count--;
+    }
+};
+
+#endif // COMMAND_QUEUE_HPP
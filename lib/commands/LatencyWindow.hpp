@@ -0,0 +1,64 @@
+#ifndef LATENCY_WINDOW_HPP
+#define LATENCY_WINDOW_HPP
+
+#include <Arduino.h>
+
+// Rolling statistics over the last SIZE samples (microseconds), plus
+// lifetime count and worst case. add() is O(1); summary() sorts a copy.
+class LatencyWindow {
+public:
+    static constexpr uint8_t SIZE = 32;
+
+    struct Summary {
+        uint32_t count;    // lifetime
+        uint32_t last;
+        uint32_t min;      // over the window
+        uint32_t mean;
+        uint32_t p95;
+        uint32_t max;
+        uint32_t worst;    // lifetime
+    };
+
+    LatencyWindow() : head(0), filled(0), total(0), worst(0) {}
+
+    void add(uint32_t us) {
+        samples[head] = us;
+        head = (head + 1) % SIZE;
+        if (filled < SIZE) filled++;
+        total++;
+        if (us > worst) worst = us;
+    }
+
+    uint32_t count() const { return total; }
+
+    Summary summary() const {
+        Summary s = {total, 0, 0, 0, 0, 0, worst};
+        if (!filled) return s;
+
+        uint32_t sorted[SIZE];
+        uint64_t sum = 0;
+        for (uint8_t i = 0; i < filled; i++) {
+            uint32_t v = samples[i];
+            sum += v;
+            // insertion sort; 32 entries, only run when publishing
+            uint8_t j = i;
+            for (; j > 0 && sorted[j - 1] > v; j--) sorted[j] = sorted[j - 1];
+            sorted[j] = v;
+        }
+        s.last = samples[(head + SIZE - 1) % SIZE];
+        s.min  = sorted[0];
+        s.max  = sorted[filled - 1];
+        s.mean = sum / filled;
+        s.p95  = sorted[(filled * 95 + 99) / 100 - 1];
+        return s;
+    }
+
+private:
+    uint32_t samples[SIZE];
+    uint8_t  head;
+    uint8_t  filled;
+    uint32_t total;
+    uint32_t worst;
+};
+
+#endif // LATENCY_WINDOW_HPP
@@ -10,10 +10,21 @@ struct NetworkCredentials {
     uint16_t brokerPort      = 1883;
     String   brokerUser;
     String   brokerPassword;
+    bool     brokerTls       = false;
+    String   brokerFingerprint; // SHA-1, pins the broker when no BROKER_CERT_FILE exists
+    String   deviceName;      // MQTT namespace; empty = derived from the chip ID
+    String   group;           // optional group for cmnd/group/<group>/...
+    String   powerCircuit;    // shared heater budget on power/<circuit>/...; empty = off
+    uint8_t  powerLimit      = 0; // heaters allowed on at once on that circuit
+    String   updateUrl;       // firmware manifest on a local HTTP server; empty = on command only
 
     bool isValid() const {
         return wifiSSID.length() > 0 && brokerIP.length() > 0;
     }
 };
 
+// PEM pinning the TLS broker: its own (self-signed) certificate or the CA that
+// signed it. Written by the setup portal, kept beside the credentials.
+constexpr const char* BROKER_CERT_FILE = "/broker_cert.pem";
+
 #endif // NETWORK_CREDENTIALS_HPP
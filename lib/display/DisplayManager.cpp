@@ -1,7 +1,25 @@
 #include "DisplayManager.hpp"
+#include <Log.hpp>
+
+// Trend plot: the lower six pages (y 16..63) of the 128x64 SSD1306 buffer,
+// so a one-pixel scroll is a byte move within each page row
+static constexpr uint8_t  PLOT_FIRST_PAGE = 2;
+static constexpr uint8_t  PAGES           = 8;
+static constexpr uint8_t  WIDTH           = 128;
+static constexpr uint8_t  PLOT_TOP        = PLOT_FIRST_PAGE * 8;
+static constexpr uint8_t  PLOT_BOTTOM     = 63;
+static constexpr uint8_t  TEMP_MIN        = 15;  // °C at the bottom edge
+static constexpr uint8_t  TEMP_MAX        = 85;  // °C at the top edge
+
+static uint8_t plotY(uint8_t value, uint8_t lo, uint8_t hi) {
+    if (value < lo) value = lo;
+    if (value > hi) value = hi;
+    return PLOT_BOTTOM - (uint16_t)(value - lo) * (PLOT_BOTTOM - PLOT_TOP) / (hi - lo);
+}
 
 DisplayManager::DisplayManager(uint8_t sdaPin, uint8_t sclPin)
-    : _sdaPin(sdaPin), _sclPin(sclPin), u8g2(U8G2_R0, U8X8_PIN_NONE, sclPin, sdaPin)
+    : _sdaPin(sdaPin), _sclPin(sclPin), u8g2(U8G2_R0, U8X8_PIN_NONE, sclPin, sdaPin),
+      plotted(nullptr), plottedCount(0)
 {}
 
 void DisplayManager::rewire() {
@@ -10,21 +28,21 @@ void DisplayManager::rewire() {
 }
 
 void DisplayManager::scanI2C() {
-    Serial.printf("I2C scan (SDA=GPIO%d, SCL=GPIO%d):\n", _sdaPin, _sclPin);
+    LOG_INFO("I2C | scan on SDA=GPIO%d, SCL=GPIO%d", _sdaPin, _sclPin);
     uint8_t found = 0;
     for (uint8_t addr = 1; addr < 127; addr++) {
         Wire.beginTransmission(addr);
         if (Wire.endTransmission() == 0) {
-            Serial.printf("  found device at 0x%02X\n", addr);
+            LOG_INFO("I2C | found device at 0x%02X", addr);
             found++;
         }
     }
-    if (!found) Serial.println("  no I2C devices found!");
+    if (!found) LOG_ERROR("I2C | no devices found");
 
     // explicit check for SSD1306 address
     Wire.beginTransmission(0x3C);
     uint8_t err = Wire.endTransmission();
-    Serial.printf("  0x3C probe: %s (err=%d)\n", err == 0 ? "ACK" : "NACK", err);
+    LOG_INFO("I2C | 0x3C probe: %s (err=%d)", err == 0 ? "ACK" : "NACK", err);
 }
 
 void DisplayManager::begin() {
@@ -32,23 +50,24 @@ void DisplayManager::begin() {
     delay(3000); // wait for serial monitor
     scanI2C();
     if (!u8g2.begin()) {
-        Serial.println("DISPLAY | u8g2.begin() failed");
+        LOG_ERROR("DISPLAY | u8g2.begin() failed");
     } else {
-        Serial.println("DISPLAY | u8g2.begin() OK");
+        LOG_INFO("DISPLAY | u8g2.begin() OK");
     }
     u8g2.setContrast(200);
     showMessage("Dryer Box", "Starting...");
 }
 
-void DisplayManager::drawContent(const char* state,
-                                  float       currentTemp,
-                                  uint8_t     targetTemp,
-                                  float       humidity,
-                                  uint32_t    remainingMinutes,
-                                  bool        heaterOn,
-                                  bool        fanOn,
-                                  const char* selectedPreset) {
+void DisplayManager::drawContent(const char*  state,
+                                  CentiCelsius currentTemp,
+                                  uint8_t      targetTemp,
+                                  CentiPercent humidity,
+                                  uint32_t     remainingMinutes,
+                                  bool         heaterOn,
+                                  bool         fanOn,
+                                  const char*  selectedPreset) {
     char buf[28];
+    char value[CentiCelsius::FORMAT_SIZE];
 
     u8g2.setFont(u8g2_font_7x14B_tf);
     u8g2.drawStr(0, 13, state);
@@ -60,10 +79,11 @@ void DisplayManager::drawContent(const char* state,
     u8g2.drawHLine(0, 16, 128);
 
     u8g2.setFont(u8g2_font_6x10_tf);
-    snprintf(buf, sizeof(buf), "Temp: %.1f / %d C", currentTemp, targetTemp);
+    snprintf(buf, sizeof(buf), "Temp: %s / %d C", currentTemp.format(value, sizeof(value)),
+             targetTemp);
     u8g2.drawStr(0, 28, buf);
 
-    snprintf(buf, sizeof(buf), "Humi: %.0f %%", humidity);
+    snprintf(buf, sizeof(buf), "Humi: %s %%", humidity.format(value, sizeof(value), 0));
     u8g2.drawStr(0, 40, buf);
 
     if (remainingMinutes > 0) {
@@ -83,15 +103,16 @@ void DisplayManager::drawContent(const char* state,
     u8g2.drawStr(108, 63, fanOn   ? "[F]" : " F ");
 }
 
-void DisplayManager::update(const char* state,
-                             float       currentTemp,
-                             uint8_t     targetTemp,
-                             float       humidity,
-                             uint32_t    remainingMinutes,
-                             bool        heaterOn,
-                             bool        fanOn,
-                             const char* selectedPreset) {
+void DisplayManager::update(const char*  state,
+                             CentiCelsius currentTemp,
+                             uint8_t      targetTemp,
+                             CentiPercent humidity,
+                             uint32_t     remainingMinutes,
+                             bool         heaterOn,
+                             bool         fanOn,
+                             const char*  selectedPreset) {
     rewire();
+    plotted = nullptr;
     u8g2.clearBuffer();
     drawContent(state, currentTemp, targetTemp, humidity,
                 remainingMinutes, heaterOn, fanOn, selectedPreset);
@@ -100,6 +121,7 @@ void DisplayManager::update(const char* state,
 
 void DisplayManager::showMessage(const char* line1, const char* line2) {
     rewire();
+    plotted = nullptr;
     u8g2.clearBuffer();
     u8g2.setFont(u8g2_font_7x14B_tf);
     u8g2.drawStr(0, 22, line1);
@@ -109,3 +131,79 @@ void DisplayManager::showMessage(const char* line1, const char* line2) {
     }
     u8g2.sendBuffer();
 }
+
+void DisplayManager::showTrend(const char* state, CentiCelsius currentTemp, CentiPercent humidity,
+                               const TrendHistory& history) {
+    rewire();
+    uint8_t* buf = u8g2.getBufferPtr();
+
+    uint32_t count   = history.count();
+    uint32_t visible = count < TrendHistory::COLUMNS ? count : TrendHistory::COLUMNS;
+    uint32_t added   = count - plottedCount;
+
+    if (plotted != &history || added > visible) {
+        // Full redraw: the buffer holds something else or too much scrolled by
+        u8g2.clearBuffer();
+        for (uint32_t i = count - visible; i < count; i++)
+            drawTrendColumn(WIDTH - (count - i), history, i);
+    } else if (added > 0) {
+        // Scroll the plot left by the new columns and draw only those
+        for (uint8_t page = PLOT_FIRST_PAGE; page < PAGES; page++) {
+            uint8_t* row = buf + page * WIDTH;
+            memmove(row, row + added, WIDTH - added);
+        }
+        for (uint32_t i = count - added; i < count; i++)
+            drawTrendColumn(WIDTH - (count - i), history, i);
+    }
+
+    bool plotChanged = (plotted != &history || added > 0);
+    plotted      = &history;
+    plottedCount = count;
+
+    memset(buf, 0, PLOT_FIRST_PAGE * WIDTH);
+    drawTrendHeader(state, currentTemp, humidity);
+
+    // Between samples only the two header tile rows change
+    if (plotChanged) u8g2.sendBuffer();
+    else             u8g2.updateDisplayArea(0, 0, WIDTH / 8, PLOT_FIRST_PAGE);
+}
+
+void DisplayManager::drawTrendHeader(const char* state, CentiCelsius currentTemp,
+                                     CentiPercent humidity) {
+    char buf[20];
+    char temperature[CentiCelsius::FORMAT_SIZE], rh[CentiPercent::FORMAT_SIZE];
+    u8g2.setFont(u8g2_font_7x14B_tf);
+    u8g2.drawStr(0, 13, state);
+
+    u8g2.setFont(u8g2_font_6x10_tf);
+    snprintf(buf, sizeof(buf), "%sC %s%%", currentTemp.format(temperature, sizeof(temperature), 0),
+             humidity.format(rh, sizeof(rh), 0));
+    u8g2.drawStr(128 - u8g2.getStrWidth(buf), 13, buf);
+}
+
+void DisplayManager::drawTrendColumn(uint8_t x, const TrendHistory& history, uint32_t index) {
+    uint8_t* buf = u8g2.getBufferPtr();
+    for (uint8_t page = PLOT_FIRST_PAGE; page < PAGES; page++) buf[page * WIDTH + x] = 0;
+
+    const TrendHistory::Sample& s = history.at(index);
+    if (s.target && index % 4 == 0) u8g2.drawPixel(x, plotY(s.target, TEMP_MIN, TEMP_MAX));
+    if (index % 2 == 0)             u8g2.drawPixel(x, plotY(s.humidity, 0, 100));
+
+    // Temperature as a connected line: span from the previous sample's height
+    uint8_t y    = plotY(s.temperature, TEMP_MIN, TEMP_MAX);
+    uint8_t from = y;
+    if (index > 0 && history.count() - (index - 1) <= TrendHistory::COLUMNS)
+        from = plotY(history.at(index - 1).temperature, TEMP_MIN, TEMP_MAX);
+    if (from < y) u8g2.drawVLine(x, from + 1, y - from);
+    else          u8g2.drawVLine(x, y, from - y + 1);
+}
+
+void DisplayManager::setPowerSave(bool on) {
+    rewire();
+    u8g2.setPowerSave(on ? 1 : 0);
+}
+
+void DisplayManager::setContrast(uint8_t value) {
+    rewire();
+    u8g2.setContrast(value);
+}
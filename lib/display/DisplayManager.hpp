@@ -4,6 +4,8 @@
 #include <Arduino.h>
 #include <U8g2lib.h>
 #include <Wire.h>
+#include <Fixed.hpp>
+#include "TrendHistory.hpp"
 
 class DisplayManager {
 public:
@@ -11,27 +13,44 @@ public:
 
     void begin();
 
-    void update(const char* state,
-                float       currentTemp,
-                uint8_t     targetTemp,
-                float       humidity,
-                uint32_t    remainingMinutes,
-                bool        heaterOn,
-                bool        fanOn,
-                const char* selectedPreset = nullptr);
+    void update(const char*  state,
+                CentiCelsius currentTemp,
+                uint8_t      targetTemp,
+                CentiPercent humidity,
+                uint32_t     remainingMinutes,
+                bool         heaterOn,
+                bool         fanOn,
+                const char*  selectedPreset = nullptr);
+
+    // Trend page: header with the current values, below it a scrolling plot
+    // of history (temperature solid, humidity dotted, target as a dashed line).
+    // Consecutive calls for the same history only shift the plot by the new
+    // columns and send the header tiles when nothing was added.
+    void showTrend(const char* state, CentiCelsius currentTemp, CentiPercent humidity,
+                   const TrendHistory& history);
 
     // Show a full-screen message (AP mode, WiFi connecting, etc.)
     void showMessage(const char* line1, const char* line2 = nullptr);
 
+    // Panel off (RAM kept) / brightness, for idle power saving
+    void setPowerSave(bool on);
+    void setContrast(uint8_t value);
+
 private:
     uint8_t _sdaPin;
     uint8_t _sclPin;
     U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2;
 
+    // What the plot area of the frame buffer currently holds
+    const TrendHistory* plotted;
+    uint32_t            plottedCount;
+
     void rewire();
+    void drawTrendHeader(const char* state, CentiCelsius currentTemp, CentiPercent humidity);
+    void drawTrendColumn(uint8_t x, const TrendHistory& history, uint32_t index);
     void scanI2C();
-    void drawContent(const char* state, float currentTemp, uint8_t targetTemp,
-                     float humidity, uint32_t remainingMinutes,
+    void drawContent(const char* state, CentiCelsius currentTemp, uint8_t targetTemp,
+                     CentiPercent humidity, uint32_t remainingMinutes,
                      bool heaterOn, bool fanOn, const char* selectedPreset);
 };
 
@@ -0,0 +1,62 @@
+#ifndef TREND_HISTORY_HPP
+#define TREND_HISTORY_HPP
+
+#include <Arduino.h>
+#include <Fixed.hpp>
+
+// Recent temperature/humidity of one zone for the OLED trend page: one
+// column per SAMPLE_MS (averaged from the per-second readings), the last
+// COLUMNS of them kept. 128 x 30 s covers the last 64 minutes.
+class TrendHistory {
+public:
+    static constexpr uint8_t  COLUMNS   = 128;
+    static constexpr uint32_t SAMPLE_MS = 30000;
+
+    struct Sample {
+        uint8_t temperature; // °C
+        uint8_t humidity;    // %RH
+        uint8_t target;      // °C, 0 when not drying
+    };
+
+    TrendHistory() : total(0), sumTemp(0), sumHum(0), sumCount(0), sampleStart(0) {}
+
+    // Once per control tick
+    void add(CentiCelsius temperature, CentiPercent humidity, uint8_t target) {
+        uint32_t now = millis();
+        if (sumCount == 0) sampleStart = now;
+        sumTemp += temperature.centi();
+        sumHum  += humidity.centi();
+        sumCount++;
+        lastTarget = target;
+
+        if (now - sampleStart >= SAMPLE_MS) {
+            Sample& s     = samples[total % COLUMNS];
+            s.temperature = clamp(sumTemp / sumCount);
+            s.humidity    = clamp(sumHum / sumCount);
+            s.target      = lastTarget;
+            total++;
+            sumTemp = sumHum = 0;
+            sumCount = 0;
+        }
+    }
+
+    // Samples committed since boot; at(i) is valid for the last COLUMNS of them
+    uint32_t      count() const            { return total; }
+    const Sample& at(uint32_t index) const { return samples[index % COLUMNS]; }
+
+private:
+    Sample   samples[COLUMNS];
+    uint32_t total;
+    int32_t  sumTemp; // hundredths
+    int32_t  sumHum;
+    uint16_t sumCount;
+    uint32_t sampleStart;
+    uint8_t  lastTarget = 0;
+
+    // Mean in hundredths to whole units
+    static uint8_t clamp(int32_t centi) {
+        return centi < 0 ? 0 : centi > 25500 ? 255 : (uint8_t)((centi + 50) / 100);
+    }
+};
+
+#endif // TREND_HISTORY_HPP
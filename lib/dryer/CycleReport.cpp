@@ -0,0 +1,74 @@
+#include "CycleReport.hpp"
+
+void CycleRecorder::start(uint32_t now, uint8_t preset, uint8_t targetC, uint32_t targetMs,
+                          bool heaterOn, bool fanOn, CentiPercent humidity) {
+    report = CycleReport();
+    report.preset            = preset;
+    report.targetC           = targetC;
+    report.targetMs          = targetMs;
+    report.humidityStartDeci = humidity.deci();
+    report.humidityEndDeci   = report.humidityStartDeci;
+    report.humidityMinDeci   = report.humidityStartDeci;
+    report.heaterCycles      = heaterOn;
+    report.fanCycles         = fanOn;
+
+    running     = true;
+    startMs     = now;
+    lastMs      = now;
+    lastHolding = false;
+    lastHeater  = heaterOn;
+    lastFan     = fanOn;
+}
+
+// Time since the last call, credited to what was true during it
+void CycleRecorder::accumulate(uint32_t now) {
+    uint32_t dt = now - lastMs;
+    lastMs = now;
+    if (lastHeater)  report.heaterOnMs += dt;
+    if (lastHolding) {
+        report.holdingMs += dt;
+        if (lastHeater) report.holdingHeaterMs += dt;
+    }
+}
+
+void CycleRecorder::tick(uint32_t now, bool drying, bool heaterOn, bool fanOn,
+                         CentiCelsius temperature, CentiPercent humidity) {
+    if (!running) return;
+    accumulate(now);
+
+    if (heaterOn && !lastHeater) report.heaterCycles++;
+    if (fanOn && !lastFan)       report.fanCycles++;
+    lastHeater  = heaterOn;
+    lastFan     = fanOn;
+    lastHolding = drying && report.reached;
+
+    if (report.reached) {
+        int16_t over = temperature.deci() - report.targetC * 10;
+        if (over > report.overshootDeciC) report.overshootDeciC = over;
+    }
+    int16_t rh = humidity.deci();
+    report.humidityEndDeci = rh;
+    if (rh < report.humidityMinDeci) report.humidityMinDeci = rh;
+}
+
+void CycleRecorder::enteredHolding(uint32_t now) {
+    if (!running || report.reached) return;
+    report.reached        = true;
+    report.timeToTargetMs = now - startMs;
+}
+
+void CycleRecorder::end(uint32_t now, uint8_t rule) {
+    if (!running) return;
+    accumulate(now);
+    report.endRule    = rule;
+    report.durationMs = now - startMs;
+    running  = false;
+    finished = true;
+}
+
+bool CycleRecorder::take(CycleReport& out) {
+    if (!finished) return false;
+    out      = report;
+    finished = false;
+    return true;
+}
@@ -0,0 +1,72 @@
+#ifndef CYCLE_REPORT_HPP
+#define CYCLE_REPORT_HPP
+
+#include <Arduino.h>
+#include <Fixed.hpp>
+
+// How one drying cycle went, from its START transition until the controller
+// is back in IDLE (or MANUAL, or another START replaces it). Temperatures
+// and humidities in tenths, like TransitionRecord.
+struct CycleReport {
+    uint8_t  preset;          // filamentSettings index, DryerController::NO_PRESET if custom
+    uint8_t  targetC;
+    bool     resumed;         // picked up from a checkpoint after a reset
+    bool     reached;         // target temperature reached at some point
+    uint8_t  endRule;         // transition table row that ended it
+    uint32_t targetMs;        // drying time asked for
+    uint32_t durationMs;      // start to end, cooling included
+    uint32_t timeToTargetMs;  // start to first HOLDING, if reached
+    int16_t  overshootDeciC;  // peak above target once reached
+    uint32_t holdingMs;       // HEATING/HOLDING after the target was reached
+    uint32_t holdingHeaterMs; // heater on during holdingMs
+    uint32_t heaterOnMs;      // whole cycle
+    uint16_t heaterCycles;    // relay on-phases
+    uint16_t fanCycles;
+    int16_t  humidityStartDeci;
+    int16_t  humidityEndDeci;
+    int16_t  humidityMinDeci;
+    uint8_t  safetyTrips;     // entries into SAFETY
+
+    // Heater on-time × nominal power in 0.1 Wh; a PTC draws less once hot, so an upper bound
+    uint32_t energyDeciWh(uint16_t heaterW) const {
+        return ((uint64_t)heaterOnMs * heaterW + 180000) / 360000;
+    }
+    uint8_t holdingDutyPct() const {
+        return holdingMs ? (uint8_t)((uint64_t)holdingHeaterMs * 100 / holdingMs) : 0;
+    }
+};
+
+// Accumulates a CycleReport tick by tick, keeping no samples. Driven by
+// DryerController: start()/end() from its transitions, tick() once per update.
+class CycleRecorder {
+public:
+    CycleRecorder() : running(false), finished(false) {}
+
+    void start(uint32_t now, uint8_t preset, uint8_t targetC, uint32_t targetMs,
+               bool heaterOn, bool fanOn, CentiPercent humidity);
+    void tick(uint32_t now, bool drying, bool heaterOn, bool fanOn,
+              CentiCelsius temperature, CentiPercent humidity);
+    void enteredHolding(uint32_t now);
+    void enteredSafety() { if (running) report.safetyTrips++; }
+    void markResumed()   { if (running) report.resumed = true; }
+    void end(uint32_t now, uint8_t rule);
+
+    bool isRunning() const { return running; }
+
+    // The last finished cycle, once
+    bool take(CycleReport& out);
+
+private:
+    CycleReport report;
+    bool        running;
+    bool        finished;
+    uint32_t    startMs;
+    uint32_t    lastMs;
+    bool        lastHolding;
+    bool        lastHeater;
+    bool        lastFan;
+
+    void accumulate(uint32_t now);
+};
+
+#endif // CYCLE_REPORT_HPP
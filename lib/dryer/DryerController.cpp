@@ -1,9 +1,148 @@
 #include "DryerController.hpp"
+#include <Pins.hpp>
+#include <Log.hpp>
+
+constexpr uint8_t DryerController::NO_PRESET;
+
+// Board profile limits, folded in at compile time
+constexpr CentiCelsius CUTOFF_C  = CentiCelsius::fromWhole(BOARD.limits.cutoffC);
+constexpr CentiCelsius RELEASE_C = CentiCelsius::fromWhole(BOARD.limits.releaseC);
+constexpr CentiCelsius COOLED_C  = CentiCelsius::fromWhole(BOARD.limits.cooledC);
+
+typedef bool (*Guard)(const DryerController&);
+typedef void (*Action)(DryerController&);
+
+struct Transition {
+    uint8_t     from;    // bit mask of source states
+    DryerEvent  event;
+    Guard       guard;   // nullptr = always
+    DryerState  to;
+    Action      action;  // nullptr = outputs unchanged
+    const char* name;
+};
+
+constexpr uint8_t bit(DryerState s) { return 1u << static_cast<uint8_t>(s); }
+constexpr uint8_t ANY_STATE = (1u << static_cast<uint8_t>(DryerState::COUNT)) - 1;
+
+// Guards and actions reach into the controller, hence a friend
+struct DryerRules {
+    static bool overTemp(const DryerController& c)     { return c.sensor.getTemperature() >= CUTOFF_C; }
+    static bool timerElapsed(const DryerController& c) { return c.heater.computeRemainingTime() == 0; }
+    static bool atTarget(const DryerController& c) {
+        return c.sensor.getTemperature() >= CentiCelsius::fromWhole(c.heater.getTargetTemperature());
+    }
+    static bool belowTarget(const DryerController& c)  { return !atTarget(c); }
+    static bool cooled(const DryerController& c)       { return c.sensor.getTemperature() < COOLED_C; }
+    // hysteresis, and never while the supervisor still holds a trip
+    static bool released(const DryerController& c)     { return c.sensor.getTemperature() < RELEASE_C && !c.safetyHold; }
+    static bool releasedMidCycle(const DryerController& c) {
+        return released(c) && c.heater.getTargetTemperature() > 0 && c.heater.computeRemainingTime() > 0;
+    }
+
+    static void heaterOn(DryerController& c)  { c.setHeater(true); }
+    static void heaterOff(DryerController& c) { c.setHeater(false); }
+    static void fanOn(DryerController& c)     { c.fanRelay.turnOn(); }
+    static void fanOff(DryerController& c)    { c.fanRelay.turnOff(); }
+    static void ventOnly(DryerController& c)  { c.setHeater(false); c.fanRelay.turnOn(); }
+    static void heatAndVent(DryerController& c) { c.fanRelay.turnOn(); c.setHeater(true); }
+    static void stop(DryerController& c)      { c.clearCycle(); ventOnly(c); }
+    static void abort(DryerController& c)     { c.clearCycle(); c.setHeater(false); c.fanRelay.turnOff(); }
+};
+
+using St    = DryerState;
+using Ev    = DryerEvent;
+using Rules = DryerRules;
+
+// Order matters: the first matching row wins
+constexpr Transition TABLE[] = {
+    // from                         event             guard                      to            action                name
+    {ANY_STATE & ~bit(St::SAFETY),  Ev::TICK,         &Rules::overTemp,          St::SAFETY,   &Rules::ventOnly,     "over_temp"},
+    {ANY_STATE & ~bit(St::SAFETY),  Ev::SAFETY_TRIP,  nullptr,                   St::SAFETY,   &Rules::ventOnly,     "supervisor_trip"},
+
+    {bit(St::HEATING),              Ev::TICK,         &Rules::timerElapsed,      St::COOLING,  &Rules::heaterOff,    "timer_elapsed"},
+    {bit(St::HEATING),              Ev::TICK,         &Rules::atTarget,          St::HOLDING,  &Rules::heaterOff,    "target_reached"},
+    {bit(St::HOLDING),              Ev::TICK,         &Rules::timerElapsed,      St::COOLING,  &Rules::heaterOff,    "timer_elapsed"},
+    {bit(St::HOLDING),              Ev::TICK,         &Rules::belowTarget,       St::HEATING,  &Rules::heaterOn,     "below_target"},
+    {bit(St::COOLING),              Ev::TICK,         &Rules::cooled,            St::IDLE,     &Rules::fanOff,       "cooled"},
+    {bit(St::SAFETY),               Ev::TICK,         &Rules::releasedMidCycle,  St::COOLING,  nullptr,              "safe_cool_down"},
+    {bit(St::SAFETY),               Ev::TICK,         &Rules::released,          St::IDLE,     &Rules::fanOff,       "safe_no_target"},
+
+    {ANY_STATE,                     Ev::START,        &Rules::atTarget,          St::HOLDING,  &Rules::ventOnly,     "start_at_target"},
+    {ANY_STATE,                     Ev::START,        nullptr,                   St::HEATING,  &Rules::heatAndVent,  "start"},
+    {ANY_STATE,                     Ev::STOP,         nullptr,                   St::COOLING,  &Rules::stop,         "stop"},
+    {ANY_STATE,                     Ev::ABORT,        nullptr,                   St::IDLE,     &Rules::abort,        "abort"},
+    {ANY_STATE,                     Ev::HEATER_ON,    nullptr,                   St::MANUAL,   &Rules::heatAndVent,  "manual_heater_on"},
+    {ANY_STATE,                     Ev::HEATER_OFF,   nullptr,                   St::MANUAL,   &Rules::heaterOff,    "manual_heater_off"},
+    {ANY_STATE,                     Ev::FAN_ON,       nullptr,                   St::MANUAL,   &Rules::fanOn,        "manual_fan_on"},
+    {ANY_STATE,                     Ev::FAN_OFF,      nullptr,                   St::MANUAL,   &Rules::fanOff,       "manual_fan_off"},
+};
+
+constexpr uint8_t RULES = sizeof(TABLE) / sizeof(TABLE[0]);
+constexpr uint8_t STATES = static_cast<uint8_t>(DryerState::COUNT);
+
+// ---- compile-time checks on the table ----
+
+constexpr bool rowsWellFormed() {
+    for (uint8_t i = 0; i < RULES; i++) {
+        if (TABLE[i].from == 0 || (TABLE[i].from & ~ANY_STATE)) return false;
+        if (TABLE[i].to >= DryerState::COUNT || TABLE[i].event >= DryerEvent::COUNT) return false;
+    }
+    return true;
+}
+
+// The first TICK row of every state except SAFETY is the over-temperature cutoff
+constexpr bool overTempComesFirst() {
+    for (uint8_t s = 0; s < STATES; s++) {
+        if (s == static_cast<uint8_t>(St::SAFETY)) continue;
+        for (uint8_t i = 0; i < RULES; i++) {
+            if (TABLE[i].event != Ev::TICK || !(TABLE[i].from & (1u << s))) continue;
+            if (TABLE[i].guard != &Rules::overTemp || TABLE[i].to != St::SAFETY) return false;
+            break;
+        }
+    }
+    return true;
+}
+
+// An unguarded row ends the search for its states: a later row for the same
+// event and only those states could never fire
+constexpr bool noDeadRows() {
+    for (uint8_t i = 0; i < RULES; i++) {
+        uint8_t shadowed = 0;
+        for (uint8_t j = 0; j < i; j++)
+            if (!TABLE[j].guard && TABLE[j].event == TABLE[i].event) shadowed |= TABLE[j].from;
+        if ((TABLE[i].from & ~shadowed) == 0) return false;
+    }
+    return true;
+}
+
+// Every state can be reached from IDLE, and left again
+constexpr bool noOrphanOrTrapStates() {
+    uint8_t reached = bit(St::IDLE);
+    for (uint8_t pass = 0; pass < STATES; pass++)
+        for (uint8_t i = 0; i < RULES; i++)
+            if (TABLE[i].from & reached) reached |= bit(TABLE[i].to);
+    if (reached != ANY_STATE) return false;
+
+    for (uint8_t s = 0; s < STATES; s++) {
+        bool leaves = false;
+        for (uint8_t i = 0; i < RULES; i++)
+            if ((TABLE[i].from & (1u << s)) && static_cast<uint8_t>(TABLE[i].to) != s) leaves = true;
+        if (!leaves) return false;
+    }
+    return true;
+}
+
+static_assert(STATES <= 8 && RULES < 256, "TransitionRecord packs states in 4 bits, rules in 8");
+static_assert(rowsWellFormed(), "transition table: bad source mask, target or event");
+static_assert(overTempComesFirst(), "transition table: over-temperature must be the first TICK rule of every state");
+static_assert(noDeadRows(), "transition table: row shadowed by an earlier unguarded row");
+static_assert(noOrphanOrTrapStates(), "transition table: state unreachable from IDLE or impossible to leave");
 
 DryerController::DryerController(HeaterSettings& heater, Relais& heaterRelay,
                                  NcRelay& fanRelay, TempHumidity& sensor)
     : heater(heater), heaterRelay(heaterRelay), fanRelay(fanRelay),
-      sensor(sensor), state(DryerState::IDLE)
+      sensor(sensor), state(DryerState::IDLE), activePreset(NO_PRESET),
+      gate(nullptr), heaterWanted(false), warmingUp(false), safetyHold(false)
 {
     // The NC relay is de-energized by default (GPIO LOW = fan ON).
     // Explicitly shut both outputs off so IDLE starts clean.
@@ -11,123 +150,132 @@ DryerController::DryerController(HeaterSettings& heater, Relais& heaterRelay,
     fanRelay.turnOff();
 }
 
-void DryerController::transitionTo(DryerState next, const char* reason) {
-    Serial.print("STATE ");
-    Serial.print(getStateName());
-    Serial.print(" -> ");
-    state = next;
-    Serial.print(getStateName());
-    Serial.print(" (");
-    Serial.print(reason);
-    Serial.println(")");
+bool DryerController::fire(DryerEvent event) {
+    for (uint8_t i = 0; i < RULES; i++) {
+        const Transition& t = TABLE[i];
+        if (t.event != event || !(t.from & bit(state))) continue;
+        if (t.guard && !t.guard(*this)) continue;
+
+        if (t.action) t.action(*this);
+        TransitionRecord record;
+        record.atMs   = millis();
+        record.deciC  = sensor.getTemperature().deci();
+        record.rule   = i;
+        record.states = static_cast<uint8_t>(state) << 4 | static_cast<uint8_t>(t.to);
+        history.add(record);
+        LOG_INFO("STATE | %s -> %s (%s)", stateName(state), stateName(t.to), t.name);
+        state = t.to;
+        trackCycle(event, i);
+        return true;
+    }
+    return false;
 }
 
 void DryerController::update() {
-    float temp = sensor.getTemperature();
-
-    // Safety always overrides every other state
-    if (temp >= 80 && state != DryerState::SAFETY) {
-        heaterRelay.turnOff();
-        fanRelay.turnOn();
-        transitionTo(DryerState::SAFETY, "temp >= 80C");
-        return;
-    }
+    fire(DryerEvent::TICK);
 
-    switch (state) {
-        case DryerState::IDLE:
-            break;
+    // Re-evaluate every tick so a gate can grant or revoke heat in any state;
+    // time spent waiting for it does not count as drying
+    setHeater(heaterWanted);
+    heater.setPaused(isHeaterBlocked());
 
-        case DryerState::HEATING:
-            if (heater.computeRemainingTime() == 0) {
-                heaterRelay.turnOff();
-                transitionTo(DryerState::COOLING, "timer elapsed");
-            } else if (temp >= heater.getTargetTemperature()) {
-                heaterRelay.turnOff();
-                transitionTo(DryerState::HOLDING, "target reached");
-            }
-            break;
+    bool drying = state == DryerState::HEATING || state == DryerState::HOLDING;
+    cycle.tick(millis(), drying, heaterRelay.getState(),
+               fanRelay.getState(), sensor.getTemperature(), sensor.getHumidity());
+}
+
+// A cycle runs from a START until IDLE or MANUAL; a new START replaces it
+void DryerController::trackCycle(DryerEvent event, uint8_t rule) {
+    uint32_t now = millis();
+    if (event == DryerEvent::START || state == DryerState::IDLE || state == DryerState::MANUAL)
+        cycle.end(now, rule);
+    if (event == DryerEvent::START)
+        cycle.start(now, activePreset, heater.getTargetTemperature(), heater.getTargetTime(),
+                    heaterRelay.getState(), fanRelay.getState(), sensor.getHumidity());
+    if (event == DryerEvent::START)   warmingUp = true;
+    if (state != DryerState::HEATING) warmingUp = false;
+    if (state == DryerState::HOLDING) cycle.enteredHolding(now);
+    if (state == DryerState::SAFETY)  cycle.enteredSafety();
+}
+
+void DryerController::applyFilamentPreset(uint8_t targetTemp, unsigned long targetTime,
+                                          uint8_t presetIndex) {
+    heater.setTargetTemperature(targetTemp);
+    heater.setTargetTime(targetTime);
+    activePreset = presetIndex;
+    fire(DryerEvent::START);
+}
+
+void DryerController::reset() {
+    fire(DryerEvent::STOP);
+}
 
+void DryerController::abort() {
+    fire(DryerEvent::ABORT);
+}
+
+void DryerController::setManualHeater(bool on) {
+    fire(on ? DryerEvent::HEATER_ON : DryerEvent::HEATER_OFF);
+}
+
+void DryerController::setManualFan(bool on) {
+    fire(on ? DryerEvent::FAN_ON : DryerEvent::FAN_OFF);
+}
+
+void DryerController::setSafetyHold(bool hold) {
+    safetyHold = hold;
+    if (hold) fire(DryerEvent::SAFETY_TRIP); // no-op while already in SAFETY
+}
+
+void DryerController::resumeCycle(DryerState saved, uint8_t presetIndex, uint8_t targetTemp,
+                                  unsigned long targetTime, unsigned long elapsed) {
+    switch (saved) {
+        case DryerState::HEATING:
         case DryerState::HOLDING:
-            if (heater.computeRemainingTime() == 0) {
-                heaterRelay.turnOff();
-                transitionTo(DryerState::COOLING, "timer elapsed");
-            } else if (temp < heater.getTargetTemperature()) {
-                heaterRelay.turnOn();
-                transitionTo(DryerState::HEATING, "temp dropped below target");
+            if (elapsed >= targetTime) {
+                reset();
+                return;
             }
+            heater.resume(targetTemp, targetTime, elapsed);
+            activePreset = presetIndex;
+            fire(DryerEvent::START);
+            cycle.markResumed();
             break;
 
         case DryerState::COOLING:
-            if (temp < 30) {
-                fanRelay.turnOff();
-                transitionTo(DryerState::IDLE, "cooled down");
-            }
-            break;
-
-        case DryerState::MANUAL:
-            break; // relay states driven entirely by MQTT commands
-
         case DryerState::SAFETY:
-            if (temp < 75) { // 5 °C hysteresis before re-engaging
-                if (heater.getTargetTemperature() > 0 && heater.computeRemainingTime() > 0) {
-                    transitionTo(DryerState::COOLING, "temp safe, letting cool");
-                } else {
-                    fanRelay.turnOff();
-                    transitionTo(DryerState::IDLE, "temp safe, no active target");
-                }
-            }
+            reset(); // fan keeps running until the chamber has cooled
             break;
-    }
-}
 
-void DryerController::applyFilamentPreset(uint8_t targetTemp, unsigned long targetTime) {
-    heater.setTargetTemperature(targetTemp);
-    heater.setTargetTime(targetTime);
-    fanRelay.turnOn();
-    enterHeatingOrHolding();
+        default:
+            break;   // IDLE / MANUAL: nothing to resume
+    }
 }
 
-void DryerController::reset() {
+void DryerController::clearCycle() {
+    activePreset = NO_PRESET;
     heater.setTargetTemperature(0);
     heater.setTargetTime(0);
-    heaterRelay.turnOff();
-    fanRelay.turnOn();
-    transitionTo(DryerState::COOLING, "stop");
 }
 
-void DryerController::abort() {
-    heater.setTargetTemperature(0);
-    heater.setTargetTime(0);
-    heaterRelay.turnOff();
-    fanRelay.turnOff();
-    transitionTo(DryerState::IDLE, "abort");
+void DryerController::setHeater(bool on) {
+    heaterWanted = on;
+    bool allowed = !safetyHold && (!gate || gate->mayEnergise(on, warmingUp));
+    if (on && allowed) heaterRelay.turnOn();
+    else               heaterRelay.turnOff();
 }
 
-void DryerController::setManualHeater(bool on) {
-    if (on) { heaterRelay.turnOn(); fanRelay.turnOn(); }
-    else      heaterRelay.turnOff();
-    transitionTo(DryerState::MANUAL, on ? "heater ON" : "heater OFF");
+uint8_t DryerController::ruleCount() {
+    return RULES;
 }
 
-void DryerController::setManualFan(bool on) {
-    if (on) fanRelay.turnOn();
-    else    fanRelay.turnOff();
-    transitionTo(DryerState::MANUAL, on ? "fan ON" : "fan OFF");
-}
-
-void DryerController::enterHeatingOrHolding() {
-    float temp = sensor.getTemperature();
-    if (temp >= heater.getTargetTemperature()) {
-        heaterRelay.turnOff();
-        transitionTo(DryerState::HOLDING, "already at target");
-    } else {
-        heaterRelay.turnOn();
-        transitionTo(DryerState::HEATING, "below target");
-    }
+DryerController::RuleInfo DryerController::rule(uint8_t index) {
+    const Transition& t = TABLE[index < RULES ? index : 0];
+    return {t.from, t.event, t.to, t.name};
 }
 
-const char* DryerController::getStateName() const {
-    switch (state) {
+const char* DryerController::stateName(DryerState s) {
+    switch (s) {
         case DryerState::IDLE:    return "IDLE";
         case DryerState::HEATING: return "HEATING";
         case DryerState::HOLDING: return "HOLDING";
@@ -137,3 +285,18 @@ const char* DryerController::getStateName() const {
         default:                  return "UNKNOWN";
     }
 }
+
+const char* DryerController::eventName(DryerEvent e) {
+    switch (e) {
+        case DryerEvent::TICK:        return "tick";
+        case DryerEvent::START:       return "start";
+        case DryerEvent::STOP:        return "stop";
+        case DryerEvent::ABORT:       return "abort";
+        case DryerEvent::HEATER_ON:   return "heater_on";
+        case DryerEvent::HEATER_OFF:  return "heater_off";
+        case DryerEvent::FAN_ON:      return "fan_on";
+        case DryerEvent::FAN_OFF:     return "fan_off";
+        case DryerEvent::SAFETY_TRIP: return "safety_trip";
+        default:                      return "unknown";
+    }
+}
@@ -6,16 +6,37 @@
 #include <NcRelay.hpp>
 #include <TempHumidity.hpp>
 #include "HeaterSettings.hpp"
+#include "HeaterGate.hpp"
+#include "TransitionHistory.hpp"
+#include "CycleReport.hpp"
 
-enum class DryerState {
+enum class DryerState : uint8_t {
     IDLE,     // no active drying cycle, all outputs off
     HEATING,  // temperature below target, heater on
     HOLDING,  // temperature at target, heater cycling off
     COOLING,  // cycle complete or reset, fan running until cool
     MANUAL,   // relay states controlled directly via MQTT
-    SAFETY    // over-temperature cutoff (>= 80 °C)
+    SAFETY,   // over-temperature cutoff (BOARD.limits.cutoffC)
+    COUNT
 };
 
+enum class DryerEvent : uint8_t {
+    TICK,         // periodic look at sensor and timer (update())
+    START,        // preset applied or cycle resumed
+    STOP,
+    ABORT,
+    HEATER_ON,    // manual overrides
+    HEATER_OFF,
+    FAN_ON,
+    FAN_OFF,
+    SAFETY_TRIP,  // independent safety supervisor
+    COUNT
+};
+
+// The state machine is the constexpr transition table in DryerController.cpp:
+// for an event, the first row whose source states match and whose guard
+// passes runs its action and moves to its target state. Every transition is
+// recorded in a TransitionHistory instead of being printed.
 class DryerController {
 public:
     DryerController(HeaterSettings& heater, Relais& heaterRelay,
@@ -25,24 +46,73 @@ public:
     void update();
 
     // MQTT-triggered transitions
-    void applyFilamentPreset(uint8_t targetTemp, unsigned long targetTime);
-    void reset();   // graceful: heater off, fan runs until <30 °C → IDLE
+    void applyFilamentPreset(uint8_t targetTemp, unsigned long targetTime,
+                             uint8_t presetIndex = NO_PRESET);
+    void reset();   // graceful: heater off, fan runs until cooled → IDLE
     void abort();   // immediate: everything off → IDLE right now
     void setManualHeater(bool on);
     void setManualFan(bool on);
 
-    DryerState  getState()     const { return state; }
-    const char* getStateName() const;
+    // Re-enter a cycle interrupted by a reset or power loss. Only drying
+    // and cooling phases are resumed; MANUAL never re-energises anything.
+    void resumeCycle(DryerState saved, uint8_t presetIndex, uint8_t targetTemp,
+                     unsigned long targetTime, unsigned long elapsed);
+
+    // Optional veto over the heater relay (shared power budget); nullptr = none.
+    // Applies to manual heater commands as well.
+    void setHeaterGate(HeaterGate* g) { gate = g; }
+
+    // Trip raised by the independent safety supervisor: enters SAFETY and
+    // stays there, with the heater refused, until the hold is lifted
+    void setSafetyHold(bool hold);
+
+    // Heater demanded by the state machine but held off by the gate. The
+    // drying timer is paused meanwhile.
+    bool isHeaterBlocked() const { return heaterWanted && !heaterRelay.getState(); }
+
+    DryerState  getState()        const { return state; }
+    const char* getStateName()    const { return stateName(state); }
+    uint8_t     getActivePreset() const { return activePreset; } // index into filamentSettings
+
+    const TransitionHistory& getHistory() const { return history; }
+
+    // KPIs of the last cycle that ended, handed out once
+    bool takeCycleReport(CycleReport& out) { return cycle.take(out); }
+
+    // The transition table, for history decoding and diagram generation
+    struct RuleInfo {
+        uint8_t     fromMask;  // bit n = DryerState n
+        DryerEvent  event;
+        DryerState  to;
+        const char* name;      // why the transition happens, e.g. "target_reached"
+    };
+    static uint8_t     ruleCount();
+    static RuleInfo    rule(uint8_t index);
+    static const char* stateName(DryerState s);
+    static const char* eventName(DryerEvent e);
+
+    static constexpr uint8_t NO_PRESET = 0xFF;
 
 private:
-    HeaterSettings& heater;
-    Relais&         heaterRelay;
-    NcRelay&        fanRelay;
-    TempHumidity&   sensor;
-    DryerState      state;
-
-    void enterHeatingOrHolding();
-    void transitionTo(DryerState next, const char* reason);
+    friend struct DryerRules;
+
+    HeaterSettings&   heater;
+    Relais&           heaterRelay;
+    NcRelay&          fanRelay;
+    TempHumidity&     sensor;
+    DryerState        state;
+    uint8_t           activePreset;
+    HeaterGate*       gate;
+    bool              heaterWanted;
+    bool              warmingUp;     // HEATING, target not reached yet this cycle
+    bool              safetyHold;
+    TransitionHistory history;
+    CycleRecorder     cycle;
+
+    bool fire(DryerEvent event);
+    void trackCycle(DryerEvent event, uint8_t rule);
+    void setHeater(bool on);
+    void clearCycle();
 };
 
 #endif // DRYER_CONTROLLER_HPP
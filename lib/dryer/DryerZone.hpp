@@ -0,0 +1,28 @@
+#ifndef DRYER_ZONE_HPP
+#define DRYER_ZONE_HPP
+
+#include <Relais.hpp>
+#include <NcRelay.hpp>
+#include <TempHumidity.hpp>
+#include <Pins.hpp>
+#include "HeaterSettings.hpp"
+#include "DryerController.hpp"
+
+// One chamber: its own sensor, heater/fan relays and state machine.
+// Zones are allocated statically in main; member order matters because the
+// controller binds to the members declared before it.
+struct DryerZone {
+    DryerZone(const ZonePins& pins)
+        : sensor(pins.dht, BOARD.sensorType), heater(sensor),
+          heaterRelay(pins.heater, "Heater"), fanRelay(pins.fan, "Fan"),
+          controller(heater, heaterRelay, fanRelay, sensor)
+    {}
+
+    TempHumidity    sensor;
+    HeaterSettings  heater;
+    Relais          heaterRelay;
+    NcRelay         fanRelay;
+    DryerController controller;
+};
+
+#endif // DRYER_ZONE_HPP
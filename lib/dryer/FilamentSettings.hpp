@@ -17,7 +17,7 @@
  */
 struct FilamentSetting
 {
-    String material;     ///< The name of the filament material.
+    const char* material; ///< The name of the filament material.
     uint8_t temperature; ///< The recommended drying temperature for the filament in degrees Celsius.
     unsigned long time;  ///< The recommended drying time for the filament in milliseconds.
 };
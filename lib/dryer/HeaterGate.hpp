@@ -0,0 +1,17 @@
+#ifndef HEATER_GATE_HPP
+#define HEATER_GATE_HPP
+
+// Lets something outside the controller veto the heater, e.g. a power
+// budget shared between several dryers on one circuit.
+class HeaterGate {
+public:
+    virtual ~HeaterGate() {}
+
+    // Called on every heater decision and at least once per control tick with
+    // whether the controller wants heat, and whether the cycle is still
+    // warming up to its target (heat granted then should not be taken away).
+    // Returns whether it may be energised.
+    virtual bool mayEnergise(bool demand, bool warmingUp) = 0;
+};
+
+#endif // HEATER_GATE_HPP
@@ -1,6 +1,6 @@
 #include "HeaterSettings.hpp"
 
-HeaterSettings::HeaterSettings(TempHumidity& tempHumidity) : tempHumidity(tempHumidity), targetTemperature(0), targetTime(0), startTime(0) {
+HeaterSettings::HeaterSettings(TempHumidity& tempHumidity) : tempHumidity(tempHumidity), targetTemperature(0), targetTime(0), startTime(0), pausedAt(0), paused(false) {
 }
 
 void HeaterSettings::setTargetTemperature(uint8_t temperature) {
@@ -10,6 +10,7 @@ void HeaterSettings::setTargetTemperature(uint8_t temperature) {
 void HeaterSettings::setTargetTime(unsigned long time) {
     targetTime = time;
     startTime = millis();
+    paused = false;
 }
 
 uint8_t HeaterSettings::getTargetTemperature() const {
@@ -21,10 +22,36 @@ unsigned long HeaterSettings::getTargetTime() const {
 }
 
 unsigned long HeaterSettings::computeRemainingTime() {
-    unsigned long currentTime = millis();
-    unsigned long elapsedTime = currentTime - startTime;
+    unsigned long elapsedTime = now() - startTime;
     if (elapsedTime >= targetTime) {
         return 0;
     }
     return targetTime - elapsedTime;
 }
+
+unsigned long HeaterSettings::getElapsedTime() const {
+    unsigned long elapsedTime = now() - startTime;
+    return elapsedTime >= targetTime ? targetTime : elapsedTime;
+}
+
+void HeaterSettings::resume(uint8_t temperature, unsigned long time, unsigned long elapsed) {
+    targetTemperature = temperature;
+    targetTime = time;
+    startTime = millis() - (elapsed > time ? time : elapsed);
+    paused = false;
+}
+
+void HeaterSettings::setPaused(bool pause) {
+    if (pause == paused) return;
+    if (pause) pausedAt = millis();
+    else       startTime += millis() - pausedAt;
+    paused = pause;
+}
+
+bool HeaterSettings::isPaused() const {
+    return paused;
+}
+
+unsigned long HeaterSettings::now() const {
+    return paused ? pausedAt : millis();
+}
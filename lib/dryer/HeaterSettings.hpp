@@ -13,11 +13,25 @@ public:
     unsigned long getTargetTime() const;
     unsigned long computeRemainingTime();
 
+    // Drying time already spent on the current target, used for checkpoints.
+    unsigned long getElapsedTime() const;
+    // Restore a cycle that had already run for `elapsed` ms before a reset.
+    void resume(uint8_t temperature, unsigned long time, unsigned long elapsed);
+
+    // Stops the clock while the heater is held off (shared power budget), so
+    // the cycle is not used up waiting for heat
+    void setPaused(bool paused);
+    bool isPaused() const;
+
 private:
     TempHumidity& tempHumidity;
     uint8_t targetTemperature;
     unsigned long targetTime;
     unsigned long startTime;
+    unsigned long pausedAt;
+    bool paused;
+
+    unsigned long now() const;
 };
 
 #endif // HEATER_SETTINGS_HPP
@@ -0,0 +1,47 @@
+#ifndef TRANSITION_HISTORY_HPP
+#define TRANSITION_HISTORY_HPP
+
+#include <Arduino.h>
+
+// One state change, 8 bytes
+struct TransitionRecord {
+    uint32_t atMs;    // millis() when it happened
+    int16_t  deciC;   // sensor reading at that moment, tenths of a degree
+    uint8_t  rule;    // row of DryerController's transition table
+    uint8_t  states;  // from << 4 | to (DryerState values)
+
+    uint8_t from() const { return states >> 4; }
+    uint8_t to()   const { return states & 0x0F; }
+};
+
+// The last SIZE transitions of one controller, oldest first. Recording is a
+// struct copy; decoding to names happens only when someone asks.
+class TransitionHistory {
+public:
+    static constexpr uint8_t SIZE = 64;
+
+    TransitionHistory() : head(0), stored(0), recorded(0) {}
+
+    void add(const TransitionRecord& record) {
+        ring[head] = record;
+        head = (head + 1) % SIZE;
+        if (stored < SIZE) stored++;
+        recorded++;
+    }
+
+    uint8_t  count() const { return stored; }
+    uint32_t total() const { return recorded; } // since boot; > count() once the ring wrapped
+
+    // 0 = oldest kept
+    const TransitionRecord& at(uint8_t i) const {
+        return ring[(head + SIZE - stored + i) % SIZE];
+    }
+
+private:
+    TransitionRecord ring[SIZE];
+    uint8_t          head;
+    uint8_t          stored;
+    uint32_t         recorded;
+};
+
+#endif // TRANSITION_HISTORY_HPP
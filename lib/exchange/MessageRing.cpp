@@ -0,0 +1,152 @@
+#include "MessageRing.hpp"
+
+constexpr uint8_t MessageRing::MAX_TOPIC;
+constexpr uint8_t MessageRing::HEADER;
+constexpr uint8_t MessageRing::RETAINED;
+
+MessageRing::MessageRing(uint8_t* storage, uint16_t size)
+    : ring(storage), size(size), head(0), tail(0), link(false), closing(false), refused(0),
+      highWater(0), streamAt(0), streamLength(0), streamed(0), streaming(false)
+{}
+
+bool MessageRing::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, reinterpret_cast<const uint8_t*>(payload), strlen(payload), retained);
+}
+
+bool MessageRing::publish(const char* topic, const uint8_t* payload, unsigned int length,
+                          bool retained) {
+    uint32_t at;
+    if (!reserve(topic, length, retained, at)) return false;
+    put(at, payload, length);
+    commit(at + length);
+    return true;
+}
+
+bool MessageRing::beginPublish(const char* topic, unsigned int length, bool retained) {
+    if (!reserve(topic, length, retained, streamAt)) return false;
+    streamLength = length;
+    streamed     = 0;
+    streaming    = true;
+    return true;
+}
+
+size_t MessageRing::write(const uint8_t* data, size_t n) {
+    if (!streaming) return 0;
+    if (n > (size_t)(streamLength - streamed)) n = streamLength - streamed;
+    put(streamAt + streamed, data, n);
+    streamed += n;
+    return n;
+}
+
+int MessageRing::endPublish() {
+    if (!streaming) return 0;
+    streaming = false;
+    if (streamed != streamLength) {
+        refuse();
+        return 0;
+    }
+    commit(streamAt + streamLength);
+    return 1;
+}
+
+// Writes the header behind head; nothing is visible until commit()
+bool MessageRing::reserve(const char* topic, unsigned int length, bool retained,
+                          uint32_t& payloadAt) {
+    if (streaming || !connected()) return false;
+
+    size_t topicLength = strnlen(topic, MAX_TOPIC + 1);
+    uint32_t at   = head.load(std::memory_order_relaxed);
+    uint32_t free = size - (at - tail.load(std::memory_order_acquire));
+    if (topicLength > MAX_TOPIC || length > 0xFFFF || HEADER + topicLength + length > free) {
+        refuse();
+        return false;
+    }
+
+    uint8_t header[HEADER] = {(uint8_t)length, (uint8_t)(length >> 8),
+                              (uint8_t)(retained ? RETAINED : 0), (uint8_t)topicLength};
+    put(at, header, HEADER);
+    put(at + HEADER, topic, topicLength);
+    payloadAt = at + HEADER + topicLength;
+    return true;
+}
+
+void MessageRing::commit(uint32_t end) {
+    uint32_t inUse = end - tail.load(std::memory_order_relaxed);
+    if (inUse > highWater) highWater = inUse;
+    head.store(end, std::memory_order_release);
+}
+
+void MessageRing::refuse() {
+    // Only the producer counts, so no read-modify-write is needed
+    refused.store(refused.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+uint16_t MessageRing::used() const {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+}
+
+// Offsets run freely and are masked here; size is a power of two
+void MessageRing::put(uint32_t at, const void* data, uint16_t n) {
+    uint16_t offset = at & (size - 1);
+    uint16_t first  = n < size - offset ? n : size - offset;
+    memcpy(ring + offset, data, first);
+    memcpy(ring, static_cast<const uint8_t*>(data) + first, n - first);
+}
+
+void MessageRing::get(uint32_t at, void* data, uint16_t n) const {
+    uint16_t offset = at & (size - 1);
+    uint16_t first  = n < size - offset ? n : size - offset;
+    memcpy(data, ring + offset, first);
+    memcpy(static_cast<uint8_t*>(data) + first, ring, n - first);
+}
+
+bool MessageRing::peek(Message& message, uint32_t& payloadAt, uint32_t& end) const {
+    uint32_t at = tail.load(std::memory_order_relaxed);
+    if (at == head.load(std::memory_order_acquire)) return false;
+
+    uint8_t header[HEADER];
+    get(at, header, HEADER);
+    message.length   = header[0] | header[1] << 8;
+    message.retained = header[2] & RETAINED;
+    get(at + HEADER, message.topic, header[3]);
+    message.topic[header[3]] = '\0';
+
+    payloadAt = at + HEADER + header[3];
+    end       = payloadAt + message.length;
+    return true;
+}
+
+bool MessageRing::pop(Message& message, uint8_t* out, uint16_t max) {
+    uint32_t at, end;
+    if (!peek(message, at, end)) return false;
+    get(at, out, message.length < max ? message.length : max);
+    tail.store(end, std::memory_order_release);
+    return true;
+}
+
+uint16_t MessageRing::forward(PubSubClient& client) {
+    uint16_t sent = 0;
+    Message  message;
+    uint32_t at, end;
+    while (peek(message, at, end)) {
+        // In one piece and small enough for the client's buffer: one write;
+        // otherwise streamed, which also covers the wrap-around
+        uint16_t offset = at & (size - 1);
+        bool     whole  = offset + message.length <= size;
+        bool     ok     = whole && client.publish(message.topic, ring + offset, message.length,
+                                                  message.retained);
+        if (!ok) ok = stream(client, message, at);
+        if (ok) sent++;
+        tail.store(end, std::memory_order_release);
+    }
+    return sent;
+}
+
+bool MessageRing::stream(PubSubClient& client, const Message& message, uint32_t at) {
+    if (!client.beginPublish(message.topic, message.length, message.retained)) return false;
+    uint16_t offset = at & (size - 1);
+    uint16_t first  = message.length < size - offset ? message.length : size - offset;
+    client.write(ring + offset, first);
+    if (message.length > first) client.write(ring, message.length - first);
+    return client.endPublish();
+}
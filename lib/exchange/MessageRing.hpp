@@ -0,0 +1,93 @@
+#ifndef MESSAGE_RING_HPP
+#define MESSAGE_RING_HPP
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <atomic>
+
+// MQTT messages handed from one task to another without locks: a byte ring
+// with one producer and one consumer. Each side only ever moves its own
+// index (head for the producer, tail for the consumer), so a message becomes
+// visible to the consumer in one store, after all of its bytes.
+//
+// The producer side has the publishing subset of PubSubClient (publish,
+// beginPublish/write/endPublish, connected), so code written against the
+// client can publish into a ring unchanged. As with the client, nothing is
+// accepted while the connection is down, and a message that does not fit is
+// refused (and counted) rather than waited for.
+//
+// Record: payload length u16, flags u8, topic length u8, topic, payload.
+class MessageRing {
+public:
+    static constexpr uint8_t MAX_TOPIC = 96;
+    static constexpr uint8_t HEADER    = 4;
+    static constexpr uint8_t RETAINED  = 0x01;
+
+    // storage must outlive the ring; size, a power of two, bounds the bytes in flight
+    MessageRing(uint8_t* storage, uint16_t size);
+
+    // ---- producer ----
+    bool publish(const char* topic, const char* payload, bool retained = false);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained = false);
+
+    // Streaming publish: space for length is reserved up front, the message
+    // is handed over by endPublish() once exactly length bytes were written
+    bool   beginPublish(const char* topic, unsigned int length, bool retained);
+    size_t write(uint8_t b) { return write(&b, 1); }
+    size_t write(const uint8_t* data, size_t size);
+    int    endPublish();
+
+    bool connected() const { return link.load(std::memory_order_acquire); }
+    void disconnect()      { closing.store(true, std::memory_order_release); } // asks the owner of the connection
+
+    // ---- consumer ----
+    struct Message {
+        char     topic[MAX_TOPIC + 1];
+        uint16_t length;
+        bool     retained;
+    };
+
+    // Oldest message; payload copied into out (false if empty). A payload
+    // longer than max is cut to max and length says so.
+    bool pop(Message& message, uint8_t* out, uint16_t max);
+
+    // Sends everything waiting through a real client, in order; returns how
+    // many messages went out. Messages the client refuses are dropped like
+    // a failed publish would be.
+    uint16_t forward(PubSubClient& client);
+
+    // ---- owner of the connection ----
+    void setConnected(bool up) { link.store(up, std::memory_order_release); }
+    bool takeDisconnect()      { return closing.exchange(false, std::memory_order_acq_rel); }
+
+    uint16_t used()    const;
+    uint16_t peak()    const { return highWater; }
+    uint32_t dropped() const { return refused.load(std::memory_order_relaxed); }
+
+private:
+    uint8_t* ring;
+    uint16_t size;
+
+    std::atomic<uint32_t> head;    // producer: bytes ever committed
+    std::atomic<uint32_t> tail;    // consumer: bytes ever released
+    std::atomic<bool>     link;
+    std::atomic<bool>     closing;
+    std::atomic<uint32_t> refused;
+    uint16_t              highWater; // producer's view
+
+    // open streaming publish, producer-only
+    uint32_t streamAt;
+    uint16_t streamLength;
+    uint16_t streamed;
+    bool     streaming;
+
+    bool     reserve(const char* topic, unsigned int length, bool retained, uint32_t& payloadAt);
+    void     commit(uint32_t end);
+    void     refuse();
+    void     put(uint32_t at, const void* data, uint16_t n);
+    void     get(uint32_t at, void* data, uint16_t n) const;
+    bool     peek(Message& message, uint32_t& payloadAt, uint32_t& end) const;
+    bool     stream(PubSubClient& client, const Message& message, uint32_t at);
+};
+
+#endif // MESSAGE_RING_HPP
@@ -0,0 +1,20 @@
+#ifndef MQTT_PUBLISHER_HPP
+#define MQTT_PUBLISHER_HPP
+
+// What modules publish through. On the ESP8266 (and the host) that is the
+// PubSubClient itself. With -DDRYER_TASKS=1 (ESP32) only the network task
+// touches the client; everything else publishes into a MessageRing the
+// network task forwards from.
+#ifndef DRYER_TASKS
+#define DRYER_TASKS 0
+#endif
+
+#if DRYER_TASKS
+#include "MessageRing.hpp"
+typedef MessageRing MqttPublisher;
+#else
+#include <PubSubClient.h>
+typedef PubSubClient MqttPublisher;
+#endif
+
+#endif // MQTT_PUBLISHER_HPP
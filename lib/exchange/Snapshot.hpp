@@ -0,0 +1,41 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include <atomic>
+#include <stdint.h>
+
+// Latest value of T from one writer task to one reader task (triple buffer).
+// The writer fills its own slot and swaps it with the middle one; the reader
+// swaps the middle slot for its own when something new arrived. Neither side
+// ever waits or sees a half-written value; values the reader did not get to
+// in time are simply replaced. T is copied, so keep it plain data.
+template <typename T>
+class Snapshot {
+public:
+    Snapshot() : back(0), front(1), middle(2) {}
+
+    // Writer side
+    void publish(const T& value) {
+        slots[back] = value;
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    // Reader side: false (out untouched) if nothing was published since the last read
+    bool read(T& out) {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        out = slots[front];
+        return true;
+    }
+
+private:
+    static constexpr uint8_t INDEX = 0x03;
+    static constexpr uint8_t FRESH = 0x04;
+
+    T                    slots[3];
+    uint8_t              back;   // writer's slot
+    uint8_t              front;  // reader's slot
+    std::atomic<uint8_t> middle; // slot in between, FRESH once published
+};
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,180 @@
+#ifndef BOARD_PROFILES_HPP
+#define BOARD_PROFILES_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Sensor model codes; the values are the Adafruit DHT library's type ids
+constexpr uint8_t SENSOR_DHT11 = 11;
+constexpr uint8_t SENSOR_DHT22 = 22;
+
+// Chip families, checked against the build in Pins.hpp
+constexpr uint8_t CHIP_ESP8266 = 0;
+constexpr uint8_t CHIP_ESP32   = 1;
+
+struct ZonePins {
+    uint8_t heater;
+    uint8_t fan;
+    uint8_t dht;
+};
+
+struct SafetyLimits {
+    uint8_t  cutoffC;        // SAFETY at or above this
+    uint8_t  releaseC;       // leave SAFETY below this (hysteresis)
+    uint8_t  cooledC;        // COOLING ends below this
+    uint16_t maxHeaterOnMin; // longest single heater on-phase the supervisor allows
+};
+
+// Everything that differs between hardware revisions. Profiles are constexpr,
+// so whatever the build selects folds into the code like a literal would.
+struct BoardProfile {
+    static constexpr size_t MAX_ZONES = 3;
+
+    const char*  name;
+    uint8_t      chip;                 // CHIP_ESP8266 / CHIP_ESP32
+    uint8_t      zoneCount;            // zones this board has pins for
+    ZonePins     zones[MAX_ZONES];
+    uint8_t      sensorType;           // SENSOR_DHT11 / SENSOR_DHT22
+    bool         relayActiveHigh;      // coil energised by a HIGH output
+    uint8_t      displaySda;
+    uint8_t      displayScl;
+    uint8_t      buttonPreset;         // SELECT
+    uint8_t      buttonStart;          // ENTER
+    SafetyLimits limits;
+    uint16_t     heaterW;              // nominal heater power, for energy estimates
+};
+
+namespace boards {
+
+// The original NodeMCU v2 / D1 mini wiring: DHT11, relay board driven
+// active-high. Zone 2 takes the last free GPIOs: D8 (boot strap, relay input
+// must not pull it high), D0 and RX — serial input is unavailable in
+// two-zone builds.
+constexpr BoardProfile NODEMCU_V2 = {
+    "nodemcuv2",
+    CHIP_ESP8266,
+    2,
+    {
+        {5, 0, 4},   // D1 heater, D3 fan, D2 DHT
+        {15, 16, 3}, // D8 heater, D0 fan, RX DHT
+    },
+    SENSOR_DHT11,
+    true,
+    14, 12,          // D5 SDA, D6 SCL
+    13, 2,           // D7 SELECT, D4 ENTER
+    {80, 75, 30, 45},
+    150,             // PTC element, cold
+};
+
+// A DHT22 (0.5 °C resolution, rated to 80 °C) and an active-low
+// opto-isolated relay board. The opto inputs pull up, which GPIO15 must not
+// see at boot and which would leave a relay on GPIO0/2 clicking through the
+// boot log, so the fan moves to D0 and there is no second zone.
+constexpr BoardProfile NODEMCU_V2_DHT22 = {
+    "nodemcuv2-dht22",
+    CHIP_ESP8266,
+    1,
+    {
+        {5, 16, 4},  // D1 heater, D0 fan, D2 DHT
+    },
+    SENSOR_DHT22,
+    false,
+    14, 12,
+    13, 2,
+    {80, 75, 30, 45},
+    150,
+};
+
+// ESP32 DevKit (esp32 env): DHT22s, active-low opto-isolated relay board,
+// OLED on the default I2C pins. Strapping pins (0, 2, 5, 12, 15) and the
+// input-only 34..39 stay free.
+constexpr BoardProfile ESP32_DEVKIT = {
+    "esp32-devkit",
+    CHIP_ESP32,
+    2,
+    {
+        {26, 27, 4},
+        {32, 33, 16},
+    },
+    SENSOR_DHT22,
+    false,
+    21, 22,
+    18, 19,
+    {80, 75, 30, 45},
+    150,
+};
+
+// ---- compile-time checks, used by static_assert in Pins.hpp ----
+
+constexpr bool isUsableGpio(uint8_t chip, uint8_t pin) {
+    if (pin >= 6 && pin <= 11) return false; // SPI flash on both
+    if (chip == CHIP_ESP8266) return pin <= 16;
+    // 12 selects the flash voltage at boot, 20/24/28..31 are not bonded out,
+    // 34..39 are inputs without pull-ups
+    return pin <= 33 && pin != 12 && pin != 20 && pin != 24 && !(pin >= 28 && pin <= 31);
+}
+
+// Buttons are edge-interrupt driven with the internal pull-up: on the
+// ESP8266 GPIO16 has neither, GPIO15 must be low at boot.
+constexpr bool isButtonGpio(uint8_t chip, uint8_t pin) {
+    return isUsableGpio(chip, pin) && (chip == CHIP_ESP32 || (pin != 15 && pin != 16));
+}
+
+template <size_t N>
+constexpr bool allDistinct(const uint8_t (&pins)[N]) {
+    for (size_t i = 0; i < N; i++)
+        for (size_t j = i + 1; j < N; j++)
+            if (pins[i] == pins[j]) return false;
+    return true;
+}
+
+// Every pin the first `zones` zones, the display and the buttons use
+template <uint8_t Zones>
+constexpr bool pinsValid(const BoardProfile& b) {
+    uint8_t pins[Zones * 3 + 4] = {};
+    size_t  n = 0;
+    for (uint8_t z = 0; z < Zones; z++) {
+        pins[n++] = b.zones[z].heater;
+        pins[n++] = b.zones[z].fan;
+        pins[n++] = b.zones[z].dht;
+    }
+    pins[n++] = b.displaySda;
+    pins[n++] = b.displayScl;
+    pins[n++] = b.buttonPreset;
+    pins[n++] = b.buttonStart;
+
+    for (size_t i = 0; i < n; i++)
+        if (!isUsableGpio(b.chip, pins[i])) return false;
+    return allDistinct(pins) && isButtonGpio(b.chip, b.buttonPreset) &&
+           isButtonGpio(b.chip, b.buttonStart);
+}
+
+// ESP8266 strapping pins: 15 must be low at boot, 0 and 2 high, and 2 carries
+// the boot log. An active-low relay input pulls its pin up and would be
+// switched by whatever the pin does until setup() takes it over.
+constexpr bool isStrapGpio(uint8_t chip, uint8_t pin) {
+    return chip == CHIP_ESP8266 && (pin == 0 || pin == 2 || pin == 15);
+}
+
+template <uint8_t Zones>
+constexpr bool relaysBootSafe(const BoardProfile& b) {
+    if (b.relayActiveHigh) return true;
+    for (uint8_t z = 0; z < Zones; z++)
+        if (isStrapGpio(b.chip, b.zones[z].heater) || isStrapGpio(b.chip, b.zones[z].fan))
+            return false;
+    return true;
+}
+
+constexpr bool sensorKnown(const BoardProfile& b) {
+    return b.sensorType == SENSOR_DHT11 || b.sensorType == SENSOR_DHT22;
+}
+
+constexpr bool limitsValid(const BoardProfile& b) {
+    return b.limits.cooledC < b.limits.releaseC &&
+           b.limits.releaseC < b.limits.cutoffC &&
+           b.limits.maxHeaterOnMin > 0;
+}
+
+} // namespace boards
+
+#endif // BOARD_PROFILES_HPP
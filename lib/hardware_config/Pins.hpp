@@ -1,15 +1,47 @@
 #ifndef PINS_H
 #define PINS_H
 
-#define HEATER_RELAIS_PIN 5
-#define FAN_RELAIS_PIN    0
-#define DHTPIN            4
-#define DHTTYPE           DHT11
+#include <stdint.h>
+#include "BoardProfiles.hpp"
 
-#define DISPLAY_SDA_PIN   14  // D5
-#define DISPLAY_SCL_PIN   12  // D6
+// Hardware revision, picked per PlatformIO env (-DDRYER_BOARD=NODEMCU_V2_DHT22);
+// the name is a profile in BoardProfiles.hpp
+#ifndef DRYER_BOARD
+#if defined(ESP32)
+#define DRYER_BOARD ESP32_DEVKIT
+#else
+#define DRYER_BOARD NODEMCU_V2
+#endif
+#endif
 
-#define BUTTON_PRESET_PIN 13  // D7 — cycle filament preset
-#define BUTTON_START_PIN   2  // D4 — start / stop
+// Number of independent chambers driven by this board (-DDRYER_ZONE_COUNT=N)
+#ifndef DRYER_ZONE_COUNT
+#define DRYER_ZONE_COUNT  1
+#endif
 
-#endif // PINS_H
\ No newline at end of file
+// static: a namespace-scope reference would otherwise have external linkage
+static constexpr const BoardProfile& BOARD = boards::DRYER_BOARD;
+
+constexpr const ZonePins* ZONE_PINS = BOARD.zones;
+
+// Output levels that switch a relay coil on/off on this board
+constexpr uint8_t RELAY_ON_LEVEL  = BOARD.relayActiveHigh ? 1 : 0;
+constexpr uint8_t RELAY_OFF_LEVEL = BOARD.relayActiveHigh ? 0 : 1;
+
+static_assert(DRYER_ZONE_COUNT >= 1 && DRYER_ZONE_COUNT <= BOARD.zoneCount,
+              "DRYER_ZONE_COUNT exceeds the zones this board has pins for");
+static_assert(BOARD.zoneCount <= BoardProfile::MAX_ZONES, "profile lists too many zones");
+static_assert(boards::pinsValid<DRYER_ZONE_COUNT>(BOARD),
+              "board profile: pin reused, reserved for flash, or unusable for a button");
+static_assert(boards::relaysBootSafe<DRYER_ZONE_COUNT>(BOARD),
+              "board profile: active-low relay on an ESP8266 strapping pin (0, 2, 15)");
+static_assert(boards::sensorKnown(BOARD), "board profile: unknown sensor type");
+#if defined(ESP32)
+static_assert(BOARD.chip == CHIP_ESP32, "board profile is for an ESP8266");
+#else
+static_assert(BOARD.chip == CHIP_ESP8266, "board profile is for an ESP32");
+#endif
+static_assert(boards::limitsValid(BOARD),
+              "board profile: limits must satisfy cooled < release < cutoff");
+
+#endif // PINS_H
@@ -0,0 +1,60 @@
+#include "AllocationTracker.hpp"
+
+const LoopWatchdog* AllocationTracker::watchdog   = nullptr;
+uint8_t             AllocationTracker::depth      = 0;
+uint32_t            AllocationTracker::total      = 0;
+uint32_t            AllocationTracker::totalBytes = 0;
+uint32_t            AllocationTracker::perScope[static_cast<uint8_t>(Subsystem::COUNT)] = {};
+
+void AllocationTracker::arm(const LoopWatchdog& wd) {
+    watchdog = &wd;
+}
+
+// Called from inside the allocator: no logging, no allocation
+void AllocationTracker::record(size_t bytes) {
+    if (!watchdog || depth) return;
+    total++;
+    totalBytes += bytes;
+    perScope[static_cast<uint8_t>(watchdog->getSubsystem())]++;
+}
+
+// Linker wrappers, see platformio.ini. size_t is unsigned int on the
+// ESP8266, hence _Znwj/_Znaj for operator new/new[]. The ESP32 build does
+// not wrap (its heap is shared by tasks the watchdog scopes know nothing
+// about), so the counts stay at zero there.
+#if !defined(ESP32)
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __real__Znwj(size_t size);
+void* __real__Znaj(size_t size);
+
+void* __wrap_malloc(size_t size) {
+    AllocationTracker::record(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    AllocationTracker::record(count * size);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    AllocationTracker::record(size);
+    return __real_realloc(ptr, size);
+}
+
+void* __wrap__Znwj(size_t size) {
+    AllocationTracker::record(size);
+    AllocationTracker::Nested nested;
+    return __real__Znwj(size);
+}
+
+void* __wrap__Znaj(size_t size) {
+    AllocationTracker::record(size);
+    AllocationTracker::Nested nested;
+    return __real__Znaj(size);
+}
+}
+#endif
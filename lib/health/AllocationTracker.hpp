@@ -0,0 +1,42 @@
+#ifndef ALLOCATION_TRACKER_HPP
+#define ALLOCATION_TRACKER_HPP
+
+#include <Arduino.h>
+#include "LoopWatchdog.hpp"
+
+// Counts heap allocations once setup() is done, per watchdog scope, so a
+// steady state that allocates shows up in tele/<device>/health.
+//
+// The firmware is linked with -Wl,--wrap for malloc, calloc, realloc and
+// operator new/new[] (platformio.ini); the wrappers call record(). The SDK's
+// own pvPortMalloc is not seen. What the network stack and the flash file
+// system allocate lands in the scope that called them (MQTT_*, TELEMETRY,
+// CHECKPOINT, OTA) or in NONE for callbacks between loop passes; SENSOR,
+// CONTROL, DISPLAY and BUTTONS are expected to stay at zero.
+class AllocationTracker {
+public:
+    // Start counting (end of setup())
+    static void arm(const LoopWatchdog& watchdog);
+
+    static void record(size_t bytes);
+
+    static uint32_t count()              { return total; }
+    static uint32_t bytes()              { return totalBytes; }
+    static uint32_t countIn(Subsystem s) { return perScope[static_cast<uint8_t>(s)]; }
+
+    // Keeps the malloc inside an operator new from being counted again
+    class Nested {
+    public:
+        Nested()  { depth++; }
+        ~Nested() { depth--; }
+    };
+
+private:
+    static const LoopWatchdog* watchdog;
+    static uint8_t             depth;
+    static uint32_t            total;
+    static uint32_t            totalBytes;
+    static uint32_t            perScope[static_cast<uint8_t>(Subsystem::COUNT)];
+};
+
+#endif // ALLOCATION_TRACKER_HPP
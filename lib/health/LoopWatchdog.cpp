@@ -0,0 +1,148 @@
+#include "LoopWatchdog.hpp"
+#include <ArduinoJson.h>
+#include <Log.hpp>
+#include <RtcSlots.hpp>
+#include <Version.hpp>
+
+constexpr uint32_t LoopWatchdog::BREADCRUMB_MAGIC;
+constexpr uint32_t LoopWatchdog::CRASH_MAGIC;
+constexpr uint32_t LoopWatchdog::CHECK_INTERVAL_MS;
+
+LoopWatchdog::LoopWatchdog(MqttPublisher& client, Topics& topics)
+    : client(client), topics(topics), current(Subsystem::NONE), enteredAt(0), pending(false), record()
+{}
+
+void LoopWatchdog::begin() {
+    uint8_t reason = platform::resetReason();
+
+    platform::rtcRead(RTC_SLOT_CRASH, &record, sizeof(record));
+    if (record.magic == CRASH_MAGIC && record.checksum == checksumOf(record)) {
+        pending = true; // forced restart by check()
+    } else if (reason == REASON_WDT_RST || reason == REASON_SOFT_WDT_RST ||
+               reason == REASON_EXCEPTION_RST) {
+        // The SDK pulled the plug: reconstruct what we can from the breadcrumb
+        Breadcrumb crumb;
+        platform::rtcRead(RTC_SLOT_BREADCRUMB, &crumb, sizeof(crumb));
+        record = CrashRecord();
+        if (crumb.magic == BREADCRUMB_MAGIC && crumb.subsystem < static_cast<uint32_t>(Subsystem::COUNT)) {
+            record.subsystem = crumb.subsystem;
+            record.uptimeMs  = crumb.enteredAt;
+            record.freeHeap  = crumb.freeHeap;
+        }
+        record.magic = CRASH_MAGIC;
+        pending      = true;
+    }
+    record.resetReason = reason;
+
+    if (pending) {
+        LOG_WARN("WDT | previous reset in %s after %u ms (reason %u)",
+                 nameOf(static_cast<Subsystem>(record.subsystem)), record.stallMs, reason);
+    }
+    clearRecord();
+    enter(Subsystem::SETUP);
+}
+
+void LoopWatchdog::arm() {
+    leave(Subsystem::NONE);
+    ticker.attach_ms(CHECK_INTERVAL_MS, onTicker, this);
+}
+
+void LoopWatchdog::update() {
+    if (!pending || !client.connected()) return;
+
+    StaticJsonDocument<256> doc;
+    doc["subsystem"]   = nameOf(static_cast<Subsystem>(record.subsystem));
+    doc["stallMs"]     = record.stallMs;
+    doc["forced"]      = record.forced != 0;
+    doc["resetReason"] = record.resetReason;
+    doc["uptime"]      = record.uptimeMs / 1000;
+    doc["freeHeap"]    = record.freeHeap;
+    doc["firmware"]    = FIRMWARE_VERSION;
+
+    char buffer[256];
+    serializeJson(doc, buffer);
+    if (client.publish(topics.tele("crash"), buffer, true)) pending = false;
+}
+
+Subsystem LoopWatchdog::enter(Subsystem s) {
+    Subsystem previous = current;
+    enteredAt = millis();
+    current   = s;
+    writeBreadcrumb();
+    return previous;
+}
+
+void LoopWatchdog::leave(Subsystem previous) {
+    // The outer scope's clock restarts: only the innermost region is timed
+    enteredAt = millis();
+    current   = previous;
+    writeBreadcrumb();
+}
+
+// Static with an argument: the ESP32 core's Ticker takes no std::function
+void LoopWatchdog::onTicker(LoopWatchdog* self) {
+    self->check();
+}
+
+void LoopWatchdog::check() {
+    Subsystem s     = current;
+    uint32_t  stall = millis() - enteredAt;
+    if (s == Subsystem::NONE || stall < stallLimitMs(s)) return;
+
+    CrashRecord rec = {};
+    rec.magic     = CRASH_MAGIC;
+    rec.subsystem = static_cast<uint8_t>(s);
+    rec.forced    = 1;
+    rec.stallMs   = stall;
+    rec.uptimeMs  = millis();
+    rec.freeHeap  = platform::freeHeap();
+    rec.checksum  = checksumOf(rec);
+    platform::rtcWrite(RTC_SLOT_CRASH, &rec, sizeof(rec));
+    ESP.restart();
+}
+
+void LoopWatchdog::writeBreadcrumb() {
+    Breadcrumb crumb = { BREADCRUMB_MAGIC, static_cast<uint32_t>(current), enteredAt, platform::freeHeap() };
+    platform::rtcWrite(RTC_SLOT_BREADCRUMB, &crumb, sizeof(crumb));
+}
+
+void LoopWatchdog::clearRecord() {
+    CrashRecord empty = {};
+    platform::rtcWrite(RTC_SLOT_CRASH, &empty, sizeof(empty));
+}
+
+uint32_t LoopWatchdog::stallLimitMs(Subsystem s) {
+    switch (s) {
+        case Subsystem::MQTT_CONNECT: return 60UL * 1000;     // one attempt; an outage is many short ones
+        case Subsystem::SETUP:        return UINT32_MAX;      // provisioning/AP mode may block forever
+        case Subsystem::CHECKPOINT:   return 3000;            // flash erase
+        case Subsystem::OTA:          return 10UL * 60 * 1000; // download + flash of a whole image
+        default:                      return 2000;
+    }
+}
+
+uint32_t LoopWatchdog::checksumOf(const CrashRecord& rec) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&rec);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(CrashRecord, checksum); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+const char* LoopWatchdog::nameOf(Subsystem s) {
+    switch (s) {
+        case Subsystem::NONE:         return "NONE";
+        case Subsystem::SETUP:        return "SETUP";
+        case Subsystem::BUTTONS:      return "BUTTONS";
+        case Subsystem::MQTT_LOOP:    return "MQTT_LOOP";
+        case Subsystem::MQTT_CONNECT: return "MQTT_CONNECT";
+        case Subsystem::SENSOR:       return "SENSOR";
+        case Subsystem::CONTROL:      return "CONTROL";
+        case Subsystem::CHECKPOINT:   return "CHECKPOINT";
+        case Subsystem::DISPLAY:      return "DISPLAY";
+        case Subsystem::TELEMETRY:    return "TELEMETRY";
+        case Subsystem::OTA:          return "OTA";
+        default:                      return "UNKNOWN";
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef LOOP_WATCHDOG_HPP
+#define LOOP_WATCHDOG_HPP
+
+#include <Arduino.h>
+#include <MqttPublisher.hpp>
+#include <Platform.hpp>
+#include <Ticker.h>
+#include <Topics.hpp>
+
+// Code regions the watchdog can attribute a stall to
+enum class Subsystem : uint8_t {
+    NONE,
+    SETUP,
+    BUTTONS,
+    MQTT_LOOP,
+    MQTT_CONNECT,
+    SENSOR,
+    CONTROL,
+    CHECKPOINT,
+    DISPLAY,
+    TELEMETRY,
+    OTA,
+    COUNT
+};
+
+// Software watchdog that knows which subsystem the loop is stuck in.
+//
+// Every WatchdogScope leaves a breadcrumb (subsystem, entry time, heap) in RTC
+// memory. A Ticker checks the innermost scope every CHECK_INTERVAL_MS; when it
+// has run past its limit a post-mortem record is written to RTC memory and the
+// chip is restarted. Hangs that never yield (I2C, DHT) end in the SDK's own
+// watchdog reset instead — the breadcrumb then still names the culprit.
+// After boot the record is published once on tele/<device>/crash.
+// With DRYER_TASKS (ESP32) the scopes are the control task's; a stalled
+// network or display task is not seen here.
+class LoopWatchdog {
+public:
+    LoopWatchdog(MqttPublisher& client, Topics& topics);
+
+    // Call first thing in setup(): collects the previous post-mortem, if any
+    void begin();
+    // Start enforcing stall limits (call at the end of setup())
+    void arm();
+
+    // Publish the pending post-mortem once MQTT is connected; cheap otherwise
+    void update();
+
+    Subsystem enter(Subsystem s);   // returns the scope being interrupted
+    void      leave(Subsystem previous);
+    Subsystem getSubsystem() const { return current; } // innermost scope, NONE between them
+
+    static const char* nameOf(Subsystem s);
+
+private:
+    struct Breadcrumb {
+        uint32_t magic;
+        uint32_t subsystem;
+        uint32_t enteredAt; // millis()
+        uint32_t freeHeap;
+    };
+
+    struct CrashRecord {
+        uint32_t magic;
+        uint8_t  subsystem;
+        uint8_t  resetReason;  // REASON_* of the boot that found it (Platform.hpp)
+        uint8_t  forced;       // 1 = restarted by this watchdog, 0 = SDK/HW reset
+        uint8_t  reserved;
+        uint32_t stallMs;      // 0 when unknown (SDK watchdog reset)
+        uint32_t uptimeMs;
+        uint32_t freeHeap;
+        uint32_t reserved2[2];
+        uint32_t checksum;
+    };
+
+    MqttPublisher&    client;
+    Topics&           topics;
+    Ticker            ticker;
+    volatile Subsystem current;
+    volatile uint32_t  enteredAt;
+    bool              pending;
+    CrashRecord       record;
+
+    static void onTicker(LoopWatchdog* self);
+    void check();
+    void writeBreadcrumb();
+    void clearRecord();
+
+    static uint32_t stallLimitMs(Subsystem s);
+    static uint32_t checksumOf(const CrashRecord& rec);
+
+    static constexpr uint32_t BREADCRUMB_MAGIC  = 0x42524431; // "BRD1"
+    static constexpr uint32_t CRASH_MAGIC       = 0x43525331; // "CRS1"
+    static constexpr uint32_t CHECK_INTERVAL_MS = 250;
+};
+
+// Marks the enclosing block as belonging to a subsystem
+class WatchdogScope {
+public:
+    WatchdogScope(LoopWatchdog& watchdog, Subsystem s)
+        : watchdog(watchdog), previous(watchdog.enter(s)) {}
+    ~WatchdogScope() { watchdog.leave(previous); }
+
+private:
+    LoopWatchdog& watchdog;
+    Subsystem     previous;
+};
+
+#endif // LOOP_WATCHDOG_HPP
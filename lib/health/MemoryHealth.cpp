@@ -0,0 +1,100 @@
+#include "MemoryHealth.hpp"
+#include "AllocationTracker.hpp"
+#include <ArduinoJson.h>
+#include <Log.hpp>
+#include <Platform.hpp>
+
+constexpr uint32_t MemoryHealth::BASE_BLOCK;
+constexpr uint32_t MemoryHealth::WARNING_MARGIN;
+constexpr uint32_t MemoryHealth::PUBLISH_INTERVAL_MS;
+
+MemoryHealth::MemoryHealth(MqttPublisher& client, Topics& topics)
+    : client(client), topics(topics), status(MemoryStatus::OK), requiredBlock(BASE_BLOCK),
+      freeHeap(0), maxBlock(0), fragmentation(0), stackFree(0), minFreeHeap(UINT32_MAX),
+      minMaxBlock(UINT32_MAX), maxFragmentation(0), lastPublish(0), quietAllocs(0)
+{}
+
+void MemoryHealth::update() {
+    MemoryStatus previous = status;
+    sample();
+
+    if (status > previous) {
+        LOG_WARN("MEM | %s: max block %u B, free %u B, frag %u%%",
+                 getStatusName(), maxBlock, freeHeap, fragmentation);
+    }
+
+    // Our own per-tick code keeps to static buffers
+    static const Subsystem quiet[] = {Subsystem::BUTTONS, Subsystem::SENSOR,
+                                      Subsystem::CONTROL, Subsystem::DISPLAY};
+    uint32_t allocs = 0;
+    for (Subsystem q : quiet) allocs += AllocationTracker::countIn(q);
+    if (allocs != quietAllocs) {
+        LOG_WARN("MEM | %u allocation(s) in sensor/control/display/buttons since setup", allocs);
+        quietAllocs = allocs;
+    }
+
+    if (status > previous || millis() - lastPublish >= PUBLISH_INTERVAL_MS) {
+        lastPublish = millis();
+        publish();
+    }
+}
+
+void MemoryHealth::sample() {
+    platform::HeapStats heap = platform::heapStats();
+    freeHeap      = heap.freeHeap;
+    maxBlock      = heap.maxBlock;
+    fragmentation = heap.fragmentation;
+    stackFree     = platform::stackFree();
+
+    if (freeHeap < minFreeHeap)          minFreeHeap      = freeHeap;
+    if (maxBlock < minMaxBlock)          minMaxBlock      = maxBlock;
+    if (fragmentation > maxFragmentation) maxFragmentation = fragmentation;
+
+    if (maxBlock < requiredBlock)                       status = MemoryStatus::CRITICAL;
+    else if (maxBlock < requiredBlock + WARNING_MARGIN) status = MemoryStatus::WARNING;
+    else                                                 status = MemoryStatus::OK;
+}
+
+void MemoryHealth::publish() {
+    StaticJsonDocument<512> doc;
+    doc["status"]           = getStatusName();
+    doc["freeHeap"]         = freeHeap;
+    doc["maxFreeBlock"]     = maxBlock;
+    doc["requiredBlock"]    = requiredBlock;
+    doc["fragmentation"]    = fragmentation;
+    doc["stackFree"]        = stackFree;
+    doc["minFreeHeap"]      = minFreeHeap;
+    doc["minMaxFreeBlock"]  = minMaxBlock;
+    doc["maxFragmentation"] = maxFragmentation;
+    doc["uptime"]           = millis() / 1000;
+
+    // Since setup; only the scopes that allocated
+    doc["allocs"]     = AllocationTracker::count();
+    doc["allocBytes"] = AllocationTracker::bytes();
+    JsonObject by = doc.createNestedObject("allocsBy");
+    for (uint8_t i = 0; i < static_cast<uint8_t>(Subsystem::COUNT); i++) {
+        uint32_t n = AllocationTracker::countIn(static_cast<Subsystem>(i));
+        if (n) by[LoopWatchdog::nameOf(static_cast<Subsystem>(i))] = n;
+    }
+
+    char   buffer[512];
+    size_t length = serializeJson(doc, buffer);
+
+    // Streamed: with allocsBy it outgrows the 256-byte client buffer
+    if (!client.connected()) return;
+    bool sent = client.beginPublish(topics.tele("health"), length, false);
+    if (sent) {
+        sent = client.write((const uint8_t*)buffer, length) == length;
+        sent = client.endPublish() && sent;
+    }
+    if (!sent) LOG_WARN("MEM | health report (%u B) not published", (unsigned)length);
+}
+
+const char* MemoryHealth::getStatusName() const {
+    switch (status) {
+        case MemoryStatus::OK:       return "OK";
+        case MemoryStatus::WARNING:  return "WARNING";
+        case MemoryStatus::CRITICAL: return "CRITICAL";
+        default:                     return "UNKNOWN";
+    }
+}
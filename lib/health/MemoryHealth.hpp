@@ -0,0 +1,65 @@
+#ifndef MEMORY_HEALTH_HPP
+#define MEMORY_HEALTH_HPP
+
+#include <Arduino.h>
+#include <MqttPublisher.hpp>
+#include <Topics.hpp>
+
+enum class MemoryStatus {
+    OK,
+    WARNING,  // largest free block close to what MQTT + JSON need
+    CRITICAL  // largest free block below that: next publish/connect may fail
+};
+
+// Tracks heap fragmentation and stack headroom over long uptimes.
+//
+// The number that actually kills a long-running ESP8266 is not the free heap
+// but the largest contiguous block: PubSubClient needs its packet buffer and
+// a reconnect needs the TCP/client-id allocations in one piece, and over TLS
+// the BearSSL record buffers too. The status is raised before that block
+// drops below getRequiredBlock(). Allocations after setup
+// (AllocationTracker) are reported with it.
+class MemoryHealth {
+public:
+    MemoryHealth(MqttPublisher& client, Topics& topics);
+
+    // Call once per control tick; samples cheaply and publishes every
+    // PUBLISH_INTERVAL_MS (or immediately when the status gets worse).
+    void update();
+
+    MemoryStatus getStatus()       const { return status; }
+    const char*  getStatusName()   const;
+    uint32_t     getMinFreeHeap()  const { return minFreeHeap; }
+    uint32_t     getMinMaxBlock()  const { return minMaxBlock; }
+
+    // What the broker link allocates on a reconnect: TLS rx + tx buffers and
+    // the MQTT packet buffer (BrokerLink, PubSubClient::getBufferSize())
+    void     setLinkBuffers(uint32_t bytes) { requiredBlock = BASE_BLOCK + bytes; }
+    // Sum of the buffers a publish/reconnect must be able to allocate
+    uint32_t getRequiredBlock() const { return requiredBlock; }
+
+    static constexpr uint32_t BASE_BLOCK     = 2048; // TCP, client id, JSON
+    static constexpr uint32_t WARNING_MARGIN = 2048;
+
+private:
+    MqttPublisher& client;
+    Topics&        topics;
+    MemoryStatus   status;
+    uint32_t       requiredBlock;
+    uint32_t       freeHeap;
+    uint32_t       maxBlock;
+    uint8_t        fragmentation;  // percent
+    uint32_t       stackFree;      // untouched bytes of the loop/control task stack
+    uint32_t       minFreeHeap;
+    uint32_t       minMaxBlock;
+    uint8_t        maxFragmentation;
+    uint32_t       lastPublish;
+    uint32_t       quietAllocs;    // after setup, in scopes that should not allocate
+
+    void sample();
+    void publish();
+
+    static constexpr uint32_t PUBLISH_INTERVAL_MS = 60000;
+};
+
+#endif // MEMORY_HEALTH_HPP
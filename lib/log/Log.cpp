@@ -0,0 +1,255 @@
+#include "Log.hpp"
+
+constexpr uint16_t LogBuffer::SIZE;
+constexpr uint8_t  LogBuffer::MAX_RECORD;
+constexpr uint8_t  LogBuffer::MAX_STRING;
+constexpr uint8_t  LogBuffer::MAX_TEXT;
+constexpr uint8_t  LogBuffer::MAX_SINKS;
+constexpr uint8_t  LogBuffer::HEADER;
+constexpr uint8_t  SerialLogSink::PREFIX;
+constexpr uint8_t  SerialLogSink::TX_FIFO;
+
+LogBuffer log_buffer;
+
+static const char DROPPED_FORMAT[] PROGMEM = "LOG | %u records dropped";
+
+// On the ESP32 several tasks log: the bookkeeping and the copy into the ring
+// run in a short spinlock critical section. drain() has a single caller.
+#if defined(ESP32)
+static portMUX_TYPE ringMux = portMUX_INITIALIZER_UNLOCKED;
+struct RingLock {
+    RingLock()  { portENTER_CRITICAL(&ringMux); }
+    ~RingLock() { portEXIT_CRITICAL(&ringMux); }
+};
+#else
+struct RingLock {
+    RingLock() {} // nothing to guard on one core
+};
+#endif
+
+LogBuffer::LogBuffer()
+    : head(0), tail(0), stored(0), droppedSince(0), droppedTotal(0),
+      level(LogLevel::DEBUG), sinks()
+{}
+
+void LogBuffer::putWord(uint8_t* record, uint8_t& size, char tag, const void* value) {
+    if (size + 5 > MAX_RECORD) return;
+    record[size++] = tag;
+    memcpy(record + size, value, 4);
+    size += 4;
+}
+
+void LogBuffer::putString(uint8_t* record, uint8_t& size, const char* s) {
+    if (size + 2 > MAX_RECORD) return;
+    size_t length = s ? strlen(s) : 0;
+    if (length > MAX_STRING)              length = MAX_STRING;
+    if (length > MAX_RECORD - size - 2u)  length = MAX_RECORD - size - 2u;
+    record[size++] = 's';
+    record[size++] = length;
+    memcpy(record + size, s, length);
+    size += length;
+}
+
+void LogBuffer::commit(uint8_t* record, uint8_t size, LogLevel at, const char* format) {
+    uint32_t now = millis();
+    record[0] = size;
+    record[1] = (uint8_t)at;
+    memcpy(record + 2, &now, 4);
+    memcpy(record + 6, &format, sizeof(format));
+
+    RingLock lock;
+    uint8_t  note[HEADER + 5];
+    uint8_t  noteSize = 0;
+    if (droppedSince) {
+        uint32_t count = droppedSince;
+        noteSize = HEADER;
+        putWord(note, noteSize, 'u', &count);
+        const char* f = DROPPED_FORMAT;
+        note[0] = noteSize;
+        note[1] = (uint8_t)LogLevel::WARN;
+        memcpy(note + 2, &now, 4);
+        memcpy(note + 6, &f, sizeof(f));
+    }
+
+    if (stored + noteSize + size > SIZE) {
+        droppedSince++;
+        droppedTotal++;
+        return;
+    }
+    if (noteSize) {
+        push(note, noteSize);
+        droppedSince = 0;
+    }
+    push(record, size);
+}
+
+void LogBuffer::push(const uint8_t* record, uint8_t size) {
+    uint16_t first = SIZE - head < size ? SIZE - head : size;
+    memcpy(ring + head, record, first);
+    memcpy(ring, record + first, size - first);
+    head    = (head + size) % SIZE;
+    stored += size;
+}
+
+uint8_t LogBuffer::peek(uint8_t* record) const {
+    uint8_t  size  = ring[tail];
+    uint16_t first = SIZE - tail < size ? SIZE - tail : size;
+    memcpy(record, ring + tail, first);
+    memcpy(record + first, ring, size - first);
+    return size;
+}
+
+void LogBuffer::drain() { pump(false); }
+void LogBuffer::flush() { pump(true); }
+
+void LogBuffer::pump(bool all) {
+    uint8_t record[MAX_RECORD];
+    char    text[MAX_TEXT];
+
+    while (stored) {
+        uint8_t size   = peek(record);
+        size_t  length = format(record, text, sizeof(text));
+
+        bool room = true;
+        for (uint8_t i = 0; i < MAX_SINKS && !all; i++)
+            if (sinks[i] && !sinks[i]->ready(length)) room = false;
+        if (!room) break;
+
+        for (uint8_t i = 0; i < MAX_SINKS; i++)
+            if (sinks[i]) sinks[i]->write(record, text, length);
+        tail = (tail + size) % SIZE;
+        RingLock lock;
+        stored -= size;
+    }
+
+    for (uint8_t i = 0; i < MAX_SINKS; i++)
+        if (sinks[i]) sinks[i]->flush();
+}
+
+bool LogBuffer::addSink(LogSink* sink) {
+    for (uint8_t i = 0; i < MAX_SINKS; i++)
+        if (sinks[i] == sink) return true;
+    for (uint8_t i = 0; i < MAX_SINKS; i++) {
+        if (!sinks[i]) {
+            sinks[i] = sink;
+            return true;
+        }
+    }
+    return false;
+}
+
+void LogBuffer::removeSink(LogSink* sink) {
+    for (uint8_t i = 0; i < MAX_SINKS; i++)
+        if (sinks[i] == sink) sinks[i] = nullptr;
+}
+
+// printf subset: flags, width and precision are kept, length modifiers are
+// replaced by what the stored argument needs
+size_t LogBuffer::format(const uint8_t* record, char* out, size_t size) {
+    const char* f;
+    memcpy(&f, record + 6, sizeof(f));
+    const uint8_t* arg = record + HEADER;
+    const uint8_t* end = record + record[0];
+
+    size_t n = 0;
+    char   c;
+    while ((c = pgm_read_byte(f++)) && n + 1 < size) {
+        if (c != '%') {
+            out[n++] = c;
+            continue;
+        }
+
+        char    spec[16] = "%";
+        uint8_t s        = 1;
+        while ((c = pgm_read_byte(f)) && strchr("-+ #0123456789.", c)) {
+            if (s < sizeof(spec) - 3) spec[s++] = c;
+            f++;
+        }
+        while ((c = pgm_read_byte(f)) && strchr("hlzjtL", c)) f++;
+        char conversion = pgm_read_byte(f);
+        if (!conversion) break;
+        f++;
+        if (conversion == '%') {
+            out[n++] = '%';
+            continue;
+        }
+
+        size_t room = size - n;
+        int    w;
+        if (arg >= end) {
+            w = snprintf(out + n, room, "?");
+        } else if (*arg == 's') {
+            char   text[MAX_STRING + 1];
+            size_t length = arg[1];
+            memcpy(text, arg + 2, length);
+            text[length] = '\0';
+            arg += 2 + length;
+            spec[s++] = 's';
+            w = snprintf(out + n, room, spec, text);
+        } else {
+            char tag = *arg;
+            uint32_t word;
+            memcpy(&word, arg + 1, 4);
+            arg += 5;
+            if (tag == 'f') {
+                float value;
+                memcpy(&value, &word, 4);
+                spec[s++] = strchr("eEfgG", conversion) ? conversion : 'f';
+                w = snprintf(out + n, room, spec, (double)value);
+            } else if (conversion == 'c') {
+                spec[s++] = 'c';
+                w = snprintf(out + n, room, spec, (int)word);
+            } else if (tag == 'i' && !strchr("xXo", conversion)) {
+                spec[s++] = 'l';
+                spec[s++] = 'd';
+                w = snprintf(out + n, room, spec, (long)(int32_t)word);
+            } else {
+                spec[s++] = 'l';
+                spec[s++] = strchr("xXo", conversion) ? conversion : 'u';
+                w = snprintf(out + n, room, spec, (unsigned long)word);
+            }
+        }
+        if (w > 0) n += (size_t)w < room ? (size_t)w : room - 1;
+    }
+    out[n] = '\0';
+    return n;
+}
+
+uint32_t LogBuffer::millisOf(const uint8_t* record) {
+    uint32_t ms;
+    memcpy(&ms, record + 2, 4);
+    return ms;
+}
+
+const char* LogBuffer::levelName(LogLevel l) {
+    switch (l) {
+        case LogLevel::ERR:   return "error";
+        case LogLevel::WARN:  return "warn";
+        case LogLevel::INFO:  return "info";
+        case LogLevel::DEBUG: return "debug";
+    }
+    return "info";
+}
+
+bool LogBuffer::levelFromName(const char* name, LogLevel& l) {
+    for (uint8_t i = (uint8_t)LogLevel::ERR; i <= (uint8_t)LogLevel::DEBUG; i++) {
+        if (!strcasecmp(name, levelName((LogLevel)i))) {
+            l = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SerialLogSink::ready(size_t length) {
+    // availableForWrite() never reports more than the FIFO holds
+    int room = Serial.availableForWrite();
+    return room > (int)(PREFIX + length) || room >= TX_FIFO;
+}
+
+void SerialLogSink::write(const uint8_t* record, const char* text, size_t length) {
+    (void)length;
+    uint32_t ms = LogBuffer::millisOf(record);
+    Serial.printf("%6lu.%03lu %c %s\n", (unsigned long)(ms / 1000), (unsigned long)(ms % 1000),
+                  "?EWID"[(uint8_t)LogBuffer::levelOf(record)], text);
+}
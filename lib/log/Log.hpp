@@ -0,0 +1,182 @@
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include <Arduino.h>
+#include <type_traits>
+
+// Compile-time level (-DDRYER_LOG_LEVEL=N): 0 off, 1 errors, 2 +warnings,
+// 3 +info (default), 4 +debug. Calls above it compile to nothing; their
+// arguments are still type-checked but never evaluated.
+#ifndef DRYER_LOG_LEVEL
+#define DRYER_LOG_LEVEL 3
+#endif
+
+enum class LogLevel : uint8_t { ERR = 1, WARN, INFO, DEBUG };
+
+// Where drained records go. Serial is one (below); syslog and MQTT live in
+// lib/log_sinks.
+class LogSink {
+public:
+    virtual ~LogSink() {}
+
+    // Room for a line of this length right now? false holds the record back
+    // until the next drain() (e.g. the UART FIFO is full)
+    virtual bool ready(size_t length) { (void)length; return true; }
+    virtual void write(const uint8_t* record, const char* text, size_t length) = 0;
+    // End of a drain pass; batching sinks send here
+    virtual void flush() {}
+};
+
+// Deferred logger. A LOG_* call copies its arguments into a compact binary
+// record in a byte ring; the format string stays in flash and only its
+// address is stored. drain(), called while the loop is idle, formats the
+// records and hands them to the sinks. Not for use from interrupts.
+//
+// Record: size u8, level u8, millis u32, format address (pointer width),
+// then per argument a type tag and its value: 'i' int32, 'u' uint32,
+// 'f' float (4 bytes each), 's' u8 length + bytes. Strings are cut to fit
+// MAX_STRING and the record. A record that finds the ring full is dropped
+// and counted; a "dropped" line goes out ahead of the next one that fits.
+class LogBuffer {
+public:
+    static constexpr uint16_t SIZE       = 1024;
+    static constexpr uint8_t  MAX_RECORD = 128;
+    static constexpr uint8_t  MAX_STRING = 64;
+    static constexpr uint8_t  MAX_TEXT   = 192; // formatted line
+    static constexpr uint8_t  MAX_SINKS  = 3;
+    static constexpr uint8_t  HEADER     = 2 + 4 + sizeof(const char*);
+
+    LogBuffer();
+
+    template <typename... Args>
+    void write(LogLevel at, const char* format, Args... args) {
+        if (at > level) return;
+        uint8_t record[MAX_RECORD];
+        uint8_t size = HEADER;
+        using expand = int[];
+        (void)expand{0, (put(record, size, args), 0)...};
+        commit(record, size, at, format);
+    }
+
+    void drain(); // as much as every sink takes right now
+    void flush(); // everything, blocking; before a restart
+
+    // Runtime filter; calls compiled out by DRYER_LOG_LEVEL stay out
+    void     setLevel(LogLevel l) { level = l; }
+    LogLevel getLevel() const     { return level; }
+
+    bool addSink(LogSink* sink);  // false if all MAX_SINKS slots are taken
+    void removeSink(LogSink* sink);
+
+    uint16_t queued()  const { return stored; }  // bytes waiting
+    uint32_t dropped() const { return droppedTotal; }
+
+    // Message text of a record, format string applied
+    static size_t format(const uint8_t* record, char* out, size_t size);
+
+    static LogLevel    levelOf(const uint8_t* record) { return (LogLevel)record[1]; }
+    static uint32_t    millisOf(const uint8_t* record);
+    static const char* levelName(LogLevel l);
+    static bool        levelFromName(const char* name, LogLevel& l);
+
+    // Conversions in a format string, checked against the argument count
+    static constexpr uint8_t conversions(const char* f) {
+        uint8_t n = 0;
+        for (; *f; f++) {
+            if (*f != '%') continue;
+            if (f[1] == '%') f++;
+            else             n++;
+        }
+        return n;
+    }
+
+private:
+    uint8_t  ring[SIZE];
+    uint16_t head;        // next byte written
+    uint16_t tail;        // oldest record
+    uint16_t stored;
+    uint16_t droppedSince; // not yet reported
+    uint32_t droppedTotal;
+    LogLevel level;
+    LogSink* sinks[MAX_SINKS];
+
+    void    commit(uint8_t* record, uint8_t size, LogLevel at, const char* format);
+    void    push(const uint8_t* record, uint8_t size);
+    uint8_t peek(uint8_t* record) const;
+    void    pump(bool all);
+
+    static void putWord(uint8_t* record, uint8_t& size, char tag, const void* value);
+    static void putString(uint8_t* record, uint8_t& size, const char* s);
+
+    template <typename T>
+    static void put(uint8_t* record, uint8_t& size, T value) {
+        if constexpr (std::is_floating_point<T>::value) {
+            float f = static_cast<float>(value);
+            putWord(record, size, 'f', &f);
+        } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            int32_t i = static_cast<int32_t>(value);
+            putWord(record, size, 'i', &i);
+        } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+            uint32_t u = static_cast<uint32_t>(value);
+            putWord(record, size, 'u', &u);
+        } else {
+            static_assert(std::is_convertible<T, const char*>::value,
+                          "log arguments are numbers and C strings");
+            putString(record, size, value);
+        }
+    }
+};
+
+// Plain text on the UART, "   12.345 I message"; only what fits the TX FIFO
+// is written per drain, so logging rarely waits for the wire. A line longer
+// than the FIFO goes out once it is empty, blocking for the rest.
+class SerialLogSink : public LogSink {
+public:
+    bool ready(size_t length) override;
+    void write(const uint8_t* record, const char* text, size_t length) override;
+
+    static constexpr uint8_t PREFIX  = 13;
+    static constexpr uint8_t TX_FIFO = 128; // hardware FIFO, both chips
+};
+
+extern LogBuffer log_buffer;
+
+// Number of macro arguments, 0..12
+#define LOG_ARGC(...) LOG_ARGC_(0, ##__VA_ARGS__, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_ARGC_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, n, ...) n
+
+#define LOG_AT(level, fmt, ...)                                                     \
+    do {                                                                            \
+        static_assert(LogBuffer::conversions(fmt) == LOG_ARGC(__VA_ARGS__),         \
+                      "log format does not match its arguments");                   \
+        log_buffer.write(level, PSTR(fmt), ##__VA_ARGS__);                          \
+    } while (0)
+
+#define LOG_NONE(fmt, ...) \
+    do { if (false) log_buffer.write(LogLevel::DEBUG, fmt, ##__VA_ARGS__); } while (0)
+
+#if DRYER_LOG_LEVEL >= 1
+#define LOG_ERROR(...) LOG_AT(LogLevel::ERR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) LOG_NONE(__VA_ARGS__)
+#endif
+
+#if DRYER_LOG_LEVEL >= 2
+#define LOG_WARN(...) LOG_AT(LogLevel::WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) LOG_NONE(__VA_ARGS__)
+#endif
+
+#if DRYER_LOG_LEVEL >= 3
+#define LOG_INFO(...) LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) LOG_NONE(__VA_ARGS__)
+#endif
+
+#if DRYER_LOG_LEVEL >= 4
+#define LOG_DEBUG(...) LOG_AT(LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) LOG_NONE(__VA_ARGS__)
+#endif
+
+#endif // LOG_HPP
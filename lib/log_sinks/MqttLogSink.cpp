@@ -0,0 +1,24 @@
+#include "MqttLogSink.hpp"
+
+constexpr uint8_t MqttLogSink::BATCH;
+
+static_assert(LogBuffer::MAX_RECORD <= MqttLogSink::BATCH, "a record must fit one batch");
+
+MqttLogSink::MqttLogSink(MqttPublisher& client, Topics& topics)
+    : client(client), topics(topics), used(0)
+{}
+
+void MqttLogSink::write(const uint8_t* record, const char* text, size_t length) {
+    (void)text;
+    (void)length;
+    uint8_t size = record[0];
+    if (used + size > BATCH) flush();
+    memcpy(batch + used, record, size);
+    used += size;
+}
+
+void MqttLogSink::flush() {
+    if (!used) return;
+    if (client.connected()) client.publish(topics.tele("log"), batch, used);
+    used = 0;
+}
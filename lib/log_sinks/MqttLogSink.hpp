@@ -0,0 +1,31 @@
+#ifndef MQTT_LOG_SINK_HPP
+#define MQTT_LOG_SINK_HPP
+
+#include <Arduino.h>
+#include <MqttPublisher.hpp>
+#include <Log.hpp>
+#include <Topics.hpp>
+
+// Drained records, still binary, batched onto tele/<device>/log: one publish
+// per drain pass or per BATCH bytes. Payloads are back-to-back records as
+// described in Log.hpp; host/log/decode_log.py turns them into text using
+// the firmware ELF for the format strings. Records are dropped while the
+// broker is unreachable (Serial still has them).
+class MqttLogSink : public LogSink {
+public:
+    MqttLogSink(MqttPublisher& client, Topics& topics);
+
+    void write(const uint8_t* record, const char* text, size_t length) override;
+    void flush() override;
+
+    // Leaves room for topic and MQTT header in PubSubClient's default 256-byte buffer
+    static constexpr uint8_t BATCH = 192;
+
+private:
+    MqttPublisher& client;
+    Topics&        topics;
+    uint8_t        batch[BATCH];
+    uint8_t        used;
+};
+
+#endif // MQTT_LOG_SINK_HPP
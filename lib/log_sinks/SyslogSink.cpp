@@ -0,0 +1,50 @@
+#include "SyslogSink.hpp"
+
+constexpr uint16_t SyslogSink::DEFAULT_PORT;
+
+static constexpr uint8_t FACILITY_LOCAL0 = 16;
+
+SyslogSink::SyslogSink(Topics& topics)
+    : topics(topics), port(DEFAULT_PORT)
+{}
+
+bool SyslogSink::begin(const char* server) {
+    char host[64];
+    strncpy(host, server, sizeof(host) - 1);
+    host[sizeof(host) - 1] = '\0';
+
+    port = DEFAULT_PORT;
+    char* colon = strchr(host, ':');
+    if (colon) {
+        *colon = '\0';
+        port   = atoi(colon + 1);
+        if (!port) return false;
+    }
+    if (!address.fromString(host) && !WiFi.hostByName(host, address)) return false;
+    return true;
+}
+
+void SyslogSink::write(const uint8_t* record, const char* text, size_t length) {
+    // <PRI>VERSION TIMESTAMP HOSTNAME APP-NAME PROCID MSGID SD MSG; the
+    // receiver stamps the time, the box has no reliable clock
+    char packet[LogBuffer::MAX_TEXT + Topics::MAX_NAME + 32];
+    int  n = snprintf(packet, sizeof(packet), "<%u>1 - %s dryer - - - %.*s",
+                      FACILITY_LOCAL0 * 8 + severity(LogBuffer::levelOf(record)),
+                      topics.device(), (int)length, text);
+    if (n <= 0) return;
+    if ((size_t)n >= sizeof(packet)) n = sizeof(packet) - 1;
+
+    udp.beginPacket(address, port);
+    udp.write(reinterpret_cast<const uint8_t*>(packet), n);
+    udp.endPacket();
+}
+
+uint8_t SyslogSink::severity(LogLevel level) {
+    switch (level) {
+        case LogLevel::ERR:   return 3;
+        case LogLevel::WARN:  return 4;
+        case LogLevel::INFO:  return 6;
+        case LogLevel::DEBUG: return 7;
+    }
+    return 6;
+}
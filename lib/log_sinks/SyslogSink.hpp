@@ -0,0 +1,32 @@
+#ifndef SYSLOG_SINK_HPP
+#define SYSLOG_SINK_HPP
+
+#include <Arduino.h>
+#include <Platform.hpp>
+#include <WiFiUdp.h>
+#include <Log.hpp>
+#include <Topics.hpp>
+
+// Drained log lines as RFC 5424 syslog datagrams (facility local0), one per
+// record, hostname = device name. UDP never blocks, so it is always ready.
+class SyslogSink : public LogSink {
+public:
+    explicit SyslogSink(Topics& topics);
+
+    // "host" or "host:port" (default 514); resolved once here
+    bool begin(const char* server);
+
+    void write(const uint8_t* record, const char* text, size_t length) override;
+
+    static constexpr uint16_t DEFAULT_PORT = 514;
+
+private:
+    Topics&   topics;
+    WiFiUDP   udp;
+    IPAddress address;
+    uint16_t  port;
+
+    static uint8_t severity(LogLevel level);
+};
+
+#endif // SYSLOG_SINK_HPP
@@ -1,39 +1,210 @@
 #include "Mqtt.hpp"
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+#include <time.h>
+#include <MqttPublisher.hpp>
+#include <Log.hpp>
 
-WiFiClient   espClient;
-PubSubClient mqtt_client(espClient);
+#if defined(ESP32)
+#include <WiFiClientSecure.h>
+WiFiClientSecure          tlsClient;
+#else
+BearSSL::WiFiClientSecure tlsClient;
+#endif
+WiFiClient                plainClient;
+PubSubClient              mqtt_client;
 
 // Retained so reconnectToBroker() can re-use them without re-passing through main
 static NetworkCredentials storedCreds;
 
+static TlsPolicy          tlsPolicy;
+static BrokerLink         lastLink = {};
+
+// One connect attempt must stay well inside the safety supervisor's sensor
+// staleness limit (30 s): the loop reads no sensor while it runs
+static constexpr uint32_t RETRY_MS          = 5000;
+static constexpr uint16_t CONNACK_TIMEOUT_S = 5;  // PubSubClient default 15
+static uint32_t           lastAttempt       = 0;
+
+// Certificate validity dates need the wall clock
+static void waitForClock() {
+    uint32_t start = millis();
+    while (time(nullptr) < 1600000000 && millis() - start < tlsPolicy.clockWaitMs) delay(100);
+    if (time(nullptr) < 1600000000) LOG_WARN("MQTT | no NTP time yet for certificate validation");
+}
+
+#if defined(ESP32)
+static String brokerPem; // setCACert() keeps the pointer, so it lives here
+
+static bool setupTls(const NetworkCredentials& creds) {
+    if (!brokerPem.length() && LittleFS.exists(BROKER_CERT_FILE)) {
+        File f = LittleFS.open(BROKER_CERT_FILE, "r");
+        brokerPem = f.readString();
+        f.close();
+    }
+    if (!brokerPem.length()) {
+        // No SHA-1 pinning in the ESP32 client before the handshake
+        LOG_ERROR("MQTT | TLS on the ESP32 needs %s, not connecting", BROKER_CERT_FILE);
+        return false;
+    }
+    tlsClient.setCACert(brokerPem.c_str());
+    waitForClock();
+    return true;
+}
+#else
+static BearSSL::Session   tlsSession;          // survives reconnects, not reboots
+static BearSSL::X509List* brokerCert = nullptr; // loaded once
+static bool               fragmentProbed = false;
+
+// Pins the broker and sizes the buffers; false if TLS cannot be set up safely
+static bool setupTls(const NetworkCredentials& creds) {
+    if (!brokerCert && LittleFS.exists(BROKER_CERT_FILE)) {
+        File   f   = LittleFS.open(BROKER_CERT_FILE, "r");
+        String pem = f.readString();
+        f.close();
+        brokerCert = new BearSSL::X509List(pem.c_str());
+        if (!brokerCert->getCount()) {
+            LOG_ERROR("MQTT | %s holds no certificate", BROKER_CERT_FILE);
+            delete brokerCert;
+            brokerCert = nullptr;
+        }
+    }
+
+    if (brokerCert) {
+        // BearSSL matches the broker address against DNS names and CN only, so
+        // a broker dialled by IP needs that IP as a DNS name in its certificate
+        tlsClient.setTrustAnchors(brokerCert);
+        waitForClock();
+        if (time(nullptr) >= 1600000000) tlsClient.setX509Time(time(nullptr));
+    } else if (creds.brokerFingerprint.length()) {
+        if (!tlsClient.setFingerprint(creds.brokerFingerprint.c_str())) {
+            LOG_ERROR("MQTT | broker fingerprint is not 20 hex bytes");
+            return false;
+        }
+    } else {
+        LOG_ERROR("MQTT | TLS without %s or a fingerprint, not connecting", BROKER_CERT_FILE);
+        return false;
+    }
+
+    // Probed until a connect succeeds; the answer is kept for reconnects
+    if (!fragmentProbed) {
+        lastLink.fragmentOk = BearSSL::WiFiClientSecure::probeMaxFragmentLength(
+            creds.brokerIP.c_str(), creds.brokerPort, tlsPolicy.fragmentLength);
+    }
+    lastLink.rxBuffer = lastLink.fragmentOk ? tlsPolicy.fragmentLength : tlsPolicy.fallbackRx;
+    lastLink.txBuffer = tlsPolicy.tx;
+    tlsClient.setBufferSizes(lastLink.rxBuffer, lastLink.txBuffer);
+    tlsClient.setSession(&tlsSession);
+    return true;
+}
+#endif
+
+static void publishLink() {
+    StaticJsonDocument<256> doc;
+    doc["tls"]       = lastLink.tls;
+    doc["connectMs"] = lastLink.connectMs;
+    doc["heapPeak"]  = lastLink.heapPeak;
+    doc["freeHeap"]  = lastLink.heapBefore - lastLink.heapPeak; // low point during the connect
+    doc["connects"]  = lastLink.connects;
+    if (lastLink.tls) {
+        doc["resumed"]    = lastLink.resumed;
+        doc["fragmentOk"] = lastLink.fragmentOk;
+        doc["rxBuffer"]   = lastLink.rxBuffer;
+        doc["txBuffer"]   = lastLink.txBuffer;
+    }
+    char buf[256];
+    serializeJson(doc, buf);
+    // Runs in the network task: the shared topic buffer belongs to control
+    char topic[Topics::MAX_TOPIC];
+    mqtt_client.publish(mqtt_topics.tele(topic, sizeof(topic), "broker"), buf, true);
+}
+
+// A single attempt: TLS setup, TCP + handshake, MQTT CONNECT, subscriptions
+static bool tryConnect() {
+    const NetworkCredentials& creds = storedCreds;
+    lastAttempt = millis();
+    LOG_INFO("MQTT | connecting to broker as %s%s", mqtt_topics.device(),
+             lastLink.tls ? " over TLS" : "");
+
+    if (lastLink.tls && !setupTls(creds)) return false;
+
+#if !defined(ESP32)
+    // BearSSL::Session is plain data; an unchanged, non-empty one after
+    // the handshake means the broker resumed it
+    uint8_t session[sizeof(tlsSession)];
+    memcpy(session, &tlsSession, sizeof(session));
+    bool hadSession = false;
+    for (uint8_t b : session) hadSession |= b != 0;
+#endif
+
+    lastLink.heapBefore = platform::heapLowReset();
+    uint32_t start  = millis();
+
+    // The device name doubles as client ID so the broker sees one stable identity
+    bool connected = mqtt_client.connect(mqtt_topics.device(),
+                                         creds.brokerUser.c_str(),
+                                         creds.brokerPassword.c_str());
+    lastLink.connectMs = millis() - start;
+    lastLink.heapPeak  = lastLink.heapBefore - platform::heapLow();
+
+    if (!connected) {
+        LOG_WARN("MQTT | connect failed, rc=%d, retrying in 5 s", mqtt_client.state());
+        if (lastLink.tls) {
+            char error[64];
+#if defined(ESP32)
+            int  code = tlsClient.lastError(error, sizeof(error));
+#else
+            int  code = tlsClient.getLastSSLError(error, sizeof(error));
+#endif
+            if (code) LOG_WARN("MQTT | TLS error %d: %s", code, error);
+        }
+        return false;
+    }
+
+#if !defined(ESP32)
+    lastLink.resumed = lastLink.tls && hadSession && !memcmp(session, &tlsSession, sizeof(session));
+    fragmentProbed   = lastLink.tls;
+#endif
+    lastLink.connects++;
+    LOG_INFO("MQTT | connected in %u ms, peak heap %u B%s", lastLink.connectMs, lastLink.heapPeak,
+             lastLink.resumed ? ", session resumed" : "");
+    // QoS 1 so the broker retries unacknowledged commands; command
+    // ids keep a redelivery from being applied twice
+    for (uint8_t i = 0; i < mqtt_topics.subscriptionCount(); i++) {
+        mqtt_client.subscribe(mqtt_topics.subscription(i), 1);
+    }
+    publishLink();
+    return true;
+}
+
 void connectToBroker(const NetworkCredentials& creds) {
+    // Copied once; reconnects only read it, so they allocate nothing of ours
     storedCreds = creds;
-    mqtt_client.setServer(creds.brokerIP.c_str(), creds.brokerPort);
-
-    while (!mqtt_client.connected()) {
-        String client_id = "dryer-" + String(random(0xffff), HEX);
-        Serial.print("Connecting to MQTT broker...");
-
-        if (mqtt_client.connect(client_id.c_str(),
-                                creds.brokerUser.c_str(),
-                                creds.brokerPassword.c_str())) {
-            Serial.println("connected");
-            mqtt_client.subscribe("cmnd/dryer/filament");
-            mqtt_client.subscribe("cmnd/dryer/heater");
-            mqtt_client.subscribe("cmnd/dryer/fan");
-            mqtt_client.subscribe("cmnd/dryer/config");
-            mqtt_client.subscribe("cmnd/dryer/control");
-        } else {
-            Serial.print("failed, rc=");
-            Serial.print(mqtt_client.state());
-            Serial.println(" — retrying in 5s");
-            delay(5000);
-        }
+    lastLink.tls    = storedCreds.brokerTls;
+    if (lastLink.tls) mqtt_client.setClient(tlsClient);
+    else          mqtt_client.setClient(plainClient);
+    mqtt_client.setServer(storedCreds.brokerIP.c_str(), storedCreds.brokerPort);
+    mqtt_client.setSocketTimeout(CONNACK_TIMEOUT_S);
+
+    if (storedCreds.deviceName.length() > 0) {
+        mqtt_topics.begin(storedCreds.deviceName.c_str(), storedCreds.group.c_str());
+    } else {
+        char chipName[16];
+        snprintf(chipName, sizeof(chipName), "dryer-%06x", platform::chipId());
+        mqtt_topics.begin(chipName, storedCreds.group.c_str());
+    }
+    // Nothing runs yet that needs the loop (no task, no heater): wait here
+    while (!tryConnect()) {
+        log_buffer.drain();
+        delay(RETRY_MS);
     }
 }
 
 void reconnectToBroker() {
-    if (!mqtt_client.connected()) {
-        connectToBroker(storedCreds);
-    }
+    if (mqtt_client.connected() || millis() - lastAttempt < RETRY_MS) return;
+    tryConnect();
+}
+
+const BrokerLink& brokerLink() {
+    return lastLink;
 }
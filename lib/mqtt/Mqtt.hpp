@@ -2,12 +2,47 @@
 #define MQTT_HPP
 
 #include <PubSubClient.h>
-#include <ESP8266WiFi.h>
+#include <Platform.hpp>
 #include <NetworkCredentials.hpp>
+#include <Topics.hpp>
 
 extern PubSubClient mqtt_client;
 
+// TLS tunables (ESP8266). BearSSL needs a receive buffer as large as the
+// biggest record the broker may send: 16 KB unless the broker agrees to a
+// smaller maximum fragment length (RFC 6066) when probed once at the first
+// connect. The ESP32 core's mbedTLS client sizes its own buffers.
+struct TlsPolicy {
+    uint16_t fragmentLength = 1024;      // asked for; both buffers when granted
+    uint16_t fallbackRx     = 16384 + 325; // full record + BearSSL overhead
+    uint16_t tx             = 512;       // our records only, any size works
+    uint32_t clockWaitMs    = 5000;      // NTP, for certificate validity dates
+};
+
+// Cost of the last broker connect, published on tele/<device>/broker
+struct BrokerLink {
+    bool     tls;
+    bool     resumed;      // TLS session reused, no full handshake
+    bool     fragmentOk;   // broker accepted TlsPolicy::fragmentLength
+    uint16_t rxBuffer;     // 0 on the ESP32: the core's own
+    uint16_t txBuffer;
+    uint32_t connectMs;    // TCP + TLS handshake + MQTT CONNECT
+    uint32_t heapBefore;
+    uint32_t heapPeak;     // most heap in use beyond heapBefore during the connect
+    uint32_t connects;     // since boot
+};
+
+// Also configures mqtt_topics from the credentials' device name and group.
+// With creds.brokerTls the broker must be pinned by a certificate in
+// BROKER_CERT_FILE or by creds.brokerFingerprint; the session is cached for
+// the next reconnect. The ESP32 accepts only the certificate and always does
+// a full handshake.
+// Blocks until connected; for setup() only.
 void connectToBroker(const NetworkCredentials& creds);
-void reconnectToBroker(); // uses credentials from the last connectToBroker call
+// Uses the credentials from connectToBroker(). Never blocks beyond a single
+// attempt, and makes at most one every 5 s: call it every pass while down.
+void reconnectToBroker();
+
+const BrokerLink& brokerLink();
 
 #endif // MQTT_HPP
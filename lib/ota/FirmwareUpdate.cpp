@@ -0,0 +1,300 @@
+#include "FirmwareUpdate.hpp"
+#include <ArduinoJson.h>
+#if defined(ESP32)
+#include <HTTPClient.h>
+#include <Update.h>
+#else
+#include <ESP8266HTTPClient.h>
+#include <Updater.h>
+#endif
+#include <Platform.hpp>
+#include <RtcSlots.hpp>
+#include <Log.hpp>
+#include <algorithm>
+
+constexpr size_t   FirmwareUpdate::MAX_URL;
+constexpr uint32_t FirmwareUpdate::CHECK_INTERVAL_MS;
+constexpr uint32_t FirmwareUpdate::FIRST_CHECK_MS;
+constexpr uint32_t FirmwareUpdate::HTTP_TIMEOUT_MS;
+constexpr uint32_t FirmwareUpdate::INSTALL_MAGIC;
+constexpr size_t   FirmwareUpdate::ERROR_SIZE;
+
+FirmwareUpdate::FirmwareUpdate(DryerZone* zones, uint8_t zoneCount, MqttPublisher& client,
+                               Topics& topics)
+    : zones(zones), zoneCount(zoneCount), client(client), topics(topics),
+      pending(false), force(false), quiet(false), waitReported(false), lastCheck(0),
+      installed(false), record()
+{
+    manifestUrl[0] = requestUrl[0] = '\0';
+}
+
+void FirmwareUpdate::begin(const char* url) {
+    snprintf(manifestUrl, sizeof(manifestUrl), "%s", url ? url : "");
+    // First periodic check FIRST_CHECK_MS after boot rather than right away
+    lastCheck = millis() - CHECK_INTERVAL_MS + FIRST_CHECK_MS;
+
+    platform::rtcRead(RTC_SLOT_OTA, &record, sizeof(record));
+    installed = record.magic == INSTALL_MAGIC && record.checksum == checksumOf(record);
+    InstallRecord empty = {};
+    platform::rtcWrite(RTC_SLOT_OTA, &empty, sizeof(empty));
+    if (installed) {
+        record.from[sizeof(record.from) - 1] = '\0';
+        LOG_INFO("OTA | running %s, updated from %s", FIRMWARE_VERSION, record.from);
+    }
+}
+
+bool FirmwareUpdate::request(const char* url, bool forced) {
+    const char* source = (url && url[0]) ? url : manifestUrl;
+    if (!source[0] || strlen(source) > MAX_URL) return false;
+
+    strcpy(requestUrl, source);
+    pending      = true;
+    force        = forced;
+    quiet        = false;
+    waitReported = false;
+    return true;
+}
+
+void FirmwareUpdate::update() {
+    if (installed && client.connected()) {
+        report("ok", FIRMWARE_VERSION, nullptr, record.from, record.bytes,
+               record.downloadMs, record.flashMs);
+        installed = false;
+    }
+
+    if (!pending && manifestUrl[0] && millis() - lastCheck >= CHECK_INTERVAL_MS) {
+        lastCheck = millis();
+        request(nullptr, false);
+        quiet = true; // only speak up if there is something newer
+    }
+    if (!pending || !client.connected()) return;
+
+    if (!heaterSafe()) {
+        if (!waitReported && !quiet) report("waiting", nullptr, "heater may run");
+        waitReported = true;
+        return;
+    }
+    pending = false;
+    run();
+}
+
+// The download and flash block loop() for tens of seconds: nothing may be
+// able to switch a heater on, and none may be on already
+bool FirmwareUpdate::heaterSafe() const {
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        DryerState state = zones[i].controller.getState();
+        if (state != DryerState::IDLE && state != DryerState::COOLING) return false;
+        if (zones[i].heaterRelay.getState()) return false;
+    }
+    return true;
+}
+
+void FirmwareUpdate::run() {
+    Manifest manifest;
+    char     error[ERROR_SIZE] = "";
+    if (!fetchManifest(manifest, error)) {
+        report("failed", nullptr, error);
+        return;
+    }
+
+    if (!force && compareVersions(manifest.version, FIRMWARE_VERSION) <= 0) {
+        LOG_INFO("OTA | %s is current (server has %s)", FIRMWARE_VERSION, manifest.version);
+        if (!quiet) report("current", manifest.version, nullptr);
+        return;
+    }
+
+    LOG_INFO("OTA | %s -> %s from %s", FIRMWARE_VERSION, manifest.version, manifest.url);
+    report("started", manifest.version, nullptr, FIRMWARE_VERSION, manifest.size);
+#if !DRYER_TASKS
+    client.loop(); // push the notice out before the socket goes quiet
+#endif
+
+    uint32_t downloadMs = 0, flashMs = 0;
+    if (!flash(manifest, downloadMs, flashMs, error)) {
+        LOG_ERROR("OTA | failed: %s", error);
+        report("failed", manifest.version, error, FIRMWARE_VERSION, manifest.size,
+               downloadMs, flashMs);
+        return;
+    }
+
+    InstallRecord rec = {};
+    rec.magic = INSTALL_MAGIC;
+    snprintf(rec.from, sizeof(rec.from), "%s", FIRMWARE_VERSION);
+    rec.bytes      = manifest.size;
+    rec.downloadMs = downloadMs;
+    rec.flashMs    = flashMs;
+    rec.checksum   = checksumOf(rec);
+    platform::rtcWrite(RTC_SLOT_OTA, &rec, sizeof(rec));
+
+    LOG_INFO("OTA | %u bytes, download %u ms, flash %u ms; restarting",
+             manifest.size, downloadMs, flashMs);
+    log_buffer.flush();
+    client.disconnect();
+    delay(100);
+    ESP.restart();
+}
+
+bool FirmwareUpdate::fetchManifest(Manifest& manifest, char* error) {
+    WiFiClient net;
+    HTTPClient http;
+    http.setTimeout(HTTP_TIMEOUT_MS);
+    if (!http.begin(net, requestUrl)) {
+        snprintf(error, ERROR_SIZE, "bad manifest url");
+        return false;
+    }
+
+    int code = http.GET();
+    if (code != HTTP_CODE_OK) {
+        snprintf(error, ERROR_SIZE, "manifest HTTP %d", code);
+        http.end();
+        return false;
+    }
+
+    StaticJsonDocument<384> doc;
+    DeserializationError parse = deserializeJson(doc, http.getStream());
+    http.end();
+    if (parse) {
+        snprintf(error, ERROR_SIZE, "manifest JSON %s", parse.c_str());
+        return false;
+    }
+
+    const char* version = doc["version"];
+    const char* url     = doc["url"];
+    const char* md5     = doc["md5"];
+    manifest.size       = doc["size"] | 0;
+    if (!version || !url || !md5 || strlen(md5) != 32 || strlen(url) > MAX_URL) {
+        snprintf(error, ERROR_SIZE, "manifest needs version, url, md5");
+        return false;
+    }
+    snprintf(manifest.version, sizeof(manifest.version), "%s", version);
+    strcpy(manifest.url, url);
+    strcpy(manifest.md5, md5);
+    return true;
+}
+
+static void updateError(char* error, size_t size) {
+#if defined(ESP32)
+    snprintf(error, size, "%s", Update.errorString());
+#else
+    snprintf(error, size, "%s", Update.getErrorString().c_str());
+#endif
+}
+
+// Streams the image into the update partition. Reads and flash writes
+// alternate, so their times are accounted separately as they happen.
+bool FirmwareUpdate::flash(Manifest& manifest, uint32_t& downloadMs, uint32_t& flashMs,
+                           char* error) {
+    WiFiClient net;
+    HTTPClient http;
+    http.setTimeout(HTTP_TIMEOUT_MS);
+    if (!http.begin(net, manifest.url)) {
+        snprintf(error, ERROR_SIZE, "bad image url");
+        return false;
+    }
+
+    uint32_t start = millis();
+    int      code  = http.GET();
+    if (code != HTTP_CODE_OK) {
+        snprintf(error, ERROR_SIZE, "image HTTP %d", code);
+        http.end();
+        return false;
+    }
+
+    int length = http.getSize();
+    if (length <= 0 || (manifest.size && (uint32_t)length != manifest.size)) {
+        snprintf(error, ERROR_SIZE, "image size %d, manifest %u", length, manifest.size);
+        http.end();
+        return false;
+    }
+    manifest.size = length;
+    if (!Update.begin(length) || !Update.setMD5(manifest.md5)) {
+        updateError(error, ERROR_SIZE);
+        http.end();
+        return false;
+    }
+
+    WiFiClient* stream    = http.getStreamPtr();
+    uint32_t    remaining = length;
+    uint32_t    lastData  = millis();
+    uint32_t    writeUs   = 0;
+    uint8_t     buffer[1024];
+
+    while (remaining > 0) {
+        size_t available = stream->available();
+        if (available == 0) {
+            if (!stream->connected() || millis() - lastData > HTTP_TIMEOUT_MS) {
+                snprintf(error, ERROR_SIZE, "download stalled with %u bytes left", remaining);
+                break;
+            }
+            delay(1);
+            continue;
+        }
+
+        size_t n = stream->readBytes(buffer, std::min({available, sizeof(buffer), (size_t)remaining}));
+        lastData = millis();
+
+        uint32_t t0 = micros();
+        if (Update.write(buffer, n) != n) {
+            updateError(error, ERROR_SIZE);
+            break;
+        }
+        writeUs   += micros() - t0;
+        remaining -= n;
+    }
+    http.end();
+
+    // end() verifies the MD5 and marks the image for the bootloader
+    uint32_t t0 = micros();
+    bool ok = !error[0] && Update.end();
+    writeUs += micros() - t0;
+    if (!ok && !error[0]) updateError(error, ERROR_SIZE);
+    if (!ok) Update.end(); // drops a half-written image
+
+    flashMs    = writeUs / 1000;
+    downloadMs = millis() - start - flashMs;
+    return ok;
+}
+
+void FirmwareUpdate::report(const char* result, const char* to, const char* error,
+                            const char* from, uint32_t bytes, uint32_t downloadMs,
+                            uint32_t flashMs) {
+    StaticJsonDocument<256> doc;
+    doc["result"] = result;
+    doc["from"]   = from;
+    if (to)         doc["to"]         = to;
+    if (error)      doc["error"]      = error;
+    if (bytes)      doc["bytes"]      = bytes;
+    if (downloadMs) doc["downloadMs"] = downloadMs;
+    if (flashMs)    doc["flashMs"]    = flashMs;
+
+    char buffer[256];
+    serializeJson(doc, buffer);
+    client.publish(topics.stat("ota"), buffer);
+}
+
+int FirmwareUpdate::compareVersions(const char* a, const char* b) {
+    for (int part = 0; part < 3; part++) {
+        char* endA;
+        char* endB;
+        long  x = strtol(a, &endA, 10);
+        long  y = strtol(b, &endB, 10);
+        if (x != y) return x < y ? -1 : 1;
+        a = endA;
+        b = endB;
+        if (*a == '.') a++;
+        if (*b == '.') b++;
+    }
+    // Same numbers: a pre-release suffix sorts before the release
+    bool suffixA = *a == '-', suffixB = *b == '-';
+    if (suffixA != suffixB) return suffixA ? -1 : 1;
+    return suffixA ? strcmp(a, b) : 0;
+}
+
+uint32_t FirmwareUpdate::checksumOf(const InstallRecord& rec) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&rec);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(InstallRecord, checksum); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
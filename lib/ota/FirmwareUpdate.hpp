@@ -0,0 +1,104 @@
+#ifndef FIRMWARE_UPDATE_HPP
+#define FIRMWARE_UPDATE_HPP
+
+#include <Arduino.h>
+#include <MqttPublisher.hpp>
+#include <DryerZone.hpp>
+#include <Topics.hpp>
+#include <Version.hpp>
+
+// Pulls firmware images from a local HTTP server.
+//
+// The server publishes a manifest next to the image:
+//   {"version": "0.4.0", "url": "http://nas/dryer/firmware-0.4.0.bin.gz",
+//    "md5": "<hex of the file as served>", "size": 312345}
+// Images are gzip-compressed; the ESP8266 bootloader inflates them when it
+// copies the new image into place, so only the compressed bytes cross WiFi
+// and get written to the update partition. The ESP32 bootloader does not,
+// so its images are served as they are built.
+//
+// An update is requested by cmnd/<device>/config {"action": "update"} or,
+// when a manifest URL is configured, by the periodic check. It only runs
+// while every zone is IDLE or COOLING with its heater relay off; otherwise it
+// stays pending and is retried each tick. Older or equal versions are
+// skipped unless forced. The MD5 from the manifest is checked before the new
+// image is accepted.
+//
+// Progress and failures go to stat/<device>/ota. A successful install
+// leaves its download and flash times in RTC memory and restarts; the new
+// image publishes them with its own version once MQTT is up, which doubles
+// as proof that it booted.
+class FirmwareUpdate {
+public:
+    FirmwareUpdate(DryerZone* zones, uint8_t zoneCount, MqttPublisher& client, Topics& topics);
+
+    // Early in setup(): picks up the record of an install that just finished.
+    // manifestUrl: configured default, may be empty (command-only updates)
+    void begin(const char* manifestUrl);
+
+    // Queue an update; url overrides the configured manifest. False if
+    // there is no manifest URL to use.
+    bool request(const char* url, bool force);
+
+    // Once per system tick: periodic check, and runs a pending update when safe
+    void update();
+
+    bool isPending() const { return pending; }
+
+    // <0 if a is older than b. "1.2.0-dev" is older than "1.2.0".
+    static int compareVersions(const char* a, const char* b);
+
+    static constexpr size_t   MAX_URL           = 128;
+    static constexpr uint32_t CHECK_INTERVAL_MS = 6UL * 60 * 60 * 1000;
+    static constexpr uint32_t FIRST_CHECK_MS    = 60000;
+    static constexpr uint32_t HTTP_TIMEOUT_MS   = 10000;
+
+private:
+    // Survives the restart into the new image (RTC_SLOT_OTA)
+    struct InstallRecord {
+        uint32_t magic;
+        char     from[16];
+        uint32_t bytes;
+        uint32_t downloadMs;
+        uint32_t flashMs;
+        uint32_t checksum;
+    };
+
+    struct Manifest {
+        char     version[24];
+        char     url[MAX_URL + 1];
+        char     md5[33];
+        uint32_t size;
+    };
+
+    DryerZone*     zones;
+    uint8_t        zoneCount;
+    MqttPublisher& client;
+    Topics&        topics;
+
+    char     manifestUrl[MAX_URL + 1];
+    char     requestUrl[MAX_URL + 1];
+    bool     pending;
+    bool     force;
+    bool     quiet;        // periodic check: report only an actual install
+    bool     waitReported; // "waiting for heater" sent once per request
+    uint32_t lastCheck;
+    bool     installed;    // InstallRecord waiting to be published
+    InstallRecord record;
+
+    bool heaterSafe() const;
+    void run();
+    // error: at least ERROR_SIZE bytes, set on failure
+    bool fetchManifest(Manifest& manifest, char* error);
+    bool flash(Manifest& manifest, uint32_t& downloadMs, uint32_t& flashMs, char* error);
+    void report(const char* result, const char* to, const char* error,
+                const char* from = FIRMWARE_VERSION, uint32_t bytes = 0,
+                uint32_t downloadMs = 0, uint32_t flashMs = 0);
+
+    static uint32_t checksumOf(const InstallRecord& rec);
+
+    static constexpr uint32_t INSTALL_MAGIC = 0x4F544131; // "OTA1"
+    static constexpr size_t   ERROR_SIZE    = 64;
+};
+
+#endif // FIRMWARE_UPDATE_HPP
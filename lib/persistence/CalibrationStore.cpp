@@ -0,0 +1,59 @@
+#include "CalibrationStore.hpp"
+#include <LittleFS.h>
+#include <Log.hpp>
+
+constexpr uint32_t CalibrationStore::MAGIC;
+
+bool CalibrationStore::load(uint8_t zone, Calibration& cal) {
+    char name[16];
+    fileName(name, sizeof(name), zone);
+    if (!LittleFS.exists(name)) return false;
+    File f = LittleFS.open(name, "r");
+    if (!f) return false;
+
+    Record rec;
+    size_t n = f.read(reinterpret_cast<uint8_t*>(&rec), sizeof(rec));
+    f.close();
+    if (n != sizeof(rec) || rec.magic != MAGIC || rec.checksum != checksumOf(rec) ||
+        !cal.temperature.set(rec.temperature, rec.temperatureCount) ||
+        !cal.humidity.set(rec.humidity, rec.humidityCount)) {
+        LOG_WARN("CALIBRATION | %s invalid, ignored", name);
+        cal = Calibration();
+        return false;
+    }
+    LOG_INFO("CALIBRATION | zone %u: %u temperature, %u humidity points", zone + 1,
+             rec.temperatureCount, rec.humidityCount);
+    return true;
+}
+
+bool CalibrationStore::save(uint8_t zone, const Calibration& cal) {
+    Record rec = {};
+    rec.magic            = MAGIC;
+    rec.temperatureCount = cal.temperature.count();
+    rec.humidityCount    = cal.humidity.count();
+    for (uint8_t i = 0; i < rec.temperatureCount; i++) rec.temperature[i] = cal.temperature.point(i);
+    for (uint8_t i = 0; i < rec.humidityCount; i++)    rec.humidity[i]    = cal.humidity.point(i);
+    rec.checksum = checksumOf(rec);
+
+    char name[16];
+    fileName(name, sizeof(name), zone);
+    File f = LittleFS.open(name, "w");
+    if (!f) return false;
+    bool ok = f.write(reinterpret_cast<const uint8_t*>(&rec), sizeof(rec)) == sizeof(rec);
+    f.close();
+    return ok;
+}
+
+void CalibrationStore::fileName(char* name, size_t size, uint8_t zone) {
+    snprintf(name, size, "/calib%u.dat", zone);
+}
+
+uint32_t CalibrationStore::checksumOf(const Record& rec) {
+    // FNV-1a over everything but the checksum field itself
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&rec);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(Record, checksum); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
@@ -0,0 +1,33 @@
+#ifndef CALIBRATION_STORE_HPP
+#define CALIBRATION_STORE_HPP
+
+#include <Arduino.h>
+#include <Calibration.hpp>
+
+// Keeps each zone's sensor calibration in /calib<zone>.dat, so it survives
+// reboots, firmware updates and a credentials reset. Written only when the
+// calibration is changed over MQTT.
+class CalibrationStore {
+public:
+    // Leaves cal untouched if there is no valid file
+    static bool load(uint8_t zone, Calibration& cal);
+    static bool save(uint8_t zone, const Calibration& cal);
+
+private:
+    struct Record {
+        uint32_t                magic;
+        uint8_t                 temperatureCount;
+        uint8_t                 humidityCount;
+        uint8_t                 reserved[2];
+        CalibrationTable::Point temperature[CalibrationTable::MAX_POINTS];
+        CalibrationTable::Point humidity[CalibrationTable::MAX_POINTS];
+        uint32_t                checksum;
+    };
+
+    static void     fileName(char* name, size_t size, uint8_t zone);
+    static uint32_t checksumOf(const Record& rec);
+
+    static constexpr uint32_t MAGIC = 0x43414C31; // "CAL1"
+};
+
+#endif // CALIBRATION_STORE_HPP
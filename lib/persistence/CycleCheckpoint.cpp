@@ -0,0 +1,151 @@
+#include "CycleCheckpoint.hpp"
+#include <LittleFS.h>
+#include <Log.hpp>
+#include <Platform.hpp>
+#include <time.h>
+
+constexpr uint32_t    CycleCheckpoint::MAGIC;
+constexpr uint32_t    CycleCheckpoint::FLASH_INTERVAL_MS;
+constexpr uint32_t    CycleCheckpoint::NTP_WAIT_MS;
+
+CycleCheckpoint::CycleCheckpoint(DryerController& dryer, HeaterSettings& heater,
+                                 uint8_t zone, ResumePolicy policy)
+    : dryer(dryer), heater(heater), policy(policy),
+      rtcOffset(RTC_SLOT_CHECKPOINT + RTC_CHECKPOINT_SIZE * zone),
+      flashActive(true), lastFlashWrite(0)
+{
+    static_assert(sizeof(Record) <= RTC_CHECKPOINT_SIZE * 4, "Record outgrew its RTC slot");
+    snprintf(fileName, sizeof(fileName), "/cycle%u.dat", zone);
+}
+
+bool CycleCheckpoint::restore() {
+    Record rec;
+    bool   fromRtc = readRtc(rec);
+    if (!fromRtc && !readFlash(rec)) {
+        clear();
+        return false;
+    }
+    if (!isActive(rec)) {
+        clear();
+        return false;
+    }
+
+    if (!fromRtc) {
+        // Power was lost: RTC memory is gone, so judge the outage by wall clock.
+        uint32_t start = millis();
+        while (rec.epoch && !wallClock() && millis() - start < NTP_WAIT_MS) {
+            delay(100);
+        }
+        uint32_t now = wallClock();
+        bool known   = rec.epoch && now && now >= rec.epoch;
+
+        if (known && now - rec.epoch > policy.maxOutageSec) {
+            LOG_WARN("CHECKPOINT | outage %us > %us, cycle abandoned",
+                     now - rec.epoch, policy.maxOutageSec);
+            clear();
+            return false;
+        }
+        if (!known && !policy.resumeIfOutageUnknown) {
+            LOG_WARN("CHECKPOINT | outage length unknown, cycle abandoned");
+            clear();
+            return false;
+        }
+    }
+
+    LOG_INFO("CHECKPOINT | resuming from %s: %u/%u min done",
+             fromRtc ? "RTC" : "flash",
+             rec.elapsed / 60000, rec.targetTime / 60000);
+    dryer.resumeCycle(static_cast<DryerState>(rec.state), rec.presetIndex,
+                      rec.targetTemp, rec.targetTime, rec.elapsed);
+    flashActive = !fromRtc; // an RTC resume may be newer than the flash copy
+    return true;
+}
+
+void CycleCheckpoint::update() {
+    Record rec = capture();
+    writeRtc(rec);
+
+    bool active = isActive(rec);
+    if (active != flashActive ||
+        (active && millis() - lastFlashWrite >= FLASH_INTERVAL_MS)) {
+        writeFlash(rec);
+    }
+}
+
+CycleCheckpoint::Record CycleCheckpoint::capture() const {
+    Record rec = {};
+    rec.magic       = MAGIC;
+    rec.state       = static_cast<uint8_t>(dryer.getState());
+    rec.presetIndex = dryer.getActivePreset();
+    rec.targetTemp  = heater.getTargetTemperature();
+    rec.targetTime  = heater.getTargetTime();
+    rec.elapsed     = heater.getElapsedTime();
+    rec.epoch       = wallClock();
+    return rec;
+}
+
+bool CycleCheckpoint::isActive(const Record& rec) const {
+    switch (static_cast<DryerState>(rec.state)) {
+        case DryerState::HEATING:
+        case DryerState::HOLDING:
+            return rec.targetTemp > 0 && rec.elapsed < rec.targetTime;
+        case DryerState::COOLING:
+        case DryerState::SAFETY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool CycleCheckpoint::readRtc(Record& rec) const {
+    if (!platform::rtcRead(rtcOffset, &rec, sizeof(rec))) return false;
+    return rec.magic == MAGIC && rec.checksum == checksumOf(rec);
+}
+
+bool CycleCheckpoint::readFlash(Record& rec) const {
+    if (!LittleFS.exists(fileName)) return false;
+    File f = LittleFS.open(fileName, "r");
+    if (!f) return false;
+    size_t n = f.read(reinterpret_cast<uint8_t*>(&rec), sizeof(rec));
+    f.close();
+    return n == sizeof(rec) && rec.magic == MAGIC && rec.checksum == checksumOf(rec);
+}
+
+void CycleCheckpoint::writeRtc(Record& rec) {
+    rec.checksum = checksumOf(rec);
+    platform::rtcWrite(rtcOffset, &rec, sizeof(rec));
+}
+
+void CycleCheckpoint::writeFlash(Record& rec) {
+    rec.checksum = checksumOf(rec);
+    File f = LittleFS.open(fileName, "w");
+    if (f) {
+        f.write(reinterpret_cast<const uint8_t*>(&rec), sizeof(rec));
+        f.close();
+    }
+    flashActive    = isActive(rec);
+    lastFlashWrite = millis();
+}
+
+void CycleCheckpoint::clear() {
+    Record rec = capture();
+    rec.state = static_cast<uint8_t>(DryerState::IDLE);
+    writeRtc(rec);
+    if (LittleFS.exists(fileName)) LittleFS.remove(fileName);
+    flashActive = false;
+}
+
+uint32_t CycleCheckpoint::checksumOf(const Record& rec) {
+    // FNV-1a over everything but the checksum field itself
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&rec);
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < offsetof(Record, checksum); i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+uint32_t CycleCheckpoint::wallClock() {
+    time_t now = time(nullptr);
+    return now > 1600000000 ? static_cast<uint32_t>(now) : 0; // 0 until NTP has synced
+}
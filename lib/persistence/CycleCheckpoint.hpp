@@ -0,0 +1,75 @@
+#ifndef CYCLE_CHECKPOINT_HPP
+#define CYCLE_CHECKPOINT_HPP
+
+#include <Arduino.h>
+#include <DryerController.hpp>
+#include <HeaterSettings.hpp>
+#include "RtcSlots.hpp"
+
+// Decides whether an interrupted cycle is picked up again after boot.
+// The outage length is only known when the checkpoint carries an NTP
+// timestamp and the clock is synced again at boot. Plain resets keep RTC
+// memory alive and always count as a zero-length outage.
+struct ResumePolicy {
+    uint32_t maxOutageSec          = 30 * 60; // abandon the cycle after longer outages
+    bool     resumeIfOutageUnknown = true;    // no wall clock on one side of the outage
+};
+
+// Persists the running cycle so a brownout or reset doesn't silently drop
+// an 8 h drying run.
+//
+// Every tick the record is mirrored into RTC user memory (a memcpy, survives
+// resets but not power loss). LittleFS only sees a write when a cycle starts
+// or ends and at most every FLASH_INTERVAL_MS in between, which keeps an
+// 8 h PC run under 100 flash writes and never blocks the tick for long.
+class CycleCheckpoint {
+public:
+    // zone selects the RTC slot and checkpoint file
+    CycleCheckpoint(DryerController& dryer, HeaterSettings& heater, uint8_t zone = 0,
+                    ResumePolicy policy = ResumePolicy());
+
+    // Call once after LittleFS is mounted and the sensor has been read.
+    // Returns true if an interrupted cycle was resumed.
+    bool restore();
+
+    // Call once per control tick, after DryerController::update().
+    void update();
+
+private:
+    struct Record {
+        uint32_t magic;
+        uint8_t  state;        // DryerState
+        uint8_t  presetIndex;  // DryerController::NO_PRESET if started without one
+        uint8_t  targetTemp;
+        uint8_t  reserved;
+        uint32_t targetTime;   // ms
+        uint32_t elapsed;      // ms of drying already done
+        uint32_t epoch;        // wall clock seconds at write time, 0 if unknown
+        uint32_t checksum;
+    };
+
+    DryerController& dryer;
+    HeaterSettings&  heater;
+    ResumePolicy     policy;
+    uint32_t         rtcOffset;
+    char             fileName[16];
+    bool             flashActive;    // what the flash copy currently says
+    uint32_t         lastFlashWrite;
+
+    Record capture() const;
+    bool   isActive(const Record& rec) const;
+    bool   readRtc(Record& rec) const;
+    bool   readFlash(Record& rec) const;
+    void   writeRtc(Record& rec);
+    void   writeFlash(Record& rec);
+    void   clear();
+
+    static uint32_t checksumOf(const Record& rec);
+    static uint32_t wallClock();
+
+    static constexpr uint32_t    MAGIC             = 0x44435031; // "DCP1"
+    static constexpr uint32_t    FLASH_INTERVAL_MS = 5UL * 60 * 1000;
+    static constexpr uint32_t    NTP_WAIT_MS       = 3000;
+};
+
+#endif // CYCLE_CHECKPOINT_HPP
@@ -0,0 +1,18 @@
+#ifndef RTC_SLOTS_HPP
+#define RTC_SLOTS_HPP
+
+#include <stdint.h>
+
+// RTC user memory (512 B) is shared between modules. Offsets are in 4-byte
+// blocks as expected by platform::rtcRead/rtcWrite.
+constexpr uint32_t RTC_SLOT_CHECKPOINT = 0;  // CycleCheckpoint::Record, 6 blocks per zone
+constexpr uint32_t RTC_CHECKPOINT_SIZE = 6;
+constexpr uint32_t RTC_MAX_ZONES       = 3;
+constexpr uint32_t RTC_SLOT_BREADCRUMB = 20; // LoopWatchdog breadcrumb, 4 blocks
+constexpr uint32_t RTC_SLOT_CRASH      = 24; // LoopWatchdog crash record, 8 blocks
+constexpr uint32_t RTC_SLOT_OTA        = 32; // FirmwareUpdate install record, 9 blocks
+
+static_assert(RTC_SLOT_CHECKPOINT + RTC_CHECKPOINT_SIZE * RTC_MAX_ZONES <= RTC_SLOT_BREADCRUMB,
+              "checkpoint slots overlap the watchdog breadcrumb");
+
+#endif // RTC_SLOTS_HPP
@@ -0,0 +1,121 @@
+#include "Platform.hpp"
+
+#if defined(ESP32)
+#include <esp_heap_caps.h>
+#include <esp_system.h>
+#include <esp_attr.h>
+#else
+#include <umm_malloc/umm_malloc.h>
+#endif
+
+namespace platform {
+
+#if defined(ESP32)
+
+static constexpr size_t RTC_BLOCKS = 128;
+RTC_NOINIT_ATTR static uint32_t rtcMemory[RTC_BLOCKS];
+static uint32_t heapMark = 0;
+
+bool rtcRead(uint32_t block, void* data, size_t size) {
+    if (block * 4 + size > sizeof(rtcMemory)) return false;
+    memcpy(data, rtcMemory + block, size);
+    return true;
+}
+
+bool rtcWrite(uint32_t block, const void* data, size_t size) {
+    if (block * 4 + size > sizeof(rtcMemory)) return false;
+    memcpy(rtcMemory + block, data, size);
+    return true;
+}
+
+uint32_t chipId() {
+    // Lower half of the factory MAC, like the ESP8266's chip id
+    uint64_t mac = ESP.getEfuseMac();
+    return ((mac >> 40) & 0xFF) | ((mac >> 24) & 0xFF00) | ((mac >> 8) & 0xFF0000);
+}
+
+uint8_t resetReason() {
+    switch (esp_reset_reason()) {
+        case ESP_RST_INT_WDT:
+        case ESP_RST_WDT:       return REASON_WDT_RST;
+        case ESP_RST_PANIC:     return REASON_EXCEPTION_RST;
+        case ESP_RST_TASK_WDT:  return REASON_SOFT_WDT_RST;
+        case ESP_RST_SW:        return REASON_SOFT_RESTART;
+        case ESP_RST_DEEPSLEEP: return REASON_DEEP_SLEEP_AWAKE;
+        case ESP_RST_EXT:       return REASON_EXT_SYS_RST;
+        default:                return REASON_DEFAULT_RST;
+    }
+}
+
+HeapStats heapStats() {
+    HeapStats s;
+    s.freeHeap      = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    s.maxBlock      = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    s.fragmentation = s.freeHeap ? 100 - s.maxBlock * 100 / s.freeHeap : 0;
+    return s;
+}
+
+uint32_t freeHeap() {
+    return ESP.getFreeHeap();
+}
+
+uint32_t stackFree() {
+    return uxTaskGetStackHighWaterMark(nullptr); // bytes on the ESP32
+}
+
+uint32_t heapLowReset() {
+    heapMark = ESP.getFreeHeap();
+    return heapMark;
+}
+
+uint32_t heapLow() {
+    uint32_t now = ESP.getFreeHeap();
+    return now < heapMark ? now : heapMark;
+}
+
+#else
+
+bool rtcRead(uint32_t block, void* data, size_t size) {
+    return ESP.rtcUserMemoryRead(block, static_cast<uint32_t*>(data), size);
+}
+
+bool rtcWrite(uint32_t block, const void* data, size_t size) {
+    return ESP.rtcUserMemoryWrite(block, static_cast<uint32_t*>(const_cast<void*>(data)), size);
+}
+
+uint32_t chipId() {
+    return ESP.getChipId();
+}
+
+uint8_t resetReason() {
+    return ESP.getResetInfoPtr()->reason;
+}
+
+HeapStats heapStats() {
+    // One call so free heap, max block and fragmentation describe the same moment
+    HeapStats s;
+    uint16_t  block16;
+    ESP.getHeapStats(&s.freeHeap, &block16, &s.fragmentation);
+    s.maxBlock = block16;
+    return s;
+}
+
+uint32_t freeHeap() {
+    return ESP.getFreeHeap();
+}
+
+uint32_t stackFree() {
+    return ESP.getFreeContStack();
+}
+
+uint32_t heapLowReset() {
+    return umm_free_heap_size_min_reset();
+}
+
+uint32_t heapLow() {
+    return umm_free_heap_size_min();
+}
+
+#endif
+
+} // namespace platform
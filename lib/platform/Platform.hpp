@@ -0,0 +1,59 @@
+#ifndef PLATFORM_HPP
+#define PLATFORM_HPP
+
+#include <Arduino.h>
+
+// The few chip services that differ between the ESP8266 and ESP32 cores.
+// Everything else (LittleFS, WiFiClient, ESP.restart(), ...) has the same
+// shape on both and is used directly.
+#if defined(ESP32)
+#include <WiFi.h>
+
+// Reset causes in the ESP8266's rst_info numbering, which is what
+// resetReason() reports on both chips (and what tele/<device>/crash carries)
+enum {
+    REASON_DEFAULT_RST      = 0, // power on, brown-out
+    REASON_WDT_RST          = 1, // hardware / interrupt watchdog
+    REASON_EXCEPTION_RST    = 2, // panic
+    REASON_SOFT_WDT_RST     = 3, // task watchdog
+    REASON_SOFT_RESTART     = 4,
+    REASON_DEEP_SLEEP_AWAKE = 5,
+    REASON_EXT_SYS_RST      = 6
+};
+#else
+#include <ESP8266WiFi.h>
+#include <user_interface.h>
+#endif
+
+namespace platform {
+
+// RTC memory that survives resets but not power loss: the ESP8266's 512 B of
+// user memory, a no-init RTC array of the same size on the ESP32. Offsets are
+// in 4-byte blocks (RtcSlots.hpp).
+bool rtcRead(uint32_t block, void* data, size_t size);
+bool rtcWrite(uint32_t block, const void* data, size_t size);
+
+uint32_t chipId();       // 24 bits on both, for "dryer-xxxxxx"
+uint8_t  resetReason();  // REASON_*
+
+struct HeapStats {
+    uint32_t freeHeap;
+    uint32_t maxBlock;      // largest allocation that would succeed
+    uint8_t  fragmentation; // percent
+};
+HeapStats heapStats();
+uint32_t  freeHeap();
+
+// Bytes of stack never touched by the calling loop (ESP8266) or task (ESP32)
+uint32_t stackFree();
+
+// Lowest free heap since heapLowReset(), which returns the current free heap.
+// Exact on the ESP8266 (umm_malloc tracks it); on the ESP32 the allocator
+// only keeps a lifetime minimum, so this is the free heap at the time of the
+// call, i.e. a lower bound on what was in use in between.
+uint32_t heapLowReset();
+uint32_t heapLow();
+
+} // namespace platform
+
+#endif // PLATFORM_HPP
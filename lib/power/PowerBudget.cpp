@@ -0,0 +1,229 @@
+#include "PowerBudget.hpp"
+#include <ArduinoJson.h>
+#include <Log.hpp>
+
+constexpr uint8_t PowerBudget::MAX_PEERS;
+constexpr size_t  PowerBudget::MAX_NAME;
+
+PowerBudget::PowerBudget(MqttPublisher& client, PowerPolicy policy)
+    : client(client), policy(policy), peerCount(0), state(LeaseState::IDLE), ticket(0),
+      maxTicket(0), stateSince(0), lastDemand(0), demandSeen(false), warmingUp(false),
+      lastPublish(0), lastEcho(0), listenUntil(0), untrackedAt(0), untrackedMs(0), wasConnected(false)
+{
+    node[0] = topicPrefix[0] = filter[0] = ownTopic[0] = '\0';
+}
+
+void PowerBudget::begin(const char* circuit, const char* nodeName, uint8_t limit) {
+    policy.limit = limit;
+    strncpy(node, nodeName, MAX_NAME);
+    node[MAX_NAME] = '\0';
+    snprintf(topicPrefix, sizeof(topicPrefix), "power/%.*s/", (int)MAX_NAME, circuit);
+    snprintf(filter, sizeof(filter), "%s+", topicPrefix);
+    snprintf(ownTopic, sizeof(ownTopic), "%s%s", topicPrefix, node);
+    listenUntil = millis() + policy.leaseTtlMs;
+}
+
+bool PowerBudget::handle(const char* topic, const byte* payload, unsigned int length) {
+    if (!enabled()) return false;
+    size_t prefixLen = strlen(topicPrefix);
+    if (strncmp(topic, topicPrefix, prefixLen) != 0) return false;
+
+    const char* name = topic + prefixLen;
+    if (!*name || strlen(name) > MAX_NAME) return true;
+
+    // Our own announcement made the round trip through the broker
+    if (strcmp(name, node) == 0) {
+        lastEcho = millis();
+        return true;
+    }
+
+    StaticJsonDocument<128> doc;
+    if (deserializeJson(doc, payload, length)) return true;
+
+    uint32_t   peerTicket = doc["ticket"] | 0;
+    LeaseState peerState  = parseState(doc["state"] | "idle");
+    uint32_t   ttlSec     = doc["ttl"] | 0;
+    uint32_t   ttlMs      = ttlSec ? ttlSec * 1000 : policy.leaseTtlMs;
+    if (peerTicket > maxTicket) maxTicket = peerTicket;
+
+    Peer* p = find(name);
+    if (peerState == LeaseState::IDLE) {
+        if (p) *p = peers[--peerCount];
+        return true;
+    }
+
+    if (!p) {
+        if (peerCount == MAX_PEERS) {
+            // Evicting anyone could forget a lease; hold back claims instead
+            LOG_WARN("POWER | peer table full, ignoring %s", name);
+            untrackedAt = millis();
+            untrackedMs = ttlMs;
+            return true;
+        }
+        p = &peers[peerCount++];
+        strcpy(p->name, name);
+    }
+    p->ticket = peerTicket;
+    p->state  = peerState;
+    p->seen   = millis();
+    p->ttlMs  = ttlMs;
+    return true;
+}
+
+void PowerBudget::update() {
+    if (!enabled()) return;
+    uint32_t now = millis();
+
+    // After a (re)connect we may have missed announcements; listen first
+    bool connected = client.connected();
+    if (connected && !wasConnected) listenUntil = now + policy.leaseTtlMs;
+    wasConnected = connected;
+
+    expirePeers();
+    bool want = wantsHeat();
+
+    switch (state) {
+        case LeaseState::IDLE:
+            if (want && connected && (int32_t)(now - listenUntil) >= 0) {
+                takeTicket();
+                enter(LeaseState::WAIT);
+            }
+            break;
+
+        case LeaseState::WAIT:
+            if (!want)                        enter(LeaseState::IDLE);
+            else if (linkFresh() && slotFree()) enter(LeaseState::CLAIM);
+            break;
+
+        case LeaseState::CLAIM:
+            if (!want) {
+                enter(LeaseState::IDLE);
+            } else if (now - stateSince >= policy.settleMs) {
+                // The claim must have reached the broker, and nobody ahead of us
+                // may have claimed or leased meanwhile
+                bool echoed = (int32_t)(lastEcho - stateSince) >= 0;
+                enter(linkFresh() && echoed && slotFree() ? LeaseState::LEASE : LeaseState::WAIT);
+            }
+            break;
+
+        case LeaseState::LEASE:
+            if (!want) {
+                enter(LeaseState::IDLE);
+            } else if (!linkFresh()) {
+                LOG_WARN("POWER | lost contact with the broker, dropping lease");
+                enter(LeaseState::WAIT);
+            } else if (now - stateSince >= policy.slotMs && othersWaiting() && !warmingUp) {
+                takeTicket();
+                enter(LeaseState::WAIT);
+            }
+            break;
+    }
+
+    if (state != LeaseState::IDLE && now - lastPublish >= policy.heartbeatMs) publish();
+}
+
+bool PowerBudget::mayEnergise(bool demand, bool warming) {
+    if (!enabled()) return true;
+    warmingUp = warming;
+    if (demand) {
+        lastDemand = millis();
+        demandSeen = true;
+    }
+    return state == LeaseState::LEASE && linkFresh();
+}
+
+uint8_t PowerBudget::getHolders() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < peerCount; i++)
+        if (peers[i].state == LeaseState::LEASE) n++;
+    return n;
+}
+
+bool PowerBudget::wantsHeat() const {
+    return demandSeen && millis() - lastDemand < policy.graceMs;
+}
+
+bool PowerBudget::linkFresh() const {
+    // Give up the lease settleMs before peers would expire us
+    return client.connected() && millis() - lastEcho < policy.leaseTtlMs - policy.settleMs;
+}
+
+bool PowerBudget::before(const Peer& p) const {
+    return p.ticket < ticket || (p.ticket == ticket && strcmp(p.name, node) < 0);
+}
+
+bool PowerBudget::slotFree() const {
+    if (millis() - untrackedAt < untrackedMs) return false;
+    uint8_t taken = getHolders();
+    for (uint8_t i = 0; i < peerCount; i++) {
+        const Peer& p = peers[i];
+        if ((p.state == LeaseState::WAIT || p.state == LeaseState::CLAIM) && before(p)) taken++;
+    }
+    return taken < policy.limit;
+}
+
+bool PowerBudget::othersWaiting() const {
+    for (uint8_t i = 0; i < peerCount; i++)
+        if (peers[i].state == LeaseState::WAIT || peers[i].state == LeaseState::CLAIM) return true;
+    return false;
+}
+
+void PowerBudget::expirePeers() {
+    if (millis() - untrackedAt >= untrackedMs) untrackedMs = 0;
+    for (uint8_t i = 0; i < peerCount; ) {
+        if (millis() - peers[i].seen > peers[i].ttlMs) {
+            LOG_INFO("POWER | peer %s expired", peers[i].name);
+            peers[i] = peers[--peerCount];
+        } else {
+            i++;
+        }
+    }
+}
+
+void PowerBudget::enter(LeaseState next) {
+    LOG_INFO("POWER | %s -> %s (ticket %u)", nameOf(state), nameOf(next), (unsigned)ticket);
+    state      = next;
+    stateSince = millis();
+    publish();
+}
+
+void PowerBudget::takeTicket() {
+    ticket    = maxTicket + 1;
+    maxTicket = ticket;
+}
+
+void PowerBudget::publish() {
+    lastPublish = millis();
+
+    StaticJsonDocument<96> doc;
+    doc["ticket"] = ticket;
+    doc["state"]  = getStateName();
+    doc["ttl"]    = policy.leaseTtlMs / 1000;
+
+    char buffer[96];
+    serializeJson(doc, buffer);
+    client.publish(ownTopic, buffer);
+}
+
+PowerBudget::Peer* PowerBudget::find(const char* name) {
+    for (uint8_t i = 0; i < peerCount; i++)
+        if (strcmp(peers[i].name, name) == 0) return &peers[i];
+    return nullptr;
+}
+
+const char* PowerBudget::nameOf(LeaseState s) {
+    switch (s) {
+        case LeaseState::IDLE:  return "idle";
+        case LeaseState::WAIT:  return "wait";
+        case LeaseState::CLAIM: return "claim";
+        case LeaseState::LEASE: return "lease";
+    }
+    return "idle";
+}
+
+LeaseState PowerBudget::parseState(const char* s) {
+    if (!strcmp(s, "wait"))  return LeaseState::WAIT;
+    if (!strcmp(s, "claim")) return LeaseState::CLAIM;
+    if (!strcmp(s, "lease")) return LeaseState::LEASE;
+    return LeaseState::IDLE;
+}
@@ -0,0 +1,127 @@
+#ifndef POWER_BUDGET_HPP
+#define POWER_BUDGET_HPP
+
+#include <Arduino.h>
+#include <MqttPublisher.hpp>
+#include <HeaterGate.hpp>
+
+// Timing of the lease protocol. All nodes on a circuit should agree on
+// limit; the timings only need settleMs > worst broker round trip and
+// leaseTtlMs comfortably above heartbeatMs.
+struct PowerPolicy {
+    uint8_t  limit        = 1;                 // heaters allowed on at once
+    uint32_t heartbeatMs  = 5000;              // re-announce while not idle
+    uint32_t leaseTtlMs   = 15000;             // peers drop us after this long without a heartbeat
+    uint32_t settleMs     = 2000;              // claim -> lease; resolves simultaneous claims
+    uint32_t graceMs      = 30000;             // keep the lease through HOLDING's short off phases
+    uint32_t slotMs       = 10UL * 60 * 1000;  // re-queue after this long if someone is waiting
+};
+
+enum class LeaseState : uint8_t {
+    IDLE,   // no heat wanted
+    WAIT,   // queued with a ticket
+    CLAIM,  // at the front of the queue, waiting out settleMs for competing claims
+    LEASE   // may energise the heater
+};
+
+// Shares a limited number of heater "slots" between all dryers on one
+// electrical circuit, with no coordinator besides the MQTT broker.
+//
+// Every node announces itself on power/<circuit>/<node> as
+//   {"ticket":17,"state":"wait","ttl":15}
+// and keeps a table of its peers' latest announcements. Tickets are taken
+// as one above the highest ticket seen, so the queue is ordered by
+// (ticket, node name) and is first come, first served. A node may claim when
+// the peers holding a lease plus the peers queued ahead of it leave a free
+// slot; it then waits settleMs and re-checks, so of two simultaneous claims
+// only the earlier one proceeds. A lease is only valid while heartbeats keep
+// arriving: peers forget a silent node after its ttl and the node itself
+// gives up the lease when its own announcements stop echoing back, so a dead
+// or disconnected box can never hold a slot. Leases are re-queued after
+// slotMs when others are waiting, which round-robins the heat, but never
+// while the zone is still warming up to its target. A peer that does not fit
+// the table blocks new claims until its ttl has passed, since it may hold a
+// lease we cannot count.
+//
+// After boot (e.g. every box coming back from a power blip) and after every
+// reconnect a node listens for one ttl before claiming, so it knows who
+// already holds power.
+class PowerBudget : public HeaterGate {
+public:
+    PowerBudget(MqttPublisher& client, PowerPolicy policy = PowerPolicy());
+
+    // node must be unique on the circuit; both are copied. limit overrides
+    // the policy's, so it can come from the stored configuration.
+    void begin(const char* circuit, const char* node, uint8_t limit);
+    bool enabled() const { return topicPrefix[0] != '\0'; }
+
+    // Subscription filter for the circuit, "power/<circuit>/+"
+    const char* subscription() const { return filter; }
+
+    // Feed every incoming message; returns false if the topic isn't ours
+    bool handle(const char* topic, const byte* payload, unsigned int length);
+
+    // Call once per control tick, before DryerController::update()
+    void update();
+
+    // HeaterGate
+    bool mayEnergise(bool demand, bool warmingUp) override;
+
+    LeaseState  getState()      const { return state; }
+    const char* getStateName()  const { return nameOf(state); }
+    uint32_t    getTicket()     const { return ticket; }
+    uint8_t     getHolders()    const; // peers holding a lease, excluding us
+    uint8_t     getPeerCount()  const { return peerCount; }
+
+    static constexpr uint8_t MAX_PEERS = 12;
+    static constexpr size_t  MAX_NAME  = 40;
+
+private:
+    struct Peer {
+        char       name[MAX_NAME + 1];
+        uint32_t   ticket;
+        LeaseState state;
+        uint32_t   seen;   // millis() of the last announcement
+        uint32_t   ttlMs;
+    };
+
+    MqttPublisher& client;
+    PowerPolicy    policy;
+    char           node[MAX_NAME + 1];
+    char           topicPrefix[MAX_NAME + 8]; // "power/<circuit>/"
+    char           filter[MAX_NAME + 9];
+    char           ownTopic[2 * MAX_NAME + 8];
+
+    Peer           peers[MAX_PEERS];
+    uint8_t        peerCount;
+
+    LeaseState     state;
+    uint32_t       ticket;
+    uint32_t       maxTicket;     // highest ticket seen on the circuit
+    uint32_t       stateSince;
+    uint32_t       lastDemand;
+    bool           demandSeen;
+    bool           warmingUp;     // the zone has not reached its target yet
+    uint32_t       lastPublish;
+    uint32_t       lastEcho;      // our own announcement came back from the broker
+    uint32_t       listenUntil;   // no claims before this (learning the circuit)
+    uint32_t       untrackedAt;   // a peer did not fit the table: no claims for untrackedMs
+    uint32_t       untrackedMs;
+    bool           wasConnected;
+
+    bool wantsHeat() const;
+    bool linkFresh() const;
+    bool before(const Peer& p) const;      // peer is queued ahead of us
+    bool slotFree() const;
+    bool othersWaiting() const;
+    void expirePeers();
+    void enter(LeaseState next);
+    void takeTicket();
+    void publish();
+    Peer* find(const char* name);
+
+    static const char* nameOf(LeaseState s);
+    static LeaseState  parseState(const char* s);
+};
+
+#endif // POWER_BUDGET_HPP
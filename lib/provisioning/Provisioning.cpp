@@ -1,7 +1,8 @@
 #include "Provisioning.hpp"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
-#include <ESP8266WiFi.h>
+#include <Platform.hpp>
+#include <Log.hpp>
 
 // ---------------------------------------------------------------------------
 // HTML pages stored in program flash to keep heap free
@@ -22,8 +23,10 @@ static const char SETUP_HTML[] PROGMEM = R"html(
     p{margin:0 0 20px;color:#666;font-size:.9rem}
     h3{margin:16px 0 6px;font-size:.95rem;color:#333;border-bottom:1px solid #eee;padding-bottom:4px}
     label{display:block;font-size:.82rem;font-weight:600;color:#444;margin-top:10px}
-    input{display:block;width:100%;padding:8px 10px;margin-top:3px;border:1px solid #ccc;border-radius:4px;font-size:.95rem}
-    input:focus{outline:none;border-color:#e05a00}
+    input,textarea{display:block;width:100%;padding:8px 10px;margin-top:3px;border:1px solid #ccc;border-radius:4px;font-size:.95rem}
+    input[type=checkbox]{display:inline;width:auto;margin-right:6px}
+    textarea{font-family:monospace;font-size:.7rem}
+    input:focus,textarea:focus{outline:none;border-color:#e05a00}
     button{display:block;width:100%;margin-top:24px;padding:12px;background:#e05a00;color:#fff;border:none;border-radius:6px;font-size:1rem;cursor:pointer;font-weight:600}
     button:hover{background:#c24d00}
     .hint{font-size:.75rem;color:#999;margin-top:2px}
@@ -54,6 +57,35 @@ static const char SETUP_HTML[] PROGMEM = R"html(
     <label>Password
       <input name="broker_pass" type="password" placeholder="optional">
     </label>
+    <label><input name="broker_tls" type="checkbox" value="1">Use TLS (port 8883)</label>
+    <label>Broker certificate
+      <textarea name="broker_cert" rows="6" placeholder="-----BEGIN CERTIFICATE-----"></textarea>
+    </label>
+    <label>or SHA-1 fingerprint
+      <input name="broker_fp" type="text" maxlength="59" placeholder="AB:CD:... (if no certificate)">
+    </label>
+    <div class="hint">TLS needs one of the two; a CA certificate keeps working when the broker renews its key.</div>
+    <h3>Device</h3>
+    <label>Name
+      <input name="device" type="text" maxlength="32" pattern="[A-Za-z0-9_-]*" placeholder="default: dryer-&lt;chip id&gt;">
+    </label>
+    <div class="hint">Topics become cmnd/&lt;name&gt;/... and tele/&lt;name&gt;/...</div>
+    <label>Group
+      <input name="group" type="text" maxlength="32" pattern="[A-Za-z0-9_-]*" placeholder="optional, e.g. shelf-a">
+    </label>
+    <h3>Power Budget</h3>
+    <label>Circuit
+      <input name="power_circuit" type="text" maxlength="32" pattern="[A-Za-z0-9_-]*" placeholder="optional, e.g. bench-16a">
+    </label>
+    <label>Max heaters on at once
+      <input name="power_limit" type="number" value="0" min="0" max="12">
+    </label>
+    <div class="hint">Dryers on the same circuit share this limit; 0 disables the budget.</div>
+    <h3>Firmware Updates</h3>
+    <label>Manifest URL
+      <input name="update_url" type="url" maxlength="128" placeholder="optional, e.g. http://nas.local/dryer/manifest.json">
+    </label>
+    <div class="hint">Checked every 6 hours; updates only install while no heater is running.</div>
     <button type="submit">Save &amp; Restart</button>
   </form>
 </div>
@@ -96,7 +128,7 @@ Provisioning::Provisioning() : server(80) {}
 
 bool Provisioning::begin() {
     if (!LittleFS.begin()) {
-        Serial.println("LittleFS mount failed — formatting");
+        LOG_ERROR("FS | LittleFS mount failed, formatting");
         LittleFS.format();
         LittleFS.begin();
     }
@@ -105,7 +137,7 @@ bool Provisioning::begin() {
         // No credentials stored yet — go straight to AP mode without touching
         // the boot counter (counter is only meaningful during normal operation).
         writeBootCount(0);
-        Serial.println("No credentials found — entering AP mode.");
+        LOG_INFO("SETUP | no credentials, entering AP mode");
         startAPMode();
         return false; // unreachable
     }
@@ -114,17 +146,17 @@ bool Provisioning::begin() {
     // main loop must call clearBootCounter() after ~10 s of normal operation.
     uint8_t boots = readBootCount() + 1;
     writeBootCount(boots);
-    Serial.printf("Boot count: %d/%d\n", boots, RESET_BOOT_COUNT);
+    LOG_INFO("SETUP | boot count %d/%d", boots, RESET_BOOT_COUNT);
 
     if (boots >= RESET_BOOT_COUNT) {
         writeBootCount(0);
         clearCredentials();
-        Serial.println("Factory reset triggered by 5x rapid power cycle — entering AP mode.");
+        LOG_WARN("SETUP | factory reset by %d rapid power cycles, entering AP mode", RESET_BOOT_COUNT);
         startAPMode();
         return false; // unreachable
     }
 
-    Serial.println("Credentials loaded from storage.");
+    LOG_INFO("SETUP | credentials loaded");
     return true;
 }
 
@@ -152,7 +184,7 @@ bool Provisioning::loadCredentials() {
     File f = LittleFS.open(CREDENTIALS_FILE, "r");
     if (!f) return false;
 
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<1024> doc;
     DeserializationError err = deserializeJson(doc, f);
     f.close();
     if (err) return false;
@@ -163,29 +195,44 @@ bool Provisioning::loadCredentials() {
     credentials.brokerPort     = doc["broker_port"] | 1883;
     credentials.brokerUser     = doc["broker_user"] | "";
     credentials.brokerPassword = doc["broker_pass"] | "";
+    credentials.brokerTls         = doc["broker_tls"] | false;
+    credentials.brokerFingerprint = doc["broker_fp"]  | "";
+    credentials.deviceName     = doc["device"]      | "";
+    credentials.group          = doc["group"]       | "";
+    credentials.powerCircuit   = doc["power_circuit"] | "";
+    credentials.powerLimit     = doc["power_limit"]   | 0;
+    credentials.updateUrl      = doc["update_url"]    | "";
 
     return credentials.isValid();
 }
 
 void Provisioning::saveCredentials(const NetworkCredentials& creds) {
-    StaticJsonDocument<512> doc;
+    StaticJsonDocument<1024> doc;
     doc["ssid"]        = creds.wifiSSID;
     doc["pass"]        = creds.wifiPassword;
     doc["broker_ip"]   = creds.brokerIP;
     doc["broker_port"] = creds.brokerPort;
     doc["broker_user"] = creds.brokerUser;
     doc["broker_pass"] = creds.brokerPassword;
+    doc["broker_tls"]  = creds.brokerTls;
+    doc["broker_fp"]   = creds.brokerFingerprint;
+    doc["device"]      = creds.deviceName;
+    doc["group"]       = creds.group;
+    doc["power_circuit"] = creds.powerCircuit;
+    doc["power_limit"]   = creds.powerLimit;
+    doc["update_url"]    = creds.updateUrl;
 
     File f = LittleFS.open(CREDENTIALS_FILE, "w");
     serializeJson(doc, f);
     f.close();
-    Serial.println("Credentials saved to LittleFS.");
+    LOG_INFO("SETUP | credentials saved");
 }
 
 void Provisioning::clearCredentials() {
     if (LittleFS.begin()) {
         LittleFS.remove(CREDENTIALS_FILE);
-        Serial.println("Credentials cleared.");
+        LittleFS.remove(BROKER_CERT_FILE);
+        LOG_INFO("SETUP | credentials cleared");
     }
 }
 
@@ -203,14 +250,13 @@ void Provisioning::startAPMode() {
     server.onNotFound(            [this]() { handleNotFound(); });
     server.begin();
 
-    Serial.print("AP started — connect to WiFi \"");
-    Serial.print(AP_SSID);
-    Serial.print("\" and open http://");
-    Serial.println(apIP.toString());
+    LOG_INFO("SETUP | AP started, connect to WiFi \"%s\" and open http://%s",
+             AP_SSID, apIP.toString().c_str());
 
     while (true) {
         dnsServer.processNextRequest();
         server.handleClient();
+        log_buffer.drain();
         yield();
     }
 }
@@ -227,12 +273,28 @@ void Provisioning::handleSave() {
     creds.brokerPort     = server.arg("broker_port").toInt();
     creds.brokerUser     = server.arg("broker_user");
     creds.brokerPassword = server.arg("broker_pass");
+    creds.brokerTls      = server.hasArg("broker_tls");
+    creds.brokerFingerprint = server.arg("broker_fp");
+    creds.deviceName     = server.arg("device");
+    creds.group          = server.arg("group");
+    creds.powerCircuit   = server.arg("power_circuit");
+    creds.powerLimit     = server.arg("power_limit").toInt();
+    creds.updateUrl      = server.arg("update_url");
 
     if (!creds.isValid()) {
         server.send(400, "text/plain", "SSID and broker IP are required.");
         return;
     }
 
+    String cert = server.arg("broker_cert");
+    if (cert.indexOf("-----BEGIN CERTIFICATE-----") >= 0) {
+        File f = LittleFS.open(BROKER_CERT_FILE, "w");
+        f.print(cert);
+        f.close();
+    } else {
+        LittleFS.remove(BROKER_CERT_FILE);
+    }
+
     saveCredentials(creds);
     server.send_P(200, "text/html", SAVED_HTML);
     delay(2000);
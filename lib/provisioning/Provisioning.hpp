@@ -2,7 +2,13 @@
 #define PROVISIONING_HPP
 
 #include <Arduino.h>
+#if defined(ESP32)
+#include <WebServer.h>
+typedef WebServer SetupServer;
+#else
 #include <ESP8266WebServer.h>
+typedef ESP8266WebServer SetupServer;
+#endif
 #include <DNSServer.h>
 #include <NetworkCredentials.hpp>
 
@@ -27,7 +33,7 @@ public:
 
 private:
     NetworkCredentials credentials;
-    ESP8266WebServer   server;
+    SetupServer        server;
     DNSServer          dnsServer;
 
     bool loadCredentials();
@@ -8,13 +8,13 @@
 // not the relay coil state.
 class NcRelay {
 public:
-    NcRelay(uint8_t pin, const String& name) : relay(pin, name) {}
+    NcRelay(uint8_t pin, const char* name) : relay(pin, name) {}
 
     void turnOn()  { relay.turnOff(); } // de-energize NC contact → device receives power
     void turnOff() { relay.turnOn();  } // energize NC contact   → device loses power
 
     bool getState() const { return !relay.getState(); }
-    String getName() const { return relay.getName(); }
+    const char* getName() const { return relay.getName(); }
 
 private:
     Relais relay;
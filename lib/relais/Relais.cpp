@@ -1,24 +1,25 @@
 #include "Relais.hpp"
+#include <Pins.hpp>
 
-Relais::Relais(uint8_t p, String n) : pin(p), state(false), name(n)
+Relais::Relais(uint8_t p, const char* n) : pin(p), state(false), name(n)
 {
     pinMode(pin, OUTPUT);
-    digitalWrite(pin, LOW);
+    digitalWrite(pin, RELAY_OFF_LEVEL);
 }
 
 void Relais::turnOn()
 {
-    digitalWrite(pin, HIGH);
+    digitalWrite(pin, RELAY_ON_LEVEL);
     this->state = true;
 }
 
 void Relais::turnOff()
 {
-    digitalWrite(pin, LOW);
+    digitalWrite(pin, RELAY_OFF_LEVEL);
     this->state = false;
 }
 
-String Relais::getName() const
+const char* Relais::getName() const
 {
     return name;
 }
@@ -8,14 +8,14 @@ class Relais
 private:
     uint8_t pin;
     bool state;
-    String name;
+    const char* name; // static string, e.g. "Heater"
 
 public:
-    Relais(uint8_t pin, String name);
+    Relais(uint8_t pin, const char* name);
 
     void turnOn();
     void turnOff();
-    String getName() const;
+    const char* getName() const;
     bool getState() const;
 };
 
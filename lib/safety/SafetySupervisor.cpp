@@ -0,0 +1,120 @@
+#include "SafetySupervisor.hpp"
+
+SafetySupervisor* SafetySupervisor::instance = nullptr;
+
+#if defined(ESP32)
+// Timer 0 counts microseconds (80 MHz APB / 80). The ISR may run on one core
+// while feed() runs on the other, so interrupts off is not enough.
+static hw_timer_t*  timer   = nullptr;
+static portMUX_TYPE zoneMux = portMUX_INITIALIZER_UNLOCKED;
+#define ZONES_LOCK()   portENTER_CRITICAL(&zoneMux)
+#define ZONES_UNLOCK() portEXIT_CRITICAL(&zoneMux)
+#else
+// timer1 runs off the 80 MHz APB clock regardless of CPU speed
+static constexpr uint32_t TIMER1_TICKS_PER_MS = 80000000UL / 256 / 1000;
+#define ZONES_LOCK()   noInterrupts()
+#define ZONES_UNLOCK() interrupts()
+#endif
+
+SafetySupervisor::SafetySupervisor(SafetyPolicy policy)
+    : policy(policy), zones(), zoneCount(0), checks(0)
+{}
+
+void SafetySupervisor::begin(uint8_t count) {
+    zoneCount = count;
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        Zone& z       = zones[i];
+        z.heaterPin   = ZONE_PINS[i].heater;
+        z.fanPin      = ZONE_PINS[i].fan;
+        z.deciC       = 0;
+        z.sampleAt    = now; // the freshness deadline starts now
+        z.heaterOnAt  = now;
+        z.heaterWasOn = false;
+        z.trip        = SafetyTrip::NONE;
+        z.seen        = false;
+        z.trips       = 0;
+    }
+
+    instance = this;
+#if defined(ESP32)
+    timer = timerBegin(0, 80, true);
+    timerAttachInterrupt(timer, onTimer, false); // level: the 2.x core has no edge timer interrupts
+    timerAlarmWrite(timer, policy.periodMs * 1000, true);
+    timerAlarmEnable(timer);
+#else
+    timer1_isr_init();
+    timer1_attachInterrupt(onTimer);
+    timer1_enable(TIM_DIV256, TIM_EDGE, TIM_LOOP);
+    timer1_write(policy.periodMs * TIMER1_TICKS_PER_MS);
+#endif
+}
+
+void SafetySupervisor::feed(uint8_t zone, CentiCelsius temperature) {
+    int16_t deciC = temperature.deci();
+    ZONES_LOCK();
+    zones[zone].deciC    = deciC;
+    zones[zone].sampleAt = millis();
+    ZONES_UNLOCK();
+}
+
+SafetyTrip SafetySupervisor::tripOf(uint8_t zone) {
+    SafetyTrip trip = zones[zone].trip;
+    if (trip != SafetyTrip::NONE) zones[zone].seen = true;
+    return trip;
+}
+
+void IRAM_ATTR SafetySupervisor::onTimer() {
+    if (!instance) return;
+#if defined(ESP32)
+    portENTER_CRITICAL_ISR(&zoneMux);
+    instance->check();
+    portEXIT_CRITICAL_ISR(&zoneMux);
+#else
+    instance->check();
+#endif
+}
+
+void IRAM_ATTR SafetySupervisor::check() {
+    uint32_t now = millis();
+    checks++;
+
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        Zone& z = zones[i];
+
+        // The pin, not Relais::getState(): that is only what loop() believes
+        bool heaterOn = digitalRead(z.heaterPin) == RELAY_ON_LEVEL;
+        if (heaterOn && !z.heaterWasOn) z.heaterOnAt = now;
+        z.heaterWasOn = heaterOn;
+
+        bool       fresh = now - z.sampleAt < policy.maxSampleAgeMs;
+        SafetyTrip trip  = SafetyTrip::NONE;
+        if (z.deciC >= policy.tripDeciC)                                 trip = SafetyTrip::OVER_TEMP;
+        else if (heaterOn && !fresh)                                     trip = SafetyTrip::SENSOR_STALE;
+        else if (heaterOn && now - z.heaterOnAt >= policy.maxHeaterOnMs) trip = SafetyTrip::HEATER_ON_TIME;
+
+        if (trip != SafetyTrip::NONE && z.trip == SafetyTrip::NONE) {
+            z.trip = trip;
+            z.seen = false;
+            z.trips++;
+        } else if (z.trip != SafetyTrip::NONE && z.seen && fresh && !heaterOn &&
+                   z.deciC < policy.releaseDeciC) {
+            z.trip = SafetyTrip::NONE;
+        }
+
+        if (z.trip != SafetyTrip::NONE) {
+            digitalWrite(z.heaterPin, RELAY_OFF_LEVEL);
+            digitalWrite(z.fanPin, RELAY_OFF_LEVEL); // fan on the NC contact: coil off = running
+        }
+    }
+}
+
+const char* SafetySupervisor::tripName(SafetyTrip trip) {
+    switch (trip) {
+        case SafetyTrip::NONE:           return "none";
+        case SafetyTrip::OVER_TEMP:      return "over_temp";
+        case SafetyTrip::HEATER_ON_TIME: return "heater_on_time";
+        case SafetyTrip::SENSOR_STALE:   return "sensor_stale";
+    }
+    return "none";
+}
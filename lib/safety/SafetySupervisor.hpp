@@ -0,0 +1,81 @@
+#ifndef SAFETY_SUPERVISOR_HPP
+#define SAFETY_SUPERVISOR_HPP
+
+#include <Arduino.h>
+#include <Pins.hpp>
+#include <Fixed.hpp>
+
+enum class SafetyTrip : uint8_t {
+    NONE,
+    OVER_TEMP,       // reading at or above tripDeciC
+    HEATER_ON_TIME,  // heater energised longer than maxHeaterOnMs in one go
+    SENSOR_STALE     // no good reading for maxSampleAgeMs while heating
+};
+
+struct SafetyPolicy {
+    int16_t  tripDeciC      = BOARD.limits.cutoffC * 10;
+    int16_t  releaseDeciC   = BOARD.limits.releaseC * 10;          // hysteresis
+    uint32_t maxHeaterOnMs  = BOARD.limits.maxHeaterOnMin * 60000UL;
+    uint32_t maxSampleAgeMs = 30000;              // DHT11 misses single reads now and then
+    uint32_t periodMs       = 100;                // timer interval = worst-case reaction time
+};
+
+// Last line of defence that does not depend on loop() running.
+//
+// A hardware timer (timer1; timer 0 on the ESP32) checks every zone each
+// periodMs from an ISR: the newest reading handed over by feed(), how long
+// ago it arrived, and how long the heater output has been on without a
+// break. On a trip the ISR
+// switches the heater relay off and the fan on itself, and keeps doing so every
+// period until the trip is released — whatever the main loop writes in
+// between is overridden within periodMs.
+//
+// The ISR does integer work on plain variables only. Readings are handed over
+// in tenths of a degree; a loop that stalls stops feeding and so trips the
+// freshness deadline once the heater is on.
+//
+// A trip is released only after loop() has seen it (tripOf()) and put the
+// controller into SAFETY, a fresh reading is below releaseDeciC and the
+// heater pin is low.
+class SafetySupervisor {
+public:
+    explicit SafetySupervisor(SafetyPolicy policy = SafetyPolicy());
+
+    // Takes over the zones' heater/fan pins from ZONE_PINS and starts the timer
+    void begin(uint8_t zoneCount);
+
+    // After every successful sensor read
+    void feed(uint8_t zone, CentiCelsius temperature);
+
+    // Current trip of a zone; marks it as seen by the main loop
+    SafetyTrip tripOf(uint8_t zone);
+
+    uint32_t getTripCount(uint8_t zone) const { return zones[zone].trips; }
+    uint32_t getChecks()                const { return checks; }
+
+    static const char* tripName(SafetyTrip trip);
+
+private:
+    struct Zone {
+        uint8_t           heaterPin;
+        uint8_t           fanPin;
+        volatile int16_t  deciC;
+        volatile uint32_t sampleAt;     // millis() of the last feed()
+        volatile uint32_t heaterOnAt;   // start of the current on-phase
+        volatile bool     heaterWasOn;  // heater pin at the last check
+        volatile SafetyTrip trip;
+        volatile bool     seen;
+        volatile uint32_t trips;
+    };
+
+    SafetyPolicy      policy;
+    Zone              zones[DRYER_ZONE_COUNT];
+    uint8_t           zoneCount;
+    volatile uint32_t checks;
+
+    void check();
+    static void onTimer();
+    static SafetySupervisor* instance;
+};
+
+#endif // SAFETY_SUPERVISOR_HPP
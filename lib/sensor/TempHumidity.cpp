@@ -1,7 +1,8 @@
 #include "TempHumidity.hpp"
 #include <Arduino.h>
+#include <Log.hpp>
 
-TempHumidity::TempHumidity(uint8_t pin, uint8_t type) : dht(pin, type), temperature(0.0f), humidity(0.0f)
+TempHumidity::TempHumidity(uint8_t pin, uint8_t type) : dht(pin, type), haveReading(false)
 {
 }
 
@@ -10,43 +11,66 @@ void TempHumidity::setupDHT()
   dht.begin();
 }
 
-void TempHumidity::updateReadings()
+bool TempHumidity::updateReadings()
 {
   float newHumidity = dht.readHumidity();
-  float newTemperature = dht.readTemperature() - 1; // Offset
+  float newTemperature = dht.readTemperature();
 
   if (!isnan(newHumidity) && !isnan(newTemperature))
   {
-    humidity = newHumidity;
-    temperature = newTemperature;
-    Serial.print(F("DHT Monitoring... Humidity: "));
-    Serial.print(humidity);
-    Serial.print(F("%, Temperature: "));
-    Serial.print(temperature);
-    Serial.println(F("°C"));
-  }
-  else
-  {
-    Serial.println(F("Failed to read from DHT sensor!"));
+    // The DHT library only hands out float; the only conversion on the way
+    rawHumidity = CentiPercent::fromCenti((int16_t)lroundf(newHumidity * 100));
+    rawTemperature = CentiCelsius::fromCenti((int16_t)lroundf(newTemperature * 100));
+    haveReading = true;
+    humidity = CentiPercent::fromCenti(calibration.humidity.apply(rawHumidity.centi()));
+    temperature = CentiCelsius::fromCenti(calibration.temperature.apply(rawTemperature.centi()));
+
+    char h[CentiPercent::FORMAT_SIZE], t[CentiCelsius::FORMAT_SIZE];
+    LOG_DEBUG("DHT | %s %% RH, %s C", humidity.format(h, sizeof(h)),
+              temperature.format(t, sizeof(t)));
+    return true;
   }
+
+  LOG_WARN("DHT | read failed");
+  return false;
 }
 
-float TempHumidity::getTemperature() const
+CentiCelsius TempHumidity::getTemperature() const
 {
   return temperature;
 }
 
-float TempHumidity::getHumidity() const
+CentiPercent TempHumidity::getHumidity() const
 {
   return humidity;
 }
 
-void TempHumidity::setTemperature(float temperature)
+void TempHumidity::setTemperature(CentiCelsius temperature)
 {
   this->temperature = temperature;
 }
 
-void TempHumidity::setHumidity(float humidity)
+void TempHumidity::setHumidity(CentiPercent humidity)
 {
   this->humidity = humidity;
+}
+
+Calibration& TempHumidity::getCalibration()
+{
+  return calibration;
+}
+
+bool TempHumidity::hasReading() const
+{
+  return haveReading;
+}
+
+CentiCelsius TempHumidity::getRawTemperature() const
+{
+  return rawTemperature;
+}
+
+CentiPercent TempHumidity::getRawHumidity() const
+{
+  return rawHumidity;
 }
\ No newline at end of file
@@ -2,22 +2,36 @@
 #define TEMP_HUMIDITY_H
 
 #include <DHT.h>
+#include <Calibration.hpp>
+#include <Fixed.hpp>
 
 class TempHumidity
 {
 public:
     TempHumidity(uint8_t pin, uint8_t type);
     void setupDHT();
-    void updateReadings();
-    float getTemperature() const;
-    float getHumidity() const;
-    void setTemperature(float temperature);
-    void setHumidity(float humidity);
+    bool updateReadings(); // false if the DHT read failed; old values are kept
+    CentiCelsius getTemperature() const; // calibrated
+    CentiPercent getHumidity() const;
+    void setTemperature(CentiCelsius temperature);
+    void setHumidity(CentiPercent humidity);
+
+    // Applied by updateReadings(); changes take effect with the next read
+    Calibration& getCalibration();
+
+    // Last good reading before calibration
+    bool hasReading() const;
+    CentiCelsius getRawTemperature() const;
+    CentiPercent getRawHumidity() const;
 
 private:
     DHT dht;
-    float temperature;
-    float humidity;
+    Calibration calibration;
+    CentiCelsius temperature;
+    CentiPercent humidity;
+    CentiCelsius rawTemperature;
+    CentiPercent rawHumidity;
+    bool haveReading;
 };
 
 #endif // TEMP_HUMIDITY_H
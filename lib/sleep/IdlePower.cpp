@@ -0,0 +1,119 @@
+#include "IdlePower.hpp"
+#include <ArduinoJson.h>
+#include <Fixed.hpp>
+#include <Log.hpp>
+#include <Platform.hpp>
+
+constexpr uint32_t IdlePower::PUBLISH_INTERVAL_MS;
+
+IdlePower::IdlePower(MqttPublisher& client, Topics& topics, IdlePolicy policy)
+    : client(client), topics(topics), policy(policy),
+      mode(PowerMode::ACTIVE), lastActivity(0), modeSince(0), lastPublish(0),
+      napUs(0), windowStart(0), napOvershootMaxMs(0), modeMs{0, 0, 0}, wakes(0)
+{}
+
+void IdlePower::begin() {
+    lastActivity = modeSince = windowStart = millis();
+}
+
+bool IdlePower::activity() {
+    lastActivity = millis();
+    if (mode == PowerMode::ACTIVE) return false;
+
+    bool wasDark = (mode == PowerMode::ASLEEP);
+    wakes++;
+    enter(PowerMode::ACTIVE);
+    return wasDark;
+}
+
+void IdlePower::update(bool busy) {
+    uint32_t now = millis();
+    if (busy) lastActivity = now;
+
+    uint32_t  quiet = now - lastActivity;
+    PowerMode want  = quiet >= policy.sleepAfterMs ? PowerMode::ASLEEP
+                    : quiet >= policy.dimAfterMs   ? PowerMode::DIMMED
+                    :                                PowerMode::ACTIVE;
+    if (want != mode) enter(want);
+
+    if (now - lastPublish >= PUBLISH_INTERVAL_MS) {
+        lastPublish = now;
+        publish();
+    }
+}
+
+void IdlePower::nap() {
+    if (mode == PowerMode::ACTIVE) return;
+
+    // delay() is where the SDK's modem/light sleep actually happens
+    uint32_t start = micros();
+    delay(policy.napMs);
+    uint32_t sleptUs = micros() - start;
+    napUs += sleptUs;
+
+    uint32_t over = sleptUs / 1000 > policy.napMs ? sleptUs / 1000 - policy.napMs : 0;
+    if (over > napOvershootMaxMs) napOvershootMaxMs = over;
+}
+
+void IdlePower::enter(PowerMode next) {
+    uint32_t now = millis();
+    modeMs[(uint8_t)mode] += now - modeSince;
+    modeSince = now;
+
+    const char* from = getModeName();
+    mode = next;
+    LOG_INFO("POWER | %s -> %s", from, getModeName());
+
+#if defined(ESP32)
+    // MIN_MODEM wakes for every DTIM beacon, MAX_MODEM once per listen interval (3)
+    WiFi.setSleep(mode == PowerMode::ASLEEP ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM);
+#else
+    if (mode == PowerMode::ASLEEP) WiFi.setSleepMode(WIFI_LIGHT_SLEEP, policy.listenInterval);
+    else                           WiFi.setSleepMode(WIFI_MODEM_SLEEP); // SDK default
+#endif
+}
+
+uint8_t IdlePower::getContrast() const {
+    switch (mode) {
+        case PowerMode::ACTIVE: return policy.activeContrast;
+        case PowerMode::DIMMED: return policy.dimContrast;
+        case PowerMode::ASLEEP: return 0;
+    }
+    return policy.activeContrast;
+}
+
+void IdlePower::publish() {
+    uint32_t now    = millis();
+    uint32_t window = now - windowStart;
+
+    // Share of wall time loop() spent napping, i.e. allowed to sleep; µs per
+    // ms × 10 is hundredths of a percent
+    char napPct[8];
+    formatHundredths(napPct, sizeof(napPct), window ? (int32_t)(napUs * 10 / window) : 0, 1);
+
+    StaticJsonDocument<256> doc;
+    doc["mode"]           = getModeName();
+    doc["napPct"]         = serialized(napPct);
+    doc["activeS"]        = (modeMs[0] + (mode == PowerMode::ACTIVE ? now - modeSince : 0)) / 1000;
+    doc["dimmedS"]        = (modeMs[1] + (mode == PowerMode::DIMMED ? now - modeSince : 0)) / 1000;
+    doc["asleepS"]        = (modeMs[2] + (mode == PowerMode::ASLEEP ? now - modeSince : 0)) / 1000;
+    doc["wakes"]          = wakes;
+    doc["lateWakeMaxMs"]  = napOvershootMaxMs;
+
+    char buffer[256];
+    serializeJson(doc, buffer);
+    client.publish(topics.tele("sleep"), buffer);
+
+    napUs             = 0;
+    windowStart       = now;
+    napOvershootMaxMs = 0;
+}
+
+const char* IdlePower::getModeName() const {
+    switch (mode) {
+        case PowerMode::ACTIVE: return "ACTIVE";
+        case PowerMode::DIMMED: return "DIMMED";
+        case PowerMode::ASLEEP: return "ASLEEP";
+    }
+    return "ACTIVE";
+}
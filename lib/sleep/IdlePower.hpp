@@ -0,0 +1,84 @@
+#ifndef IDLE_POWER_HPP
+#define IDLE_POWER_HPP
+
+#include <Arduino.h>
+#include <MqttPublisher.hpp>
+#include <Topics.hpp>
+
+enum class PowerMode : uint8_t {
+    ACTIVE,  // full speed, loop() spins
+    DIMMED,  // OLED dimmed, loop() naps between passes, WiFi modem sleep
+    ASLEEP   // OLED off, WiFi automatic light sleep
+};
+
+struct IdlePolicy {
+    uint32_t dimAfterMs     = 30000;          // no activity and no running cycle
+    uint32_t sleepAfterMs   = 5UL * 60 * 1000;
+    uint32_t napMs          = 100;            // upper bound on button wake latency
+    uint8_t  listenInterval = 3;              // DTIM beacons slept through in light sleep
+    uint8_t  activeContrast = 200;
+    uint8_t  dimContrast    = 8;
+};
+
+// Lets a box that sits idle most of the day stop burning full power.
+//
+// While any zone runs a cycle the box stays ACTIVE. Otherwise, after
+// dimAfterMs without a button press or MQTT command the OLED is dimmed and
+// loop() naps napMs per pass, which lets the WiFi modem sleep between
+// beacons; after sleepAfterMs the OLED is switched off and the SDK may
+// light-sleep the CPU during those naps, woken by the nap timer or the
+// access point's DTIM beacon announcing queued traffic.
+//
+// The OLED follows getContrast(), applied by whoever draws it. On the ESP32
+// the radio uses its minimum / maximum modem power save instead of the
+// ESP8266 sleep modes, and nap() is the control task's idle delay.
+//
+// The buttons are deliberately not level-wake sources: a low-level wake
+// would keep re-firing their edge interrupt while a button is held. A press
+// is seen after the current nap instead, so wake latency is bounded by
+// napMs for buttons and by roughly listenInterval beacon intervals (~300 ms)
+// plus napMs for MQTT.
+class IdlePower {
+public:
+    IdlePower(MqttPublisher& client, Topics& topics, IdlePolicy policy = IdlePolicy());
+
+    void begin();
+
+    // A button press or command. Returns true if the display was off, so
+    // the caller can treat the press as "wake up" only.
+    bool activity();
+
+    // Once per system tick; busy = a cycle is running somewhere
+    void update(bool busy);
+
+    // Last thing in loop(): naps unless ACTIVE
+    void nap();
+
+    PowerMode   getMode()     const { return mode; }
+    const char* getModeName() const;
+    uint8_t     getContrast() const; // for the OLED, 0 = panel off
+
+private:
+    MqttPublisher& client;
+    Topics&        topics;
+    IdlePolicy     policy;
+
+    PowerMode mode;
+    uint32_t  lastActivity;
+    uint32_t  modeSince;
+    uint32_t  lastPublish;
+
+    // duty-cycle accounting since the last publish
+    uint64_t  napUs;
+    uint32_t  windowStart;
+    uint32_t  napOvershootMaxMs; // nap longer than asked: a late wake
+    uint32_t  modeMs[3];         // lifetime ms per PowerMode
+    uint32_t  wakes;
+
+    void enter(PowerMode next);
+    void publish();
+
+    static constexpr uint32_t PUBLISH_INTERVAL_MS = 60000;
+};
+
+#endif // IDLE_POWER_HPP
@@ -0,0 +1,227 @@
+#include "Telemetry.hpp"
+#include <Fixed.hpp>
+#include <ArduinoJson.h>
+#include <Log.hpp>
+#include <time.h>
+
+Telemetry::Telemetry(MqttPublisher& client, Topics& topics, uint8_t zoneCount)
+    : client(client), topics(topics), zoneCount(zoneCount)
+{}
+
+// Readings go in as integer-formatted raw JSON numbers, which keeps float
+// formatting off every path here; the buffers must outlive serializeJson()
+
+void Telemetry::publishState(DryerZone& zone, uint8_t index) {
+    char rh[CentiPercent::FORMAT_SIZE], celsius[CentiCelsius::FORMAT_SIZE];
+    StaticJsonDocument<300> doc;
+    doc["state"]              = zone.controller.getStateName();
+    doc["humidity"]           = serialized(zone.sensor.getHumidity().format(rh, sizeof(rh)));
+    doc["currentTemperature"] = serialized(zone.sensor.getTemperature().format(celsius, sizeof(celsius)));
+    doc["targetTemperature"]  = zone.heater.getTargetTemperature();
+    doc["remainingTime"]      = zone.heater.computeRemainingTime() / 60000;
+    doc["heaterState"]        = zone.heaterRelay.getState();
+    doc["fanState"]           = zone.fanRelay.getState();
+    doc["heaterBlocked"]      = zone.controller.isHeaterBlocked(); // waiting for power budget
+
+    char buffer[512];
+    serializeJson(doc, buffer);
+
+    if (zoneCount > 1) {
+        char leaf[16];
+        snprintf(leaf, sizeof(leaf), "zone/%u/state", index + 1);
+        client.publish(topics.tele(leaf), buffer);
+    } else {
+        client.publish(topics.tele("state"), buffer);
+    }
+}
+
+void Telemetry::publishButtonEvent(const char* button, const char* action) {
+    StaticJsonDocument<64> doc;
+    doc["button"] = button;
+    doc["action"] = action;
+    char buf[64];
+    serializeJson(doc, buf);
+    LOG_INFO("BTN | %s | %s", button, action);
+    client.publish(topics.tele("button"), buf);
+}
+
+void Telemetry::publishSafetyTrip(uint8_t index, const char* reason, CentiCelsius temperature,
+                                  uint32_t trips) {
+    char celsius[CentiCelsius::FORMAT_SIZE];
+    StaticJsonDocument<128> doc;
+    if (zoneCount > 1) doc["zone"] = index + 1;
+    doc["reason"]      = reason;
+    doc["temperature"] = serialized(temperature.format(celsius, sizeof(celsius)));
+    doc["trips"]       = trips;
+    char buf[128];
+    serializeJson(doc, buf);
+    LOG_ERROR("SAFETY | zone %u | %s", index + 1, reason);
+    client.publish(topics.tele("safety"), buf);
+}
+
+void Telemetry::publishCommandLatency(const LatencyWindow& latency,
+                                      const CommandQueue::Stats& queue) {
+    LatencyWindow::Summary s = latency.summary();
+    StaticJsonDocument<320> doc;
+    doc["count"]    = s.count;
+    doc["lastUs"]   = s.last;
+    doc["minUs"]    = s.min;
+    doc["meanUs"]   = s.mean;
+    doc["p95Us"]    = s.p95;
+    doc["maxUs"]    = s.max;
+    doc["worstUs"]  = s.worst;
+    doc["window"]   = LatencyWindow::SIZE;
+    JsonObject q = doc.createNestedObject("queue");
+    q["depth"]     = queue.depth;
+    q["peak"]      = queue.peak;
+    q["size"]      = CommandQueue::SIZE;
+    q["queued"]    = queue.queued;
+    q["dropped"]   = queue.dropped;
+    q["preempted"] = queue.preempted;
+
+    // With every counter at 10 digits the payload is 258 B: sized like the
+    // document, and streamed past the 256-byte client buffer
+    char   buf[320];
+    size_t length = serializeJson(doc, buf, sizeof(buf));
+    if (!client.connected()) return;
+    bool sent = length < sizeof(buf) - 1 && client.beginPublish(topics.tele("commands"), length, false);
+    if (sent) {
+        sent = client.write((const uint8_t*)buf, length) == length;
+        sent = client.endPublish() && sent;
+    }
+    if (!sent) LOG_WARN("MQTT | command latency report (%u B) not published", (unsigned)length);
+}
+
+void Telemetry::publishCycleReport(uint8_t index, const CycleReport& r, const char* material) {
+    char overshoot[8], energy[12], rh[3][8];
+    StaticJsonDocument<512> doc;
+    doc["material"] = material;
+    if (zoneCount > 1) doc["zone"] = index + 1;
+    time_t now = time(nullptr);
+    if (now > 1600000000) doc["time"] = (uint32_t)now; // NTP has set the clock
+    doc["end"]       = DryerController::rule(r.endRule).name;
+    doc["resumed"]   = r.resumed;
+    doc["targetC"]   = r.targetC;
+    doc["targetMin"] = r.targetMs / 60000;
+    doc["durationS"] = r.durationMs / 1000;
+    if (r.reached) {
+        doc["timeToTargetS"] = r.timeToTargetMs / 1000;
+        doc["overshootC"]    = serialized(formatHundredths(overshoot, sizeof(overshoot),
+                                                           r.overshootDeciC * 10, 1));
+    }
+    doc["holdingS"]       = r.holdingMs / 1000;
+    doc["holdingDutyPct"] = r.holdingDutyPct();
+    doc["heaterOnS"]      = r.heaterOnMs / 1000;
+    doc["heaterCycles"] = r.heaterCycles;
+    doc["fanCycles"]    = r.fanCycles;
+    doc["energyWh"]       = serialized(formatHundredths(energy, sizeof(energy),
+                                                        r.energyDeciWh(BOARD.heaterW) * 10, 1));
+    JsonArray humidity = doc.createNestedArray("humidity"); // start, end, min
+    humidity.add(serialized(formatHundredths(rh[0], sizeof(rh[0]), r.humidityStartDeci * 10, 1)));
+    humidity.add(serialized(formatHundredths(rh[1], sizeof(rh[1]), r.humidityEndDeci * 10, 1)));
+    humidity.add(serialized(formatHundredths(rh[2], sizeof(rh[2]), r.humidityMinDeci * 10, 1)));
+    doc["safetyTrips"] = r.safetyTrips;
+
+    char   buf[512];
+    size_t length = serializeJson(doc, buf);
+
+    // One retained report per material (and zone), so the last PLA run
+    // stays next to the last PETG run
+    char leaf[48];
+    if (zoneCount > 1) snprintf(leaf, sizeof(leaf), "zone/%u/cycle/%s", index + 1, material);
+    else               snprintf(leaf, sizeof(leaf), "cycle/%s", material);
+    LOG_INFO("CYCLE | zone %u | %s ended (%s) after %u min", index + 1, material,
+             DryerController::rule(r.endRule).name, r.durationMs / 60000);
+
+    // Streamed: the report is larger than the client buffer
+    if (!client.beginPublish(topics.tele(leaf), length, true)) return;
+    client.write((const uint8_t*)buf, length);
+    client.endPublish();
+}
+
+// [[reading, reference], ...]; text holds the formatted numbers
+static void addPoints(JsonDocument& doc, const char* key, const CalibrationTable& table,
+                      char (*text)[8]) {
+    JsonArray points = doc.createNestedArray(key);
+    for (uint8_t i = 0; i < table.count(); i++) {
+        JsonArray p = points.createNestedArray();
+        p.add(serialized(formatHundredths(text[2 * i], 8, table.point(i).raw, 2)));
+        p.add(serialized(formatHundredths(text[2 * i + 1], 8, table.point(i).reference, 2)));
+    }
+}
+
+void Telemetry::publishCalibration(uint8_t index, const Calibration& cal, bool haveRaw,
+                                   CentiCelsius rawTemperature, CentiPercent rawHumidity) {
+    char temperature[2 * CalibrationTable::MAX_POINTS][8];
+    char humidity[2 * CalibrationTable::MAX_POINTS][8];
+    char raw[2][8];
+    StaticJsonDocument<1024> doc;
+    doc["zone"] = index + 1;
+    addPoints(doc, "temperature", cal.temperature, temperature);
+    addPoints(doc, "humidity", cal.humidity, humidity);
+    if (haveRaw) {
+        JsonObject reading = doc.createNestedObject("raw");
+        reading["temperature"] = serialized(rawTemperature.format(raw[0], sizeof(raw[0]), 2));
+        reading["humidity"]    = serialized(rawHumidity.format(raw[1], sizeof(raw[1]), 2));
+    }
+
+    char   buf[384];
+    size_t length = serializeJson(doc, buf);
+
+    char leaf[24];
+    if (zoneCount > 1) snprintf(leaf, sizeof(leaf), "zone/%u/calibration", index + 1);
+    else               snprintf(leaf, sizeof(leaf), "calibration");
+
+    // Streamed: six points each do not fit the client buffer
+    if (!client.beginPublish(topics.stat(leaf), length, true)) return;
+    client.write((const uint8_t*)buf, length);
+    client.endPublish();
+}
+
+// One history entry: [at,"FROM","TO","rule",temp]
+static int formatTransition(char* buf, size_t size, const TransitionRecord& t, bool comma) {
+    DryerController::RuleInfo rule = DryerController::rule(t.rule);
+    char celsius[8];
+    return snprintf(buf, size, "%s[%lu,\"%s\",\"%s\",\"%s\",%s]", comma ? "," : "",
+                    (unsigned long)t.atMs,
+                    DryerController::stateName((DryerState)t.from()),
+                    DryerController::stateName((DryerState)t.to()),
+                    rule.name, formatHundredths(celsius, sizeof(celsius), t.deciC * 10, 1));
+}
+
+void Telemetry::publishHistory(uint8_t index, const DryerController& dryer, uint8_t count) {
+    const TransitionHistory& history = dryer.getHistory();
+    if (count > history.count()) count = history.count();
+    uint8_t first = history.count() - count;
+
+    char head[128];
+    int  headLength = snprintf(head, sizeof(head),
+        "{\"zone\":%u,\"now\":%lu,\"total\":%lu,"
+        "\"fields\":[\"at\",\"from\",\"to\",\"rule\",\"temp\"],\"transitions\":[",
+        index + 1, (unsigned long)millis(), (unsigned long)history.total());
+    static const char tail[] = "]}";
+
+    // First pass only measures: MQTT needs the length before the payload
+    char     entry[80];
+    uint32_t length = headLength + sizeof(tail) - 1;
+    for (uint8_t i = 0; i < count; i++)
+        length += formatTransition(entry, sizeof(entry), history.at(first + i), i > 0);
+
+    const char* topic;
+    if (zoneCount > 1) {
+        char leaf[20];
+        snprintf(leaf, sizeof(leaf), "zone/%u/history", index + 1);
+        topic = topics.stat(leaf);
+    } else {
+        topic = topics.stat("history");
+    }
+
+    if (!client.beginPublish(topic, length, false)) return;
+    client.write((const uint8_t*)head, headLength);
+    for (uint8_t i = 0; i < count; i++) {
+        int n = formatTransition(entry, sizeof(entry), history.at(first + i), i > 0);
+        client.write((const uint8_t*)entry, n);
+    }
+    client.write((const uint8_t*)tail, sizeof(tail) - 1);
+    client.endPublish();
+}
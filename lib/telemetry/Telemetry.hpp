@@ -0,0 +1,43 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <Arduino.h>
+#include <MqttPublisher.hpp>
+#include <DryerZone.hpp>
+#include <Topics.hpp>
+#include <CommandQueue.hpp>
+#include <LatencyWindow.hpp>
+#include <Calibration.hpp>
+
+// Serialises zone state and button events onto tele/<device>/*.
+class Telemetry {
+public:
+    // With more than one zone, state goes to tele/<device>/zone/<n>/state
+    Telemetry(MqttPublisher& client, Topics& topics, uint8_t zoneCount);
+
+    void publishState(DryerZone& zone, uint8_t index);                // tele/<device>/state
+    void publishButtonEvent(const char* button, const char* action); // tele/<device>/button
+    void publishCommandLatency(const LatencyWindow& latency,
+                               const CommandQueue::Stats& queue);    // tele/<device>/commands
+    void publishSafetyTrip(uint8_t index, const char* reason, CentiCelsius temperature,
+                           uint32_t trips);                          // tele/<device>/safety
+
+    // KPIs of a finished cycle, retained per material   // tele/<device>/cycle/<material>
+    void publishCycleReport(uint8_t index, const CycleReport& report, const char* material);
+
+    // Last count state transitions of a zone, oldest first, streamed so the
+    // reply need not fit the client buffer                           // stat/<device>/history
+    void publishHistory(uint8_t index, const DryerController& dryer, uint8_t count);
+
+    // A zone's calibration points and, with haveRaw, its last reading before
+    // calibration; retained                                     // stat/<device>/calibration
+    void publishCalibration(uint8_t index, const Calibration& cal, bool haveRaw,
+                            CentiCelsius rawTemperature, CentiPercent rawHumidity);
+
+private:
+    MqttPublisher& client;
+    Topics&        topics;
+    uint8_t        zoneCount;
+};
+
+#endif // TELEMETRY_HPP
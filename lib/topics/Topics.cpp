@@ -0,0 +1,65 @@
+#include "Topics.hpp"
+
+Topics mqtt_topics;
+
+constexpr size_t  Topics::MAX_NAME;
+constexpr size_t  Topics::MAX_TOPIC;
+constexpr uint8_t Topics::MAX_EXTRAS;
+
+Topics::Topics() : subCount(0), extraCount(0) {
+    begin("dryer", "");
+}
+
+void Topics::begin(const char* device, const char* group) {
+    strncpy(deviceName, device, MAX_NAME);
+    deviceName[MAX_NAME] = '\0';
+    strncpy(groupName, group ? group : "", MAX_NAME);
+    groupName[MAX_NAME] = '\0';
+
+    subCount = 0;
+    snprintf(subs[subCount++], sizeof(subs[0]), "cmnd/%s/#", deviceName);
+    if (groupName[0]) snprintf(subs[subCount++], sizeof(subs[0]), "cmnd/group/%s/#", groupName);
+    snprintf(subs[subCount++], sizeof(subs[0]), "cmnd/all/#");
+}
+
+bool Topics::addSubscription(const char* filter) {
+    for (uint8_t i = 0; i < extraCount; i++)
+        if (strcmp(extras[i], filter) == 0) return true;
+    if (extraCount >= MAX_EXTRAS || strlen(filter) >= sizeof(extras[0])) return false;
+    strcpy(extras[extraCount++], filter);
+    return true;
+}
+
+const char* Topics::commandOf(const char* topic) const {
+    // subscriptions are stored as "<prefix>#"; match everything before the '#'
+    for (uint8_t i = 0; i < subCount; i++) {
+        const char* leaf = afterPrefix(topic, subs[i]);
+        if (leaf && *leaf) return leaf;
+    }
+    return nullptr;
+}
+
+const char* Topics::tele(const char* leaf) {
+    return tele(scratch, sizeof(scratch), leaf);
+}
+
+const char* Topics::stat(const char* leaf) {
+    return stat(scratch, sizeof(scratch), leaf);
+}
+
+const char* Topics::tele(char* buf, size_t size, const char* leaf) const {
+    snprintf(buf, size, "tele/%s/%s", deviceName, leaf);
+    return buf;
+}
+
+const char* Topics::stat(char* buf, size_t size, const char* leaf) const {
+    snprintf(buf, size, "stat/%s/%s", deviceName, leaf);
+    return buf;
+}
+
+const char* Topics::afterPrefix(const char* topic, const char* prefix) {
+    while (*prefix != '#') {
+        if (*topic++ != *prefix++) return nullptr;
+    }
+    return topic;
+}
@@ -0,0 +1,66 @@
+#ifndef TOPICS_HPP
+#define TOPICS_HPP
+
+#include <Arduino.h>
+
+// Per-device MQTT namespace.
+//
+// Each box listens on three wildcard subscriptions:
+//   cmnd/<device>/#         commands for this box only
+//   cmnd/group/<group>/#    commands for every box in its group (if set)
+//   cmnd/all/#              broadcast to the whole farm
+// and publishes telemetry under tele/<device>/, command results under
+// stat/<device>/. The broker does the fan-out;
+// a box never sees commands addressed to others.
+class Topics {
+public:
+    Topics();
+
+    // device must be non-empty; group may be empty (no group subscription)
+    void begin(const char* device, const char* group);
+
+    const char* device() const { return deviceName; }
+    const char* group()  const { return groupName; }
+
+    // Extra non-command filter (e.g. a power budget circuit); kept across
+    // begin() and ignored by commandOf(). Duplicates are ignored.
+    bool addSubscription(const char* filter);
+
+    uint8_t     subscriptionCount() const { return subCount + extraCount; }
+    const char* subscription(uint8_t i) const {
+        return i < subCount ? subs[i] : extras[i - subCount];
+    }
+
+    // Command leaf of an incoming topic ("filament", "control", ...), or
+    // nullptr if the topic isn't addressed to this box.
+    const char* commandOf(const char* topic) const;
+
+    // tele/<device>/<leaf> and stat/<device>/<leaf> (command results);
+    // the pointer is valid until the next call of either. One shared buffer:
+    // with DRYER_TASKS only the control task may use these.
+    const char* tele(const char* leaf);
+    const char* stat(const char* leaf);
+
+    // Same into the caller's buffer, for any task
+    const char* tele(char* buf, size_t size, const char* leaf) const;
+    const char* stat(char* buf, size_t size, const char* leaf) const;
+
+    static constexpr size_t  MAX_NAME   = 32;
+    static constexpr size_t  MAX_TOPIC  = MAX_NAME + 32; // buffer size for tele()/stat()
+    static constexpr uint8_t MAX_EXTRAS = 2;
+
+private:
+    char    deviceName[MAX_NAME + 1];
+    char    groupName[MAX_NAME + 1];
+    char    subs[3][MAX_NAME + 16];
+    uint8_t subCount;
+    char    extras[MAX_EXTRAS][MAX_NAME + 32];
+    uint8_t extraCount;
+    char    scratch[MAX_TOPIC];
+
+    static const char* afterPrefix(const char* topic, const char* prefix);
+};
+
+extern Topics mqtt_topics;
+
+#endif // TOPICS_HPP
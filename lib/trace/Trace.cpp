@@ -0,0 +1,196 @@
+#include "Trace.hpp"
+#include <Topics.hpp>
+
+constexpr uint16_t TraceRecorder::SIZE;
+constexpr uint16_t TraceRecorder::MAX_RECORD;
+constexpr uint8_t  TraceRecorder::MAX_TOPIC;
+constexpr uint8_t  TraceRecorder::FORMAT;
+
+static void put8(uint8_t* b, uint16_t& n, uint8_t v) { b[n++] = v; }
+
+static void put16(uint8_t* b, uint16_t& n, uint16_t v) {
+    b[n++] = v;
+    b[n++] = v >> 8;
+}
+
+static void put32(uint8_t* b, uint16_t& n, uint32_t v) {
+    for (uint8_t i = 0; i < 4; i++) b[n++] = v >> (8 * i);
+}
+
+static void putVar(uint8_t* b, uint16_t& n, uint32_t v) {
+    while (v >= 0x80) {
+        b[n++] = (v & 0x7F) | 0x80;
+        v >>= 7;
+    }
+    b[n++] = v;
+}
+
+static void putName(uint8_t* b, uint16_t& n, const char* s) {
+    uint8_t length = strnlen(s, Topics::MAX_NAME);
+    b[n++] = length;
+    memcpy(b + n, s, length);
+    n += length;
+}
+
+TraceRecorder::TraceRecorder(DryerZone* zones, uint8_t zoneCount)
+    : zones(zones), zoneCount(zoneCount), active(false), lastMs(0), head(0), tail(0),
+      stored(0), droppedSince(0), droppedTotal(0)
+{
+    memset(seen, 0, sizeof(seen));
+}
+
+uint8_t TraceRecorder::outputsOf(DryerZone& zone) {
+    return (zone.heaterRelay.getState() ? TRACE_HEATER : 0) |
+           (zone.fanRelay.getState() ? TRACE_FAN : 0);
+}
+
+TraceRecorder::Seen TraceRecorder::snapshot(uint8_t zone) {
+    DryerZone& z = zones[zone];
+    return {z.sensor.getTemperature().deci(), z.sensor.getHumidity().deci(),
+            static_cast<uint8_t>(z.controller.getState()), outputsOf(z)};
+}
+
+void TraceRecorder::start(const char* device, const char* group) {
+    head = tail = stored = 0;
+    droppedSince = 0;
+    lastMs = millis();
+    active = true;
+
+    uint8_t  body[MAX_RECORD];
+    uint16_t n = 0;
+    put8(body, n, 'D');
+    put8(body, n, 'T');
+    put8(body, n, FORMAT);
+    put8(body, n, zoneCount);
+    put32(body, n, lastMs);
+    putName(body, n, device);
+    putName(body, n, group);
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        DryerZone& z = zones[i];
+        seen[i] = snapshot(i);
+        put8(body, n, seen[i].state);
+        put8(body, n, z.controller.getActivePreset());
+        put8(body, n, z.heater.getTargetTemperature());
+        put32(body, n, z.heater.getTargetTime());
+        put32(body, n, z.heater.getElapsedTime());
+        put16(body, n, seen[i].deciC);
+        put16(body, n, seen[i].deciRH);
+        put8(body, n, seen[i].outputs);
+    }
+    commit(TraceType::HEADER, body, n);
+}
+
+void TraceRecorder::sensed(uint8_t zone) {
+    if (!active) return;
+    Seen now = snapshot(zone);
+    if (now.deciC == seen[zone].deciC && now.deciRH == seen[zone].deciRH) return;
+    seen[zone].deciC  = now.deciC;
+    seen[zone].deciRH = now.deciRH;
+
+    uint8_t  body[5];
+    uint16_t n = 0;
+    put8(body, n, zone);
+    put16(body, n, now.deciC);
+    put16(body, n, now.deciRH);
+    commit(TraceType::SENSOR, body, n);
+}
+
+void TraceRecorder::tick(uint8_t zone, bool hold, bool blocked) {
+    if (!active) return;
+    uint8_t body[2] = {zone, (uint8_t)((hold ? TRACE_HOLD : 0) | (blocked ? TRACE_BLOCKED : 0))};
+    commit(TraceType::TICK, body, sizeof(body));
+    settle();
+}
+
+void TraceRecorder::button(uint8_t zone, TraceButton action, uint8_t preset) {
+    if (!active) return;
+    uint8_t body[3] = {zone, static_cast<uint8_t>(action), preset};
+    commit(TraceType::BUTTON, body, sizeof(body));
+}
+
+void TraceRecorder::command(const char* topic, const uint8_t* payload, unsigned int length) {
+    if (!active) return;
+    uint8_t topicLength = strnlen(topic, MAX_TOPIC);
+    if (topicLength == MAX_TOPIC || 1 + topicLength + 2 + length > MAX_RECORD) {
+        // Cut short it would replay as a different command
+        droppedSince++;
+        droppedTotal++;
+        return;
+    }
+    uint8_t  body[MAX_RECORD];
+    uint16_t n = 0;
+    put8(body, n, topicLength);
+    memcpy(body + n, topic, topicLength);
+    n += topicLength;
+    put16(body, n, length);
+    memcpy(body + n, payload, length);
+    n += length;
+    commit(TraceType::COMMAND, body, n);
+}
+
+void TraceRecorder::settle() {
+    if (!active) return;
+    for (uint8_t i = 0; i < zoneCount; i++) {
+        Seen now = snapshot(i);
+        if (now.state == seen[i].state && now.outputs == seen[i].outputs) continue;
+        seen[i].state   = now.state;
+        seen[i].outputs = now.outputs;
+        uint8_t body[3] = {i, now.state, now.outputs};
+        commit(TraceType::RESULT, body, sizeof(body));
+    }
+}
+
+// Type and time delta are added here, so a GAP can go first and keep the
+// deltas adding up
+void TraceRecorder::commit(TraceType type, const uint8_t* body, uint16_t size) {
+    uint32_t now = millis();
+    uint8_t  record[MAX_RECORD + 6];
+    uint16_t n = 0;
+
+    if (droppedSince) {
+        put8(record, n, static_cast<uint8_t>(TraceType::GAP));
+        putVar(record, n, now - lastMs);
+        putVar(record, n, droppedSince);
+        if (!push(record, n)) {
+            droppedSince++;
+            droppedTotal++;
+            return;
+        }
+        droppedSince = 0;
+        lastMs = now;
+        n = 0;
+    }
+
+    put8(record, n, static_cast<uint8_t>(type));
+    putVar(record, n, now - lastMs);
+    memcpy(record + n, body, size);
+    n += size;
+    if (!push(record, n)) {
+        droppedSince++;
+        droppedTotal++;
+        return;
+    }
+    lastMs = now;
+}
+
+bool TraceRecorder::push(const uint8_t* bytes, uint16_t size) {
+    if (size > SIZE - stored) return false;
+    for (uint16_t i = 0; i < size; i++) {
+        ring[head] = bytes[i];
+        head = (head + 1) % SIZE;
+    }
+    stored += size;
+    return true;
+}
+
+uint16_t TraceRecorder::peek(uint8_t* out, uint16_t max) const {
+    uint16_t count = stored < max ? stored : max;
+    for (uint16_t i = 0; i < count; i++) out[i] = ring[(tail + i) % SIZE];
+    return count;
+}
+
+void TraceRecorder::consume(uint16_t count) {
+    if (count > stored) count = stored;
+    tail = (tail + count) % SIZE;
+    stored -= count;
+}
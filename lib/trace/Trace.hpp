@@ -0,0 +1,92 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <Arduino.h>
+#include <DryerZone.hpp>
+
+// Session trace: every input the control logic sees (sensor readings, control
+// ticks, button actions, MQTT commands) and the states and relay outputs that
+// followed, so host/replay can feed a real session through the controller
+// again and diff the outcome.
+//
+// Record: type u8, ms since the previous record (LEB128), then the body,
+// little-endian. A trace starts with HEADER; RESULT records follow the input
+// that caused them.
+enum class TraceType : uint8_t {
+    HEADER  = 'H', // 'D' 'T' FORMAT, zones u8, millis u32, device and group (u8 length + bytes),
+                   // per zone: state u8, preset u8, targetC u8, targetMs u32, elapsedMs u32,
+                   //           deciC i16, deciRH i16, outputs u8
+    SENSOR  = 'S', // zone u8, deciC i16, deciRH i16; only when the reading changed
+    TICK    = 'T', // zone u8, flags u8 (TRACE_HOLD, TRACE_BLOCKED); the control tick ran
+    BUTTON  = 'B', // zone u8, TraceButton u8, preset u8
+    COMMAND = 'C', // topic (u8 length + bytes), payload (u16 length + bytes)
+    RESULT  = 'R', // zone u8, state u8, outputs u8 (TRACE_HEATER, TRACE_FAN)
+    GAP     = 'G', // records lost to a full ring (LEB128)
+};
+
+enum class TraceButton : uint8_t { START = 1, STOP };
+
+// TICK flags: safety supervisor hold, heater refused by the power budget
+constexpr uint8_t TRACE_HOLD    = 0x01;
+constexpr uint8_t TRACE_BLOCKED = 0x02;
+
+// RESULT / HEADER relay bits
+constexpr uint8_t TRACE_HEATER = 0x01;
+constexpr uint8_t TRACE_FAN    = 0x02;
+
+// Records into a byte ring while active; the owner ships the bytes
+// (peek()/consume()) over whatever transport it has. Hooks cost a flag test
+// while inactive. Not for use from interrupts.
+class TraceRecorder {
+public:
+    static constexpr uint16_t SIZE       = 1024;
+    static constexpr uint16_t MAX_RECORD = 320;
+    static constexpr uint8_t  MAX_TOPIC  = 96;
+    static constexpr uint8_t  FORMAT     = 1;
+
+    TraceRecorder(DryerZone* zones, uint8_t zoneCount);
+
+    // Clears anything unsent and writes a HEADER with every zone's state
+    void start(const char* device, const char* group);
+    void stop() { active = false; }
+    bool isActive() const { return active; }
+
+    void sensed(uint8_t zone);                            // after a sensor read
+    void tick(uint8_t zone, bool hold, bool blocked);     // after the controller's update(); settles
+    void button(uint8_t zone, TraceButton action, uint8_t preset);
+    void command(const char* topic, const uint8_t* payload, unsigned int length);
+    void settle();                                        // RESULT for zones that changed
+
+    uint16_t pending() const { return stored; }
+    uint16_t peek(uint8_t* out, uint16_t max) const;      // oldest bytes, not removed
+    void     consume(uint16_t count);
+    uint32_t dropped() const { return droppedTotal; }
+
+    static uint8_t outputsOf(DryerZone& zone);
+
+private:
+    struct Seen {
+        int16_t deciC;
+        int16_t deciRH;
+        uint8_t state;
+        uint8_t outputs;
+    };
+
+    DryerZone* zones;
+    uint8_t    zoneCount;
+    bool       active;
+    uint32_t   lastMs;
+    uint8_t    ring[SIZE];
+    uint16_t   head;
+    uint16_t   tail;
+    uint16_t   stored;
+    uint32_t   droppedSince;
+    uint32_t   droppedTotal;
+    Seen       seen[BoardProfile::MAX_ZONES];
+
+    void commit(TraceType type, const uint8_t* body, uint16_t size);
+    bool push(const uint8_t* bytes, uint16_t size);
+    Seen snapshot(uint8_t zone);
+};
+
+#endif // TRACE_HPP
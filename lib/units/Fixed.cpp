@@ -0,0 +1,51 @@
+#include "Fixed.hpp"
+
+const char* formatHundredths(char* buf, size_t size, int32_t hundredths, uint8_t decimals) {
+    if (!size) return buf;
+    if (decimals > 2) decimals = 2;
+
+    static const uint8_t per[] = {100, 10, 1};
+    uint32_t magnitude = hundredths < 0 ? -(uint32_t)hundredths : hundredths;
+    magnitude = (magnitude + per[decimals] / 2) / per[decimals];
+    bool negative = hundredths < 0 && magnitude; // no "-0.0"
+
+    // Digits backwards, the decimal point after the first `decimals` of them
+    char    digits[16];
+    uint8_t n = 0;
+    do {
+        if (n == decimals && decimals) digits[n++] = '.';
+        digits[n++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude || n <= decimals);
+    if (negative) digits[n++] = '-';
+
+    size_t length = 0;
+    while (n && length + 1 < size) buf[length++] = digits[--n];
+    buf[length] = '\0';
+    return buf;
+}
+
+bool parseHundredths(const char* text, int32_t& hundredths) {
+    if (!text) return false;
+    bool negative = *text == '-';
+    if (negative) text++;
+
+    int32_t value = 0;
+    uint8_t whole = 0, decimals = 0;
+    for (; *text >= '0' && *text <= '9'; text++, whole++) {
+        if (whole == 5) return false;
+        value = value * 10 + (*text - '0');
+    }
+    if (*text == '.') {
+        for (text++; *text >= '0' && *text <= '9'; text++, decimals++) {
+            if (decimals == 2) return false;
+            value = value * 10 + (*text - '0');
+        }
+        if (!decimals) return false; // "24."
+    }
+    if (*text || !whole) return false;
+    for (; decimals < 2; decimals++) value *= 10;
+
+    hundredths = negative ? -value : value;
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef FIXED_HPP
+#define FIXED_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Writes hundredths as a decimal number with 0..2 decimals, rounded half
+// away from zero ("-0.5" for -50 and 1 decimal, "-1" for -50 and none).
+// Integer arithmetic only; returns buf.
+const char* formatHundredths(char* buf, size_t size, int32_t hundredths, uint8_t decimals);
+
+// Reads "-12", "24.5" or "0.25" as hundredths: an optional sign, up to five
+// digits and at most two decimals, nothing else. Integer arithmetic only;
+// false (and hundredths untouched) for anything else.
+bool parseHundredths(const char* text, int32_t& hundredths);
+
+// A reading in hundredths of its unit. The ESP8266 has no FPU, so sensing,
+// control, telemetry and display pass these around instead of float; the
+// tag keeps a temperature from being compared with a humidity.
+template <typename Tag>
+class Centi {
+public:
+    constexpr Centi() : value(0) {}
+
+    static constexpr Centi fromCenti(int16_t centi) { return Centi(centi); }
+    static constexpr Centi fromDeci(int16_t deci) { return Centi(deci * 10); }
+    static constexpr Centi fromWhole(int16_t whole) { return Centi(whole * 100); }
+
+    constexpr int16_t centi() const { return value; }
+    constexpr int16_t deci() const { return rounded(10); }
+    constexpr int16_t whole() const { return rounded(100); }
+
+    // FORMAT_SIZE fits "-327.68"
+    const char* format(char* buf, size_t size, uint8_t decimals = 1) const {
+        return formatHundredths(buf, size, value, decimals);
+    }
+    static constexpr size_t FORMAT_SIZE = 8;
+
+    constexpr bool operator==(Centi o) const { return value == o.value; }
+    constexpr bool operator!=(Centi o) const { return value != o.value; }
+    constexpr bool operator<(Centi o) const { return value < o.value; }
+    constexpr bool operator<=(Centi o) const { return value <= o.value; }
+    constexpr bool operator>(Centi o) const { return value > o.value; }
+    constexpr bool operator>=(Centi o) const { return value >= o.value; }
+
+private:
+    int16_t value;
+
+    constexpr explicit Centi(int16_t v) : value(v) {}
+    constexpr int16_t rounded(int16_t per) const {
+        return (int16_t)(value >= 0 ? (value + per / 2) / per : (value - per / 2) / per);
+    }
+};
+
+template <typename Tag>
+constexpr size_t Centi<Tag>::FORMAT_SIZE;
+
+struct CelsiusTag {};
+struct PercentTag {};
+
+typedef Centi<CelsiusTag> CentiCelsius; // °C × 100
+typedef Centi<PercentTag> CentiPercent; // %RH × 100
+
+#endif // FIXED_HPP
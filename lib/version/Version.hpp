@@ -0,0 +1,9 @@
+#ifndef VERSION_HPP
+#define VERSION_HPP
+
+// Overridden from the build (-DFIRMWARE_VERSION=\"...\") for release images
+#ifndef FIRMWARE_VERSION
+#define FIRMWARE_VERSION "0.3.0-dev"
+#endif
+
+#endif // VERSION_HPP
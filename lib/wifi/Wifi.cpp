@@ -1,21 +1,21 @@
 #include "Wifi.hpp"
-#include <ESP8266WiFi.h>
+#include <Platform.hpp>
+#include <Log.hpp>
 
 bool connectToWifi(const NetworkCredentials& creds, unsigned long timeoutMs) {
     WiFi.mode(WIFI_STA);
     WiFi.begin(creds.wifiSSID.c_str(), creds.wifiPassword.c_str());
 
-    Serial.print("Connecting to WiFi");
+    LOG_INFO("WIFI | connecting to %s", creds.wifiSSID.c_str());
     unsigned long start = millis();
     while (WiFi.status() != WL_CONNECTED) {
         if (millis() - start >= timeoutMs) {
-            Serial.println("\nWiFi connection timed out.");
+            LOG_ERROR("WIFI | connection timed out");
             return false;
         }
+        log_buffer.drain();
         delay(500);
-        Serial.print(".");
     }
-    Serial.print("\nWiFi connected. IP: ");
-    Serial.println(WiFi.localIP().toString());
+    LOG_INFO("WIFI | connected, IP %s", WiFi.localIP().toString().c_str());
     return true;
 }
@@ -1,119 +1,434 @@
 #include <Arduino.h>
-#include <ArduinoJson.h>
-#include <TempHumidity.hpp>
 #include <Wifi.hpp>
 #include <Mqtt.hpp>
-#include <Relais.hpp>
-#include <NcRelay.hpp>
 #include <FilamentSettings.hpp>
-#include <HeaterSettings.hpp>
-#include <DryerController.hpp>
+#include <DryerZone.hpp>
 #include <Provisioning.hpp>
 #include <DisplayManager.hpp>
 #include <Button.hpp>
+#include <CommandDispatcher.hpp>
+#include <Telemetry.hpp>
+#include <CycleCheckpoint.hpp>
+#include <CalibrationStore.hpp>
+#include <MemoryHealth.hpp>
+#include <LoopWatchdog.hpp>
+#include <AllocationTracker.hpp>
+#include <PowerBudget.hpp>
+#include <IdlePower.hpp>
+#include <FirmwareUpdate.hpp>
+#include <SafetySupervisor.hpp>
+#include <Log.hpp>
+#include <SyslogSink.hpp>
+#include <MqttLogSink.hpp>
+#include <Trace.hpp>
+#include <MessageRing.hpp>
+#include <Snapshot.hpp>
 #include <Pins.hpp>
+#include <time.h>
+
+#if DRYER_TASKS && !defined(ESP32)
+#error "DRYER_TASKS needs the ESP32"
+#endif
+
+#if DRYER_TASKS
+// Only the network task touches mqtt_client: the rest publishes into the
+// outbox, and what arrives is queued in the inbox for the control task
+uint8_t        outboxStorage[8192];
+uint8_t        inboxStorage[1024];
+MessageRing    outbox(outboxStorage, sizeof(outboxStorage));
+MessageRing    inbox(inboxStorage, sizeof(inboxStorage));
+MqttPublisher& publisher = outbox;
+
+void startTasks(); // end of file
+#else
+MqttPublisher& publisher = mqtt_client;
+#endif
+
+// Zones are statically allocated; each entry binds to its ZONE_PINS row
+DryerZone zones[DRYER_ZONE_COUNT] = {
+  {ZONE_PINS[0]},
+#if DRYER_ZONE_COUNT > 1
+  {ZONE_PINS[1]},
+#endif
+};
+
+CycleCheckpoint checkpoints[DRYER_ZONE_COUNT] = {
+  {zones[0].controller, zones[0].heater, 0},
+#if DRYER_ZONE_COUNT > 1
+  {zones[1].controller, zones[1].heater, 1},
+#endif
+};
+
+// Only take part in a shared power budget when one is configured
+PowerBudget powerBudgets[DRYER_ZONE_COUNT] = {
+  {publisher},
+#if DRYER_ZONE_COUNT > 1
+  {publisher},
+#endif
+};
 
-TempHumidity    tempHumidity(DHTPIN, DHTTYPE);
-HeaterSettings  heater(tempHumidity);
-Relais          heaterRelay(HEATER_RELAIS_PIN, "Heater");
-NcRelay         fanRelay(FAN_RELAIS_PIN, "Fan");
-DryerController dryer(heater, heaterRelay, fanRelay, tempHumidity);
 Provisioning    provisioning;
-DisplayManager  display(DISPLAY_SDA_PIN, DISPLAY_SCL_PIN);
-Button          btnPreset(BUTTON_PRESET_PIN);
-Button          btnStart(BUTTON_START_PIN);
+DisplayManager  display(BOARD.displaySda, BOARD.displayScl);
+Button          btnPreset(BOARD.buttonPreset);
+Button          btnStart(BOARD.buttonStart);
 bool            bootCountCleared = false;
 
 // TestFilament (last entry) is excluded from button cycling
 constexpr uint8_t NUM_PRESETS = (sizeof(filamentSettings) / sizeof(filamentSettings[0])) - 1;
 uint8_t selectedPresetIndex = 0;
+uint8_t displayedZone       = 0; // zone shown on the OLED and driven by the buttons
 
-void mqttCallback(char *topic, byte *payload, unsigned int length) {
-  char message[length + 1];
-  memcpy(message, payload, length);
-  message[length] = '\0';
+// While a cycle runs SELECT flips between the status and the trend page
+enum class DisplayPage : uint8_t { STATUS, TREND };
+DisplayPage displayPage = DisplayPage::STATUS;
 
-  String topicStr(topic);
-  Serial.printf("MQTT | %s | %s\n", topic, message);
+// What the OLED shows of a zone, and what it shows it with. Plain copies, so
+// the drawing can run in a task of its own (Snapshot).
+struct ZoneStatus {
+  char         state[12];
+  CentiCelsius temperature;
+  CentiPercent humidity;
+  uint8_t      target;
+  uint32_t     remainingMin;
+  bool         heater;
+  bool         fan;
+  bool         idle;
+};
 
-  StaticJsonDocument<128> doc;
-  if (deserializeJson(doc, message)) {
-    Serial.println("MQTT | JSON parse error");
-    return;
+struct PanelState {
+  uint8_t     zone;
+  uint8_t     preset;
+  DisplayPage page;
+  uint8_t     contrast; // IdlePower::getContrast(), 0 = off
+
+  bool operator!=(const PanelState& o) const {
+    return zone != o.zone || preset != o.preset || page != o.page || contrast != o.contrast;
   }
+};
 
-  if (topicStr == "cmnd/dryer/filament") {
-    const char* material = doc["material"];
-    if (material) {
-      for (const auto &s : filamentSettings) {
-        if (s.material.equalsIgnoreCase(material)) {
-          dryer.applyFilamentPreset(s.temperature, s.time);
-          Serial.printf("Preset applied: %s\n", material);
-          break;
-        }
-      }
-    }
+// Owned by whoever draws: loop(), or the display task
+TrendHistory trends[DRYER_ZONE_COUNT];
+
+// Zones are ticked round-robin, each once per TICK_MS, spread evenly so DHT
+// reads and publishes of different zones never pile up in one loop pass
+constexpr uint32_t TICK_MS = 1000;
+constexpr uint32_t SLOT_MS = TICK_MS / DRYER_ZONE_COUNT;
+
+// Command latency stats go out at most this often, and only after new commands
+constexpr uint32_t COMMAND_STATS_MS = 60000;
+
+FirmwareUpdate firmwareUpdate(zones, DRYER_ZONE_COUNT, publisher, mqtt_topics);
+
+// Serial always; syslog and MQTT only when asked for over cmnd/<device>/config
+SerialLogSink serialLog;
+SyslogSink    syslogSink(mqtt_topics);
+MqttLogSink   mqttLog(publisher, mqtt_topics);
+
+// Session trace for host/replay, streamed on tele/<device>/trace while on
+TraceRecorder trace(zones, DRYER_ZONE_COUNT);
+constexpr uint8_t TRACE_BATCH = 192;
+
+Telemetry         telemetry(publisher, mqtt_topics, DRYER_ZONE_COUNT);
+
+// {"action": "log"[, "level": "debug"][, "syslog": "host[:port]" or ""][, "mqtt": true|false]}
+CommandResult configureLog(JsonDocument& doc) {
+  const char* level = doc["level"];
+  if (level) {
+    LogLevel l;
+    if (!LogBuffer::levelFromName(level, l)) return CommandResult::INVALID;
+    log_buffer.setLevel(l);
   }
-  else if (topicStr == "cmnd/dryer/control") {
-    const char* action = doc["action"];
-    if (action) {
-      if (String(action).equalsIgnoreCase("stop"))
-        dryer.reset();   // heater off, fan cools until <30 °C
-      else if (String(action).equalsIgnoreCase("abort"))
-        dryer.abort();   // everything off immediately
-    }
+  if (doc.containsKey("syslog")) {
+    const char* server = doc["syslog"] | "";
+    log_buffer.removeSink(&syslogSink);
+    if (server[0] && !(syslogSink.begin(server) && log_buffer.addSink(&syslogSink)))
+      return CommandResult::INVALID;
   }
-  else if (topicStr == "cmnd/dryer/heater") {
-    const char* state = doc["state"];
-    if (state) dryer.setManualHeater(String(state).equalsIgnoreCase("on"));
+  if (doc.containsKey("mqtt")) {
+    log_buffer.removeSink(&mqttLog);
+    if ((doc["mqtt"] | false) && !log_buffer.addSink(&mqttLog)) return CommandResult::INVALID;
   }
-  else if (topicStr == "cmnd/dryer/fan") {
-    const char* state = doc["state"];
-    if (state) dryer.setManualFan(String(state).equalsIgnoreCase("on"));
+  return CommandResult::OK;
+}
+
+// °C or %RH as hundredths: a JSON number (24, 24.5) or a decimal string
+// ("24.5"). ArduinoJson has already read a fractional number as float, so
+// that one is rounded here; whole numbers and strings stay integer
+bool toCenti(JsonVariant value, int16_t& centi) {
+  int32_t hundredths;
+  if (value.is<long>()) {
+    long whole = value.as<long>();
+    if (whole <= -300 || whole >= 300) return false;
+    hundredths = whole * 100;
+  } else if (value.is<float>()) {
+    float f = value.as<float>();
+    if (!(f > -300.0f && f < 300.0f)) return false;
+    hundredths = lroundf(f * 100);
+  } else if (!parseHundredths(value.as<const char*>(), hundredths) ||
+             hundredths <= -30000 || hundredths >= 30000) {
+    return false;
   }
-  else if (topicStr == "cmnd/dryer/config") {
-    const char* action = doc["action"];
-    if (action && String(action).equalsIgnoreCase("reset")) {
-      Provisioning::clearCredentials();
-      delay(500);
-      ESP.restart();
-    }
+  centi = (int16_t)hundredths;
+  return true;
+}
+
+// [[reading, reference], ...]; [] clears the table
+bool readPoints(JsonVariant list, CalibrationTable& table) {
+  JsonArray pairs = list.as<JsonArray>();
+  if (pairs.isNull() || pairs.size() > CalibrationTable::MAX_POINTS) return false;
+  CalibrationTable::Point points[CalibrationTable::MAX_POINTS];
+  uint8_t count = 0;
+  for (JsonVariant pair : pairs) {
+    CalibrationTable::Point& p = points[count++];
+    if (pair.size() != 2 || !toCenti(pair[0], p.raw) || !toCenti(pair[1], p.reference)) return false;
   }
+  return table.set(points, count);
 }
 
-void publishDryerState() {
-  StaticJsonDocument<300> doc;
-  doc["state"]              = dryer.getStateName();
-  doc["humidity"]           = tempHumidity.getHumidity();
-  doc["currentTemperature"] = tempHumidity.getTemperature();
-  doc["targetTemperature"]  = heater.getTargetTemperature();
-  doc["remainingTime"]      = heater.computeRemainingTime() / 60000;
-  doc["heaterState"]        = heaterRelay.getState();
-  doc["fanState"]           = fanRelay.getState();
+// {"action": "calibrate"[, "zone": n][, "temperature": [[reading, reference], ...]]
+// [, "humidity": [...]][, "reference": {"temperature": t, "humidity": h}]}
+// "reference" pairs what a reference instrument reads now with the zone's last
+// raw reading. Applied and saved only if all of it is valid; always reported
+// on stat/<device>/calibration.
+CommandResult configureCalibration(JsonDocument& doc) {
+  int zone = doc["zone"] | 1;
+  if (zone < 1 || zone > DRYER_ZONE_COUNT) return CommandResult::NO_SUCH_ZONE;
+  TempHumidity& sensor = zones[zone - 1].sensor;
+  Calibration   cal    = sensor.getCalibration();
+  bool          change = false;
 
-  char buffer[512];
-  serializeJson(doc, buffer);
-  mqtt_client.publish("tele/dryer/state", buffer);
+  if (doc.containsKey("temperature")) {
+    if (!readPoints(doc["temperature"], cal.temperature)) return CommandResult::INVALID;
+    change = true;
+  }
+  if (doc.containsKey("humidity")) {
+    if (!readPoints(doc["humidity"], cal.humidity)) return CommandResult::INVALID;
+    change = true;
+  }
+  JsonObject reference = doc["reference"];
+  if (!reference.isNull()) {
+    if (!sensor.hasReading()) return CommandResult::INVALID;
+    int16_t value;
+    // The default offset was never measured; the first reference replaces it
+    if (reference.containsKey("temperature") && cal.isDefaultTemperature()) cal.temperature.clear();
+    if (reference.containsKey("temperature") &&
+        !(toCenti(reference["temperature"], value) &&
+          cal.temperature.add({sensor.getRawTemperature().centi(), value})))
+      return CommandResult::INVALID;
+    if (reference.containsKey("humidity") &&
+        !(toCenti(reference["humidity"], value) &&
+          cal.humidity.add({sensor.getRawHumidity().centi(), value})))
+      return CommandResult::INVALID;
+    change = true;
+  }
+
+  if (change) {
+    sensor.getCalibration() = cal;
+    if (!CalibrationStore::save(zone - 1, cal)) LOG_ERROR("CALIBRATION | zone %d not saved", zone);
+    LOG_INFO("CALIBRATION | zone %d: %u temperature, %u humidity points", zone,
+             cal.temperature.count(), cal.humidity.count());
+  }
+  telemetry.publishCalibration(zone - 1, cal, sensor.hasReading(), sensor.getRawTemperature(),
+                               sensor.getRawHumidity());
+  return CommandResult::OK;
 }
 
-void updateDisplay() {
-  bool idle = (dryer.getState() == DryerState::IDLE);
-  const FilamentSetting& preset = filamentSettings[selectedPresetIndex];
+// cmnd/<device>/config {"action": "reset"}, {"action": "update"[, "url": manifest][, "force": true]}
+// {"action": "trace", "on": true|false}, {"action": "log", ...} (see configureLog) or
+// {"action": "calibrate", ...} (see configureCalibration)
+CommandResult handleConfig(const char* action, JsonDocument& doc) {
+  if (!strcasecmp(action, "reset")) {
+    Provisioning::clearCredentials();
+    log_buffer.flush();
+    delay(500);
+    ESP.restart();
+  }
+  if (!strcasecmp(action, "update")) {
+    // Runs from tickSystem() once every heater is off
+    return firmwareUpdate.request(doc["url"] | "", doc["force"] | false)
+      ? CommandResult::OK : CommandResult::INVALID;
+  }
+  if (!strcasecmp(action, "log")) return configureLog(doc);
+  if (!strcasecmp(action, "calibrate")) return configureCalibration(doc);
+  if (!strcasecmp(action, "trace")) {
+    if (doc["on"] | false) trace.start(mqtt_topics.device(), mqtt_topics.group());
+    else                   trace.stop();
+    return CommandResult::OK;
+  }
+  return CommandResult::INVALID;
+}
+
+// cmnd/<device>[/zone/<n>]/history {"count": N} → stat/<device>[/zone/<n>]/history
+void handleHistory(uint8_t zone, uint8_t count) {
+  telemetry.publishHistory(zone, zones[zone].controller, count);
+}
+
+CommandDispatcher commands(zones, DRYER_ZONE_COUNT, mqtt_topics, handleConfig, handleHistory);
+MemoryHealth      memoryHealth(publisher, mqtt_topics);
+LoopWatchdog      watchdog(publisher, mqtt_topics);
+IdlePower         idlePower(publisher, mqtt_topics);
+SafetySupervisor  safety;
+
+void mqttCallback(char *topic, byte *payload, unsigned int length) {
+  // Budget announcements concern every zone; anything else is a command
+  bool power = false;
+  for (uint8_t i = 0; i < DRYER_ZONE_COUNT; i++) {
+    power |= powerBudgets[i].handle(topic, payload, length);
+  }
+  if (power) return;
+
+  if (mqtt_topics.commandOf(topic)) {
+    idlePower.activity();
+    trace.command(topic, payload, length);
+  }
+  if (commands.dispatch(topic, payload, length)) {
+    publisher.publish(mqtt_topics.stat("ack"), commands.ack());
+  }
+  trace.settle();
+}
+
+#if DRYER_TASKS
+// Network task: what arrives waits in the inbox for the control task
+void queueIncoming(char* topic, byte* payload, unsigned int length) {
+  if (!inbox.publish(topic, payload, length)) LOG_WARN("MQTT | inbox full, dropped %s", topic);
+}
+
+// Control task: the inbox through the same callback the ESP8266 build registers
+void receive() {
+  static MessageRing::Message message;
+  static uint8_t              payload[MQTT_MAX_PACKET_SIZE];
+  while (inbox.pop(message, payload, sizeof(payload))) {
+    if (message.length <= sizeof(payload)) mqttCallback(message.topic, payload, message.length);
+  }
+}
+#endif
+
+// Commands queued by mqttCallback take effect here, every one of them in the same tick
+void applyCommands() {
+  while (commands.pending()) {
+    if (commands.applyNext()) publisher.publish(mqtt_topics.stat("ack"), commands.ack());
+  }
+}
+
+// Sent as produced; what a disconnect holds back waits in the ring
+void publishTrace() {
+  uint8_t batch[TRACE_BATCH];
+  while (trace.pending() && publisher.connected()) {
+    uint16_t n = trace.peek(batch, sizeof(batch));
+    if (!publisher.publish(mqtt_topics.tele("trace"), batch, n)) break;
+    trace.consume(n);
+  }
+}
+
+void setupPowerBudget(const NetworkCredentials& creds) {
+  if (creds.powerCircuit.length() == 0 || creds.powerLimit == 0) return;
+
+  // Each zone is its own node on the circuit: "<device>" or "<device>-z2"
+  for (uint8_t i = 0; i < DRYER_ZONE_COUNT; i++) {
+    char node[PowerBudget::MAX_NAME + 1];
+    if (DRYER_ZONE_COUNT > 1)
+      snprintf(node, sizeof(node), "%s-z%u", mqtt_topics.device(), i + 1);
+    else
+      snprintf(node, sizeof(node), "%s", mqtt_topics.device());
+    powerBudgets[i].begin(creds.powerCircuit.c_str(), node, creds.powerLimit);
+    zones[i].controller.setHeaterGate(&powerBudgets[i]);
+  }
+
+  // Already connected; reconnects pick the filter up from mqtt_topics
+  mqtt_topics.addSubscription(powerBudgets[0].subscription());
+  mqtt_client.subscribe(powerBudgets[0].subscription());
+}
+
+ZoneStatus statusOf(uint8_t index) {
+  DryerZone& zone = zones[index];
+  ZoneStatus s;
+  snprintf(s.state, sizeof(s.state), "%s", zone.controller.getStateName());
+  s.temperature  = zone.sensor.getTemperature();
+  s.humidity     = zone.sensor.getHumidity();
+  s.target       = zone.heater.getTargetTemperature();
+  s.remainingMin = zone.heater.computeRemainingTime() / 60000;
+  s.heater       = zone.heaterRelay.getState();
+  s.fan          = zone.fanRelay.getState();
+  s.idle         = zone.controller.getState() == DryerState::IDLE;
+  return s;
+}
+
+PanelState panelState() {
+  return {displayedZone, selectedPresetIndex, displayPage, idlePower.getContrast()};
+}
+
+// The only code that touches the OLED after setup()
+void render(const ZoneStatus& zone, const PanelState& panel) {
+  static int16_t contrast = -1;
+  if (panel.contrast != contrast) {
+    display.setPowerSave(panel.contrast == 0);
+    if (panel.contrast) display.setContrast(panel.contrast);
+    contrast = panel.contrast;
+  }
+  if (panel.contrast == 0) return;
+
+  const FilamentSetting& preset = filamentSettings[panel.preset];
+
+  // With several zones the header reads "2 HEATING"
+  char label[16];
+  if (DRYER_ZONE_COUNT > 1)
+    snprintf(label, sizeof(label), "%u %s", panel.zone + 1, zone.state);
+  else
+    snprintf(label, sizeof(label), "%s", zone.state);
+
+  if (!zone.idle && panel.page == DisplayPage::TREND) {
+    display.showTrend(label, zone.temperature, zone.humidity, trends[panel.zone]);
+    return;
+  }
 
   display.update(
-    dryer.getStateName(),
-    tempHumidity.getTemperature(),
-    idle ? preset.temperature : heater.getTargetTemperature(),
-    tempHumidity.getHumidity(),
-    idle ? preset.time / 60000 : heater.computeRemainingTime() / 60000,
-    heaterRelay.getState(),
-    fanRelay.getState(),
-    idle ? preset.material.c_str() : nullptr
+    label,
+    zone.temperature,
+    zone.idle ? preset.temperature : zone.target,
+    zone.humidity,
+    zone.idle ? preset.time / 60000 : zone.remainingMin,
+    zone.heater,
+    zone.fan,
+    zone.idle ? preset.material : nullptr
   );
 }
 
+// showZone() after every zone tick, showPanel() whenever the panel may have changed
+#if DRYER_TASKS
+Snapshot<ZoneStatus> zoneSnapshots[DRYER_ZONE_COUNT];
+Snapshot<PanelState> panelSnapshot;
+
+void showZone(uint8_t index) {
+  zoneSnapshots[index].publish(statusOf(index));
+}
+
+// Every control pass; the display task only hears about changes
+void showPanel() {
+  static PanelState shown = {0xFF, 0, DisplayPage::STATUS, 0};
+  PanelState panel = panelState();
+  if (panel != shown) panelSnapshot.publish(panel);
+  shown = panel;
+}
+#else
+void showZone(uint8_t index) {
+  trends[index].add(zones[index].sensor.getTemperature(), zones[index].sensor.getHumidity(),
+                    zones[index].heater.getTargetTemperature());
+}
+
+void showPanel() {
+  render(statusOf(displayedZone), panelState());
+}
+#endif
+
 void setup() {
+#if defined(ESP32)
   Serial.begin(115200);
+#else
+  // Two-zone builds use RX as a DHT data pin
+  Serial.begin(115200, SERIAL_8N1, DRYER_ZONE_COUNT > 1 ? SERIAL_TX_ONLY : SERIAL_FULL);
+#endif
+  log_buffer.addSink(&serialLog);
+  watchdog.begin();
   btnPreset.begin();
   btnStart.begin();
   display.begin();
@@ -127,78 +442,305 @@ void setup() {
   if (!connectToWifi(creds)) {
     display.showMessage("WiFi failed!", "Resetting...");
     Provisioning::clearCredentials();
+    log_buffer.flush();
     delay(2000);
     ESP.restart();
   }
 
+  // Wall clock lets the checkpoint tell how long the box was without power
+  configTime(0, 0, "pool.ntp.org");
+
   display.showMessage("Connecting", "MQTT broker...");
   connectToBroker(creds);
+  // Sizes known once connected (the fragment length was probed)
+  memoryHealth.setLinkBuffers(brokerLink().rxBuffer + brokerLink().txBuffer + mqtt_client.getBufferSize());
+#if DRYER_TASKS
+  mqtt_client.setCallback(queueIncoming);
+#else
   mqtt_client.setCallback(mqttCallback);
-  tempHumidity.setupDHT();
+#endif
+  setupPowerBudget(creds);
+  firmwareUpdate.begin(creds.updateUrl.c_str());
+
+  // Armed before a resumed cycle can switch a heater on
+  safety.begin(DRYER_ZONE_COUNT);
+
+  bool resumed = false;
+  for (uint8_t i = 0; i < DRYER_ZONE_COUNT; i++) {
+    CalibrationStore::load(i, zones[i].sensor.getCalibration());
+    zones[i].sensor.setupDHT();
+    if (zones[i].sensor.updateReadings()) safety.feed(i, zones[i].sensor.getTemperature());
+    resumed |= checkpoints[i].restore();
+  }
+  if (resumed) {
+    display.showMessage("Dryer Box", "Cycle resumed");
+    delay(1000);
+  }
 
   display.showMessage("Dryer Box", "Ready!");
   delay(1000);
-}
-
-void publishButtonEvent(const char* button, const char* action) {
-  StaticJsonDocument<64> doc;
-  doc["button"] = button;
-  doc["action"] = action;
-  char buf[64];
-  serializeJson(doc, buf);
-  Serial.printf("BTN | %s | %s\n", button, action);
-  mqtt_client.publish("tele/dryer/button", buf);
+  idlePower.begin();
+  watchdog.arm();
+  AllocationTracker::arm(watchdog);
+#if DRYER_TASKS
+  startTasks();
+#endif
 }
 
 void handleButtons() {
   btnPreset.update();
   btnStart.update();
 
-  // SELECT (D7): cycle preset when idle
+  // While the OLED is off a press only wakes the box; ignore it until released
+  static bool waking = false;
+  bool held = btnPreset.isHeld() || btnStart.isHeld();
+  if (held && idlePower.activity()) {
+    waking = true;
+    showPanel(); // light up now, not at the next tick
+  }
+  if (waking) {
+    btnPreset.wasPressed();
+    btnPreset.wasLongPressed();
+    btnStart.wasPressed();
+    btnStart.wasLongPressed();
+    if (!held) waking = false;
+    return;
+  }
+
+  DryerController& dryer = zones[displayedZone].controller;
+
+  // SELECT (D7): cycle preset when idle, flip status/trend page while running
   if (btnPreset.wasPressed()) {
     if (dryer.getState() == DryerState::IDLE) {
       selectedPresetIndex = (selectedPresetIndex + 1) % NUM_PRESETS;
+    } else {
+      displayPage = (displayPage == DisplayPage::STATUS) ? DisplayPage::TREND : DisplayPage::STATUS;
     }
-    publishButtonEvent("select", "press");
+    telemetry.publishButtonEvent("select", "press");
+  }
+
+  // SELECT long 3s (D7): page to the next zone
+  if (btnPreset.wasLongPressed()) {
+    displayedZone = (displayedZone + 1) % DRYER_ZONE_COUNT;
+    telemetry.publishButtonEvent("select", "long_press");
   }
 
   // ENTER short (D4): confirm selection → start drying
   if (btnStart.wasPressed()) {
     if (dryer.getState() == DryerState::IDLE) {
       const FilamentSetting& s = filamentSettings[selectedPresetIndex];
-      dryer.applyFilamentPreset(s.temperature, s.time);
+      trace.button(displayedZone, TraceButton::START, selectedPresetIndex);
+      dryer.applyFilamentPreset(s.temperature, s.time, selectedPresetIndex);
+      trace.settle();
     }
-    publishButtonEvent("enter", "press");
+    telemetry.publishButtonEvent("enter", "press");
   }
 
   // ENTER long 3s (D4): graceful stop → COOLING → IDLE
   if (btnStart.wasLongPressed()) {
+    trace.button(displayedZone, TraceButton::STOP, DryerController::NO_PRESET);
     dryer.reset();
-    publishButtonEvent("enter", "long_press");
+    trace.settle();
+    telemetry.publishButtonEvent("enter", "long_press");
   }
 }
 
-void loop() {
-  handleButtons();
-  mqtt_client.loop();
+void tickZone(uint8_t index) {
+  DryerZone& zone = zones[index];
+  {
+    WatchdogScope scope(watchdog, Subsystem::SENSOR);
+    if (zone.sensor.updateReadings()) safety.feed(index, zone.sensor.getTemperature());
+    trace.sensed(index);
+  }
+  {
+    WatchdogScope scope(watchdog, Subsystem::CONTROL);
+    applyCommands();
+    powerBudgets[index].update();
 
-  static uint32_t lastTick = 0;
-  if (millis() - lastTick >= 1000) {
-    lastTick = millis();
+    // The supervisor has already cut the heater; bring the state machine along
+    static SafetyTrip reported[DRYER_ZONE_COUNT] = {};
+    SafetyTrip trip = safety.tripOf(index);
+    zone.controller.setSafetyHold(trip != SafetyTrip::NONE);
+    if (trip != reported[index] && trip != SafetyTrip::NONE) {
+      telemetry.publishSafetyTrip(index, SafetySupervisor::tripName(trip),
+                                  zone.sensor.getTemperature(), safety.getTripCount(index));
+    }
+    reported[index] = trip;
 
-    tempHumidity.updateReadings();
+    zone.controller.update();
+    trace.tick(index, trip != SafetyTrip::NONE, zone.controller.isHeaterBlocked());
+  }
+  {
+    WatchdogScope scope(watchdog, Subsystem::CHECKPOINT);
+    checkpoints[index].update();
+  }
+  {
+    WatchdogScope scope(watchdog, Subsystem::TELEMETRY);
+    telemetry.publishState(zone, index);
 
-    if (!mqtt_client.connected()) {
-      reconnectToBroker();
+    CycleReport report;
+    if (zone.controller.takeCycleReport(report)) {
+      bool preset = report.preset < sizeof(filamentSettings) / sizeof(filamentSettings[0]);
+      telemetry.publishCycleReport(index, report,
+                                   preset ? filamentSettings[report.preset].material : "custom");
     }
+  }
+  {
+    WatchdogScope scope(watchdog, Subsystem::DISPLAY);
+    showZone(index);
+  }
+}
+
+// Once per TICK_MS, independent of the number of zones
+void tickSystem() {
+#if !DRYER_TASKS
+  if (!mqtt_client.connected()) {
+    WatchdogScope scope(watchdog, Subsystem::MQTT_CONNECT);
+    reconnectToBroker();
+  }
+#endif
 
-    if (!bootCountCleared && millis() > 10000) {
-      provisioning.clearBootCounter();
-      bootCountCleared = true;
+  if (!bootCountCleared && millis() > 10000) {
+    provisioning.clearBootCounter();
+    bootCountCleared = true;
+  }
+
+  bool busy = false;
+  for (uint8_t i = 0; i < DRYER_ZONE_COUNT; i++) {
+    busy |= zones[i].controller.getState() != DryerState::IDLE;
+  }
+  idlePower.update(busy);
+  {
+    WatchdogScope scope(watchdog, Subsystem::DISPLAY);
+    showPanel();
+  }
+  {
+    WatchdogScope scope(watchdog, Subsystem::TELEMETRY);
+    memoryHealth.update();
+    watchdog.update();
+
+    static uint32_t lastStats = 0, lastCount = 0;
+    if (millis() - lastStats >= COMMAND_STATS_MS && commands.getLatency().count() != lastCount) {
+      lastStats = millis();
+      lastCount = commands.getLatency().count();
+      telemetry.publishCommandLatency(commands.getLatency(), commands.getQueueStats());
+    }
+    publishTrace();
+  }
+  {
+    WatchdogScope scope(watchdog, Subsystem::OTA);
+    firmwareUpdate.update();
+  }
+}
+
+// One pass of everything but the socket and, with DRYER_TASKS, the OLED
+void controlPass() {
+  {
+    WatchdogScope scope(watchdog, Subsystem::BUTTONS);
+    handleButtons();
+  }
+  {
+    WatchdogScope scope(watchdog, Subsystem::MQTT_LOOP);
+#if DRYER_TASKS
+    receive();
+#else
+    mqtt_client.loop();
+#endif
+  }
+
+  static uint32_t lastSlot = 0;
+  static uint8_t  nextZone = 0;
+  if (millis() - lastSlot >= SLOT_MS) {
+    lastSlot = millis();
+
+    tickZone(nextZone);
+    if (nextZone == 0) tickSystem();
+    nextZone = (nextZone + 1) % DRYER_ZONE_COUNT;
+  }
+#if DRYER_TASKS
+  {
+    WatchdogScope scope(watchdog, Subsystem::DISPLAY);
+    showPanel();
+  }
+#endif
+
+  // Log output only in the slack of a pass, as much as the UART FIFO takes
+  log_buffer.drain();
+}
+
+#if DRYER_TASKS
+constexpr uint32_t CONTROL_PASS_MS = 10;
+constexpr uint32_t NETWORK_PASS_MS = 10;
+constexpr uint32_t DISPLAY_PASS_MS = 50;
+
+void controlTask(void*) {
+  for (;;) {
+    controlPass();
+    // Idle: the nap is what IdlePower accounts as time allowed to sleep
+    if (idlePower.getMode() == PowerMode::ACTIVE) vTaskDelay(pdMS_TO_TICKS(CONTROL_PASS_MS));
+    else                                          idlePower.nap();
+  }
+}
+
+// Sole owner of mqtt_client: keeps the connection up and moves messages
+// between the socket and the rings
+void networkTask(void*) {
+  bool closed = false;
+  for (;;) {
+    if (outbox.takeDisconnect()) {
+      outbox.forward(mqtt_client);
+      mqtt_client.disconnect();
+      closed = true; // only asked for right before a restart
+    }
+    if (!closed) {
+      if (!mqtt_client.connected()) {
+        outbox.setConnected(false);
+        reconnectToBroker(); // one attempt every 5 s at most
+      }
+      mqtt_client.loop();
+      outbox.forward(mqtt_client);
     }
+    outbox.setConnected(!closed && mqtt_client.connected());
+    vTaskDelay(pdMS_TO_TICKS(NETWORK_PASS_MS));
+  }
+}
 
-    dryer.update();
-    updateDisplay();
-    publishDryerState();
+// Draws from snapshots only, and samples the trends from every fresh zone status
+void displayTask(void*) {
+  ZoneStatus status[DRYER_ZONE_COUNT] = {};
+  PanelState panel     = {};
+  bool       havePanel = false;
+  for (;;) {
+    bool changed = panelSnapshot.read(panel);
+    havePanel |= changed;
+    for (uint8_t i = 0; i < DRYER_ZONE_COUNT; i++) {
+      if (!zoneSnapshots[i].read(status[i])) continue;
+      trends[i].add(status[i].temperature, status[i].humidity, status[i].target);
+      changed |= i == panel.zone;
+    }
+    if (changed && havePanel) render(status[panel.zone], panel);
+    vTaskDelay(pdMS_TO_TICKS(DISPLAY_PASS_MS));
   }
 }
+
+// Network next to the WiFi stack on core 0; control above display on core 1.
+// Stacks in bytes: TLS handshakes run in the network task.
+void startTasks() {
+  inbox.setConnected(true);
+  outbox.setConnected(mqtt_client.connected());
+  xTaskCreatePinnedToCore(networkTask, "network", 8192, nullptr, 2, nullptr, 0);
+  xTaskCreatePinnedToCore(controlTask, "control", 8192, nullptr, 3, nullptr, 1);
+  xTaskCreatePinnedToCore(displayTask, "display", 4096, nullptr, 1, nullptr, 1);
+}
+#endif
+
+void loop() {
+#if DRYER_TASKS
+  vTaskDelete(nullptr); // setup() handed everything to the tasks
+#else
+  controlPass();
+
+  // Nothing to do while idle: let WiFi/CPU sleep until the next pass
+  idlePower.nap();
+#endif
+}